@@ -13,6 +13,7 @@ SceneNode::SceneNode()
       m_scale(Vector3(1.0f, 1.0f, 1.0f)),
       m_rotation(Vector3(0.0f, 0.0f, 0.0f)),
       m_active(true) {
+    m_localMatrix.ToIdentity();
     m_worldTransform.ToIdentity();
 }
 
@@ -48,6 +49,14 @@ const Vector3& SceneNode::GetRotation() const {
     return m_rotation;
 }
 
+void SceneNode::SetLocalMatrix(const Matrix4& matrix) {
+    m_localMatrix = matrix;
+}
+
+const Matrix4& SceneNode::GetLocalMatrix() const {
+    return m_localMatrix;
+}
+
 void SceneNode::SetTexture(const std::shared_ptr<Engine::IAL::I_Texture>& texture) {
     m_texture = texture;
 }
@@ -65,6 +74,14 @@ bool SceneNode::IsActive() const {
     return m_active;
 }
 
+void SceneNode::AddOccluderBox(const Vector3& localMin, const Vector3& localMax) {
+    m_occluderBoxes.push_back(OccluderBox{ localMin, localMax });
+}
+
+const std::vector<OccluderBox>& SceneNode::GetOccluderBoxes() const {
+    return m_occluderBoxes;
+}
+
 const Matrix4& SceneNode::GetWorldTransform() const {
     return m_worldTransform;
 }
@@ -108,7 +125,7 @@ Matrix4 SceneNode::BuildLocalTransform() const {
     Matrix4 rotationZ = Matrix4::Rotation(m_rotation.z, Vector3(0.0f, 0.0f, 1.0f));
     Matrix4 scale = Matrix4::Scale(m_scale);
     Matrix4 rotation = rotationZ * rotationY * rotationX;
-    return translation * rotation * scale;
+    return translation * rotation * scale * m_localMatrix;
 }
 
 SceneGraph::SceneGraph() {
@@ -133,6 +150,28 @@ void SceneGraph::CollectRenderableNodes(std::vector<std::shared_ptr<SceneNode>>&
     CollectRenderableNodesRecursive(m_root, outNodes);
 }
 
+std::shared_ptr<SceneNode> SceneGraph::InstantiateModel(const Engine::IAL::ModelScene& model) {
+    auto container = std::make_shared<SceneNode>();
+    std::vector<std::shared_ptr<SceneNode>> nodes(model.nodes.size());
+    for (std::size_t i = 0; i < model.nodes.size(); ++i) {
+        nodes[i] = std::make_shared<SceneNode>();
+        nodes[i]->SetLocalMatrix(model.nodes[i].localTransform);
+        nodes[i]->SetMesh(model.nodes[i].mesh);
+    }
+    for (std::size_t i = 0; i < model.nodes.size(); ++i) {
+        const int parent = model.nodes[i].parent;
+        if (parent >= 0 && parent < static_cast<int>(nodes.size())) {
+            nodes[parent]->AddChild(nodes[i]);
+        }
+    }
+    for (const int root : model.roots) {
+        if (root >= 0 && root < static_cast<int>(nodes.size())) {
+            container->AddChild(nodes[root]);
+        }
+    }
+    return container;
+}
+
 void SceneGraph::CollectRenderableNodesRecursive(const std::shared_ptr<SceneNode>& node,
                                                   std::vector<std::shared_ptr<SceneNode>>& outNodes) const {
     if (!node) {
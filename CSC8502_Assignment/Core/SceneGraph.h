@@ -11,11 +11,16 @@
  *  - 通过 Engine::IAL::I_Mesh 接口引用可渲染对象，保证 Demo 层仅依赖纯净接口。
  *  - 采用 shared_ptr/weak_ptr 建模父子关系，提供对子节点的添加、移除与访问功能。
  *  - 提供 UpdateWorldTransform 接口以在遍历时同步世界矩阵。
+ *  - 提供 SetLocalMatrix 接口，在位置/旋转/缩放之后再叠加一个任意本地矩阵（用于导入模型的节点变换）。
+ *  - 提供 AddOccluderBox 接口，标注位于模型实体内部的局部盒子，渲染器把它们光栅化为遮挡体；
+ *    盒子必须完全被模型本身覆盖，否则会错误地遮住其后方的物体。
  *
  * SceneGraph:
  *  - 在构造时创建一颗空的根节点作为场景的入口。
  *  - 提供 Update 方法以从根节点开始更新所有节点的世界矩阵。
  *  - 提供 CollectRenderableNodes 方法以深度优先收集所有拥有可绘制网格的节点，供渲染器使用。
+ *  - 提供 InstantiateModel 静态方法，把 I_ResourceFactory::LoadModelScene 返回的节点表物化为 SceneNode 子树，
+ *    多个节点引用的同一网格在子树中仍共享同一个 I_Mesh 实例。
  */
 #pragma once
 
@@ -28,6 +33,12 @@
 
 #include "IAL/I_Mesh.h"
 #include "IAL/I_Texture.h"
+#include "IAL/I_ModelScene.h"
+
+struct OccluderBox {
+    Vector3 localMin;
+    Vector3 localMax;
+};
 
 class SceneNode : public std::enable_shared_from_this<SceneNode> {
 public:
@@ -44,6 +55,9 @@ public:
 
     void SetRotation(const Vector3& rotationDegrees);
     const Vector3& GetRotation() const;
+
+    void SetLocalMatrix(const Matrix4& matrix);
+    const Matrix4& GetLocalMatrix() const;
     
     void SetTexture(const std::shared_ptr<Engine::IAL::I_Texture>& texture);
     std::shared_ptr<Engine::IAL::I_Texture> GetTexture() const;
@@ -51,6 +65,9 @@ public:
     void SetActive(bool active);
     bool IsActive() const;
 
+    void AddOccluderBox(const Vector3& localMin, const Vector3& localMax);
+    const std::vector<OccluderBox>& GetOccluderBoxes() const;
+
     const Matrix4& GetWorldTransform() const;
 
     void AddChild(const std::shared_ptr<SceneNode>& child);
@@ -67,10 +84,12 @@ private:
 
     std::shared_ptr<Engine::IAL::I_Mesh> m_mesh;
     std::shared_ptr<Engine::IAL::I_Texture> m_texture;
+    std::vector<OccluderBox> m_occluderBoxes;
 
     Vector3 m_position;
     Vector3 m_scale;
     Vector3 m_rotation;
+    Matrix4 m_localMatrix;
 
     Matrix4 m_worldTransform;
     bool m_active;
@@ -86,6 +105,8 @@ public:
 
     void CollectRenderableNodes(std::vector<std::shared_ptr<SceneNode>>& outNodes) const;
 
+    static std::shared_ptr<SceneNode> InstantiateModel(const Engine::IAL::ModelScene& model);
+
 private:
     void CollectRenderableNodesRecursive(const std::shared_ptr<SceneNode>& node,
                                          std::vector<std::shared_ptr<SceneNode>>& outNodes) const;
@@ -9,4 +9,7 @@
 inline constexpr float kHeightmapResolution = 1024.0f;
 inline  const Vector3 kTerrainScale = Vector3(4.0f, 0.4f, 4.0f);
 inline const float kTerrainExtent = kHeightmapResolution * kTerrainScale.x;
-inline const float kTerrainHalfExtent = kTerrainExtent * 0.5f;
\ No newline at end of file
+inline const float kTerrainHalfExtent = kTerrainExtent * 0.5f;
+// 地形网格自适应三角化的垂直容差（世界单位）。光照法线取自烘焙的法线贴图，
+// 容差只影响轮廓与深度，不影响明暗细节
+inline constexpr float kTerrainMaxError = 1.0f;
\ No newline at end of file
@@ -41,16 +41,110 @@
  * @param x 地形网格的 x 坐标索引。
  * @param y (或 z) 地形网格的 y/z 坐标索引。
  * @return 该点的 nclgl::Vector3 世界空间坐标。
+ *
+ * @fn Engine::IAL::I_Heightmap::GetNormalTexture
+ * @brief 加载时由高度图烘焙的世界空间法线纹理，覆盖整个地形（UV 与网格 texCoord 一致）。
+ * @details
+ * 纹理为 RG16_SNORM，存储法线的 x/z 分量，y 由单位长度重建。
+ * 着色器采样它而不是插值顶点法线，光照细节因此与网格密度无关，网格可以大幅简化。
+ * 默认返回空，表示使用顶点法线。
+ *
+ * @fn Engine::IAL::I_Heightmap::UpdateStreaming
+ * @brief 每帧由渲染器以相机位置调用，供分块流式地形调入/卸载相机附近的分块。
+ * @details 整体驻留内存的实现无需处理，默认为空操作。
+ * @param cameraPosition 世界空间相机位置。
+ *
+ * @fn Engine::IAL::I_Heightmap::SampleHeights
+ * @brief 批量采样高度，结果与逐点调用 `SampleHeight` 一致。
+ * @details
+ * 雨滴更新、草地散布等热点每帧需要成千上万次高度查询，逐点虚调用的开销
+ * 与 clamp/floor/lerp 的标量运算占了大头。批量接口只产生一次虚调用，
+ * 实现可以在内部使用 SIMD 一次处理多点。默认实现逐点回退到 `SampleHeight`。
+ * @param xs 世界空间 x 坐标。
+ * @param zs 世界空间 z 坐标，长度应与 xs 相同。
+ * @param outHeights 输出高度；处理的点数为三者长度的最小值。
+ *
+ * @fn Engine::IAL::I_Heightmap::SampleNormals
+ * @brief 批量计算地形法线与坡度。
+ * @details
+ * 法线由相距一个网格间距的中心差分求得；坡度为水平梯度的模（垂直升高 / 水平距离），
+ * 0 表示水平，1 表示 45°。两个输出均可传空 span 跳过。
+ * @param xs 世界空间 x 坐标。
+ * @param zs 世界空间 z 坐标。
+ * @param outNormals 输出单位法线，可为空。
+ * @param outSlopes 输出坡度，可为空。
+ *
+ * @fn Engine::IAL::I_Heightmap::Raycast
+ * @brief 求射线与地形表面（双线性插值曲面）的第一个交点。
+ * @details
+ * 地形只在 [0, (分辨率 - 1) × 缩放] 的 xz 范围内存在，范围外视为无地形。
+ * 若射线起点已在地表以下，返回距离 0。默认实现按四分之一网格间距步进并二分细化，
+ * 结果可作为加速实现的参照。
+ * @param origin 射线起点（世界空间）。
+ * @param direction 射线方向，无需归一化。
+ * @param maxDistance 最大检测距离（沿归一化方向的世界单位）。
+ * @param outDistance 命中时写入沿归一化方向的距离。
+ * @return 是否命中。
+ *
+ * @fn Engine::IAL::I_Heightmap::GetHeightRange
+ * @brief 查询 xz 矩形区域内地形高度的最小/最大值。
+ * @details
+ * 结果取自与矩形相交的所有网格单元的角点采样，是该区域内双线性曲面的保守包围范围，
+ * 可用于相机碰撞、雨滴遮挡与阴影视锥拟合。默认实现逐个采样点扫描。
+ * @return 区域与地形不相交或高度图为空时返回 false。
+ *
+ * @fn Engine::IAL::I_Heightmap::HasFastHeightRange
+ * @brief 表示 GetHeightRange 是否有加速实现（耗时与区域面积无关）。
+ * @details
+ * 需要对整张地形做大量区间查询的预计算（地平线地块、地形遮挡网格）据此决定是否启用；
+ * 默认实现逐采样点扫描，返回 false。
+ *
+ * @struct Engine::IAL::ProceduralTerrainDesc
+ * @brief 程序化高度图的生成参数，供 `I_ResourceFactory::CreateProceduralHeightmap` 使用。
+ * @details
+ * 基础噪声为分形（fBm）或脊状（ridged multifractal）梯度噪声，`frequency` 表示整张地图上
+ * 基础频率的周期数，因此同一组参数在不同分辨率下生成相同形状、不同细节的地形。
+ * `warpStrength` 大于 0 时先以低阶 fBm 对采样坐标做域扭曲（单位为基础周期）。
+ * 结果归一化到 0..255，与 8 位图像高度图的区间一致，`scale` 的含义因此不变。
+ * `erosionPasses` 大于 0 时执行热侵蚀：相邻采样高差超过 `talus`（0..255 区间内的单位）
+ * 的部分按 `erosionRate` 向低处搬运。相同参数总是生成逐位相同的结果，与线程数无关。
  */
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
 #include "nclgl/Vector3.h"
 #include "nclgl/Vector2.h"
 
 #include "IAL/I_Mesh.h"
+#include "IAL/I_Texture.h"
 
 namespace Engine::IAL {
+    enum class TerrainNoiseType {
+        Fractal,
+        Ridged
+    };
+
+    struct ProceduralTerrainDesc {
+        std::uint32_t seed = 1337u;
+        std::size_t dimension = 1024;
+        TerrainNoiseType noiseType = TerrainNoiseType::Ridged;
+        float frequency = 3.0f;
+        int octaves = 8;
+        float lacunarity = 2.0f;
+        float gain = 0.5f;
+        float warpStrength = 0.4f;
+        int warpOctaves = 3;
+        int erosionPasses = 0;
+        float talus = 4.0f;
+        float erosionRate = 0.1f;
+    };
+
     class I_Heightmap : public virtual I_Mesh {
     public:
         virtual ~I_Heightmap() {}
@@ -66,6 +160,121 @@ namespace Engine::IAL {
         virtual Vector2 GetResolution() const {
             return Vector2(0.0f, 0.0f);
         }
+
+        virtual std::shared_ptr<I_Texture> GetNormalTexture() const {
+            return nullptr;
+        }
+
+        virtual void UpdateStreaming(const Vector3&) {
+        }
+
+        virtual void SampleHeights(std::span<const float> xs,
+                                   std::span<const float> zs,
+                                   std::span<float> outHeights) const {
+            const std::size_t count = std::min({ xs.size(), zs.size(), outHeights.size() });
+            for (std::size_t i = 0; i < count; ++i) {
+                outHeights[i] = SampleHeight(xs[i], zs[i]);
+            }
+        }
+
+        virtual void SampleNormals(std::span<const float> xs,
+                                   std::span<const float> zs,
+                                   std::span<Vector3> outNormals,
+                                   std::span<float> outSlopes) const {
+            const std::size_t count = std::min(xs.size(), zs.size());
+            const Vector3 scale = GetWorldScale();
+            for (std::size_t i = 0; i < count; ++i) {
+                const float dx = (SampleHeight(xs[i] + scale.x, zs[i]) - SampleHeight(xs[i] - scale.x, zs[i])) / (2.0f * scale.x);
+                const float dz = (SampleHeight(xs[i], zs[i] + scale.z) - SampleHeight(xs[i], zs[i] - scale.z)) / (2.0f * scale.z);
+                if (i < outNormals.size()) {
+                    Vector3 normal(-dx, 1.0f, -dz);
+                    normal.Normalise();
+                    outNormals[i] = normal;
+                }
+                if (i < outSlopes.size()) {
+                    outSlopes[i] = std::sqrt(dx * dx + dz * dz);
+                }
+            }
+        }
+
+        virtual bool Raycast(const Vector3& origin,
+                             const Vector3& direction,
+                             float maxDistance,
+                             float& outDistance) const {
+            const float length = direction.Length();
+            const Vector2 resolution = GetResolution();
+            if (length <= 0.0f || resolution.x < 2.0f || resolution.y < 2.0f) {
+                return false;
+            }
+            const Vector3 dir = direction / length;
+            const Vector3 scale = GetWorldScale();
+            const float extentX = (resolution.x - 1.0f) * scale.x;
+            const float extentZ = (resolution.y - 1.0f) * scale.z;
+            auto gap = [&](float t) {
+                const Vector3 p = origin + dir * t;
+                if (p.x < 0.0f || p.z < 0.0f || p.x > extentX || p.z > extentZ) {
+                    return 1.0f;
+                }
+                return p.y - SampleHeight(p.x, p.z);
+            };
+            if (gap(0.0f) <= 0.0f) {
+                outDistance = 0.0f;
+                return true;
+            }
+            const float step = 0.25f * std::min(scale.x, scale.z);
+            for (float t = step; t - step < maxDistance; t += step) {
+                const float end = std::min(t, maxDistance);
+                if (gap(end) > 0.0f) {
+                    continue;
+                }
+                float lo = end - step;
+                float hi = end;
+                for (int i = 0; i < 24; ++i) {
+                    const float mid = 0.5f * (lo + hi);
+                    (gap(mid) <= 0.0f ? hi : lo) = mid;
+                }
+                outDistance = hi;
+                return true;
+            }
+            return false;
+        }
+
+        virtual bool GetHeightRange(float minX,
+                                    float minZ,
+                                    float maxX,
+                                    float maxZ,
+                                    float& outMin,
+                                    float& outMax) const {
+            const Vector2 resolution = GetResolution();
+            const Vector3 scale = GetWorldScale();
+            if (resolution.x < 2.0f || resolution.y < 2.0f || minX > maxX || minZ > maxZ) {
+                return false;
+            }
+            if (maxX < 0.0f || maxZ < 0.0f ||
+                minX > (resolution.x - 1.0f) * scale.x || minZ > (resolution.y - 1.0f) * scale.z) {
+                return false;
+            }
+            const int cellsX = static_cast<int>(resolution.x) - 1;
+            const int cellsZ = static_cast<int>(resolution.y) - 1;
+            const int x0 = std::clamp(static_cast<int>(std::floor(minX / scale.x)), 0, cellsX - 1);
+            const int x1 = std::clamp(static_cast<int>(std::floor(maxX / scale.x)), 0, cellsX - 1);
+            const int z0 = std::clamp(static_cast<int>(std::floor(minZ / scale.z)), 0, cellsZ - 1);
+            const int z1 = std::clamp(static_cast<int>(std::floor(maxZ / scale.z)), 0, cellsZ - 1);
+            outMin = SampleHeight(x0 * scale.x, z0 * scale.z);
+            outMax = outMin;
+            for (int z = z0; z <= z1 + 1; ++z) {
+                for (int x = x0; x <= x1 + 1; ++x) {
+                    const float height = SampleHeight(x * scale.x, z * scale.z);
+                    outMin = std::min(outMin, height);
+                    outMax = std::max(outMax, height);
+                }
+            }
+            return true;
+        }
+
+        virtual bool HasFastHeightRange() const {
+            return false;
+        }
     };
 
 }
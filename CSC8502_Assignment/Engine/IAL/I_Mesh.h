@@ -22,10 +22,50 @@
  * @details
  * 渲染器在遍历场景图（SceneGraph）时调用此函数。
  * 适配器实现（如 B_Mesh）将调用其内部持有的 nclgl::Mesh::Draw()。
+ *
+ * @fn Engine::IAL::I_Mesh::GetSubMeshCount
+ * @brief 返回网格包含的子网格数量。
+ * @details
+ * 多图元 glTF 网格的每个图元对应一个子网格，它们共享同一组顶点/索引缓冲。
+ * 返回 0 或 1 时渲染器直接调用 Draw()。
+ *
+ * @fn Engine::IAL::I_Mesh::DrawSubMesh
+ * @brief 仅绘制指定的子网格，默认实现退化为 Draw()。
+ *
+ * @fn Engine::IAL::I_Mesh::GetSubMeshMaterial
+ * @brief 返回指定子网格的材质，默认实现退化为 GetPBRMaterial()。
+ *
+ * @fn Engine::IAL::I_Mesh::SupportsInstancing
+ * @brief 是否支持 DrawInstanced / DrawSubMeshInstanced。
+ * @details
+ * 仅静态网格返回 true；渲染器据此把共享同一网格与纹理的节点合并为一次实例化绘制，
+ * 实例的世界矩阵由渲染器写入着色器存储缓冲（binding = 1）并以 gl_InstanceID 索引。
+ *
+ * @fn Engine::IAL::I_Mesh::GetLocalBounds
+ * @brief 返回网格在模型空间的轴对齐包围盒，供渲染器做 CPU 端视锥剔除。
+ * @return 网格没有可用的包围盒时返回 false。
+ *
+ * @fn Engine::IAL::I_Mesh::GetTriangleCount
+ * @brief 返回一次 Draw() 提交的三角形数量，仅用于渲染统计；未知时返回 0。
+ *
+ * @fn Engine::IAL::I_Mesh::DrawDepth
+ * @brief 供阴影等纯深度通道使用的绘制，默认实现退化为 Draw()。
+ * @details
+ * 适配器转发到 nclgl::Mesh::DrawDepth()，其 VAO 只启用位置（蒙皮网格另含权重与关节索引），
+ * 顶点数据来自紧凑排列的独立顶点流，不会读取法线、切线、UV 与顶点色。
+ *
+ * @fn Engine::IAL::I_Mesh::DrawDepthInstanced
+ * @brief DrawInstanced 的纯深度版本，默认实现退化为 DrawInstanced()。
+ *
+ * @fn Engine::IAL::I_Mesh::GetVertexFetchBytes
+ * @brief 返回一次绘制读取的顶点数据字节数（顶点数 × 每顶点字节数），仅用于渲染统计。
+ * @param depthStream true 时按 DrawDepth 使用的顶点流计算，false 时按完整顶点布局计算。
+ * @return 未知时返回 0。该值假设每个顶点只读取一次，不考虑顶点缓存的复用。
  */
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include "nclgl/Vector3.h"
@@ -68,6 +108,48 @@ namespace Engine::IAL {
         virtual const PBRMaterial* GetPBRMaterial() const {
             return nullptr;
         }
+
+        virtual int GetSubMeshCount() const {
+            return 0;
+        }
+
+        virtual void DrawSubMesh(int) {
+            Draw();
+        }
+
+        virtual const PBRMaterial* GetSubMeshMaterial(int) const {
+            return GetPBRMaterial();
+        }
+
+        virtual bool SupportsInstancing() const {
+            return false;
+        }
+
+        virtual void DrawInstanced(int) {
+        }
+
+        virtual void DrawSubMeshInstanced(int, int) {
+        }
+
+        virtual bool GetLocalBounds(Vector3&, Vector3&) const {
+            return false;
+        }
+
+        virtual std::size_t GetTriangleCount() const {
+            return 0;
+        }
+
+        virtual void DrawDepth() {
+            Draw();
+        }
+
+        virtual void DrawDepthInstanced(int instanceCount) {
+            DrawInstanced(instanceCount);
+        }
+
+        virtual std::size_t GetVertexFetchBytes(bool) const {
+            return 0;
+        }
     };
 
 }
@@ -0,0 +1,56 @@
+/**
+ * @file I_ModelScene.h
+ * @brief 定义了整场景模型导入结果的纯数据描述。
+ * @details
+ * `I_ResourceFactory::LoadMesh` 只返回文件中的第一个网格，多节点/多图元的 glTF
+ * 会被截断。`LoadModelScene` 则返回本文件定义的 `ModelScene`，完整保留文件中的
+ * 节点层级、本地变换与网格引用，再由 `SceneGraph::InstantiateModel` 物化为 `SceneNode` 树。
+ *
+ * 架构说明（V13）：
+ * IAL 层不能依赖 Core 层的 `SceneNode`，因此这里只描述“节点表”，
+ * 具体的场景图构建留给 Demo 层完成。
+ *
+ * (NFR-1) 规范约束：本文件严禁包含 nclgl/Mesh.h。
+ * (NFR-2) 规范要求：本文件使用 nclgl 数学库（Matrix4.h）描述节点变换。
+ *
+ * @see I_ResourceFactory::LoadModelScene
+ * @see SceneGraph::InstantiateModel
+ *
+ * @struct Engine::IAL::ModelNode
+ * @brief 导入场景中的单个节点。
+ * @details
+ * `mesh` 可以为空（纯变换节点）。文件中多次引用同一网格的节点会指向同一个
+ * `I_Mesh` 实例，共享一组 GPU 顶点/索引缓冲，而不是各自复制一份。
+ *
+ * @struct Engine::IAL::ModelScene
+ * @brief 导入场景的节点表。
+ * @details
+ * `nodes` 按文件顺序排列，父节点不保证排在子节点之前；`roots` 列出所有顶层节点的下标。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nclgl/Matrix4.h"
+
+#include "IAL/I_Mesh.h"
+
+namespace Engine::IAL {
+    struct ModelNode {
+        std::string name;
+        Matrix4 localTransform;
+        int parent = -1;
+        std::shared_ptr<I_Mesh> mesh;
+    };
+
+    struct ModelScene {
+        std::vector<ModelNode> nodes;
+        std::vector<int> roots;
+        std::size_t meshCount = 0;
+    };
+
+}
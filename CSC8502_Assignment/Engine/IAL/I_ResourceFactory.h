@@ -84,8 +84,21 @@
  * 的辅助类来填充顶点数据。
  * (NFR-2) 
  * `scale` 参数必须使用 `nclgl::Vector3`。
+ * `maxError` 大于 0 时，网格在加载时按该垂直容差（世界单位）做自适应三角化，
+ * 平坦区域合并为大三角形；为 0 时保留完整规则网格。高度采样不受影响。
  * @param path `.raw` 文件路径。
  * @param scale `nclgl::Vector3` 类型的缩放因子（x, y, z）。
+ * @param maxError 自适应三角化允许的最大垂直误差（世界单位）。
+ * @return `std::shared_ptr<I_Heightmap>` 接口。
+ *
+ * @fn Engine::IAL::I_ResourceFactory::CreateProceduralHeightmap
+ * @brief 按噪声参数生成高度图，返回与 `LoadHeightmap` 相同的地形对象。
+ * @details
+ * 生成在工作线程上分块并行执行，结果只取决于 `desc`。之后的网格构建、自适应三角化
+ * 与法线烘焙与 `LoadHeightmap` 共用同一流程，场景可以直接替换使用。
+ * @param desc 噪声、域扭曲与侵蚀参数。
+ * @param scale `nclgl::Vector3` 类型的缩放因子（x, y, z）。
+ * @param maxError 自适应三角化允许的最大垂直误差（世界单位）。
  * @return `std::shared_ptr<I_Heightmap>` 接口。
  *
  * @fn Engine::IAL::I_ResourceFactory::CreateQuad
@@ -119,6 +132,17 @@
  * @param height FBO 高度（通常为屏幕分辨率）。
  * @return `std::shared_ptr<I_FrameBuffer>` 接口。
  *
+ * @fn Engine::IAL::I_ResourceFactory::CreateShadowMomentFBO
+ * @brief (P-4) 
+ * 创建一个用于预过滤阴影（EVSM）矩图集的帧缓冲对象（FBO）。
+ * @details
+ * 仅包含一个 32 位浮点颜色附件，不带深度附件；
+ * 过滤方式与 mipmap 由调用方（ShadowMap）按预设配置。
+ * @param width FBO 宽度。
+ * @param height FBO 高度。
+ * @param components 每个纹素的矩数量：2 为 RG32F，4 为 RGBA32F。
+ * @return `std::shared_ptr<I_FrameBuffer>` 接口。
+ *
  * @fn Engine::IAL::I_ResourceFactory::LoadAnimatedMesh
  * @brief (P-4) 
  * 从文件加载一个带骨骼动画的网格。
@@ -137,6 +161,15 @@
  * 轨道 B 旧版 .msh/.anm 
  * 格式，或在 .gltf 中选择特定动画。
  * @return `std::shared_ptr<I_AnimatedMesh>` 接口。
+ *
+ * @fn Engine::IAL::I_ResourceFactory::LoadModelScene
+ * @brief 从文件加载完整的模型场景（全部节点、网格与逐子网格材质）。
+ * @details
+ * 与只返回首个网格的 `LoadMesh` 不同，此方法保留文件中的节点层级；
+ * 被多个节点引用的网格只创建一次并在节点间共享。
+ * 轨道 B 实现使用 `GLTFLoader` 读取 `GLTFScene` 并转换为 `ModelScene`。
+ * @param path 模型文件路径（例如 "Assets/Models/ruins.gltf"）。
+ * @return `std::shared_ptr<ModelScene>`，失败时返回 nullptr。
  */
 
 #pragma once
@@ -152,6 +185,7 @@
 #include "IAL/I_Heightmap.h"
 #include "IAL/I_AnimatedMesh.h"
 #include "IAL/I_FrameBuffer.h"
+#include "IAL/I_ModelScene.h"
 
 namespace Engine::IAL {
     class I_ResourceFactory {
@@ -174,7 +208,10 @@ namespace Engine::IAL {
             const std::string& negz, const std::string& posz) = 0;
 
         virtual std::shared_ptr<I_Heightmap> LoadHeightmap(
-            const std::string& path, const Vector3& scale) = 0;
+            const std::string& path, const Vector3& scale, float maxError = 0.0f) = 0;
+
+        virtual std::shared_ptr<I_Heightmap> CreateProceduralHeightmap(
+            const ProceduralTerrainDesc& desc, const Vector3& scale, float maxError = 0.0f) = 0;
 
         virtual std::shared_ptr<I_Mesh> CreateQuad() = 0;
 
@@ -182,9 +219,13 @@ namespace Engine::IAL {
 
         virtual std::shared_ptr<I_FrameBuffer> CreatePostProcessFBO(int width, int height) = 0;
 
+        virtual std::shared_ptr<I_FrameBuffer> CreateShadowMomentFBO(int width, int height, int components) = 0;
+
         virtual std::shared_ptr<I_AnimatedMesh> LoadAnimatedMesh(
             const std::string& path,
             const std::string& animPathOrName = "") = 0;
+
+        virtual std::shared_ptr<ModelScene> LoadModelScene(const std::string& path) = 0;
     };
 
 }
@@ -84,6 +84,24 @@ namespace NCLGL_Impl {
         return m_defaultTexture;
     }
 
+    std::size_t B_AnimatedMesh::GetTriangleCount() const {
+        return m_mesh ? m_mesh->GetTriCount() : 0;
+    }
+
+    void B_AnimatedMesh::DrawDepth() {
+        if (m_mesh) {
+            m_mesh->DrawDepth();
+        }
+    }
+
+    std::size_t B_AnimatedMesh::GetVertexFetchBytes(bool depthStream) const {
+        if (!m_mesh) {
+            return 0;
+        }
+        const std::size_t stride = depthStream ? m_mesh->GetDepthVertexStride() : m_mesh->GetVertexStride();
+        return static_cast<std::size_t>(m_mesh->GetVertexCount()) * stride;
+    }
+
     const Engine::IAL::PBRMaterial* B_AnimatedMesh::GetPBRMaterial() const {
         return m_hasPBR ? &m_pbrMaterial : nullptr;
     }
@@ -65,6 +65,9 @@ namespace NCLGL_Impl {
         const std::vector<Matrix4>& GetBoneTransforms() const override;
         Matrix4 GetRootTransform() const override;
         std::shared_ptr<Engine::IAL::I_Texture> GetDefaultTexture() const override;
+        std::size_t GetTriangleCount() const override;
+        void DrawDepth() override;
+        std::size_t GetVertexFetchBytes(bool depthStream) const override;
 
         const Engine::IAL::PBRMaterial* GetPBRMaterial() const override;
 
@@ -11,7 +11,10 @@
 #include "B_FrameBuffer.h"
 #include "B_Heightmap.h"
 #include "B_Mesh.h"
+#include "B_ProceduralTerrain.h"
 #include "B_Shader.h"
+#include "B_StreamingHeightmap.h"
+#include "B_TerrainSimplifier.h"
 #include "B_Texture.h"
 
 
@@ -29,6 +32,7 @@
 #include <array>
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -36,6 +40,7 @@
 #include <iterator>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <vector>
@@ -55,6 +60,9 @@ namespace {
             }
             return "Depth-only (" + depthStr + ")";
         }
+        if (depthFormat == NCLGL_Impl::AttachmentFormat::None) {
+            return "Color-only (" + NCLGL_Impl::AttachmentFormatToString(fbo->GetColorFormat()) + ")";
+        }
 
         std::string description = "Color+Depth (" + NCLGL_Impl::AttachmentFormatToString(fbo->GetColorFormat());
         if (depthFormat != NCLGL_Impl::AttachmentFormat::None) {
@@ -153,6 +161,10 @@ namespace {
         return nullptr;
     }
 
+    float ElapsedMilliseconds(const std::chrono::steady_clock::time_point& start) {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
     bool IsDigits(const std::string& value) {
         if (value.empty()) {
             return false;
@@ -379,9 +391,11 @@ namespace {
 
     class HeightmapMesh final : public ::Mesh {
     public:
-        HeightmapMesh(const std::vector<unsigned char>& samples, size_t dimension, const Vector3& scale) {
-            numVertices = static_cast<GLuint>(dimension * dimension);
-            numIndices = static_cast<GLuint>((dimension - 1) * (dimension - 1) * 6);
+        // triangulation 为空时生成完整规则网格，否则只为自适应三角化用到的网格点生成顶点
+        HeightmapMesh(const std::vector<float>& samples, size_t dimension, const Vector3& scale,
+                      const NCLGL_Impl::B_TerrainSimplifier::Triangulation* triangulation = nullptr) {
+            numVertices = static_cast<GLuint>(triangulation ? triangulation->gridVertices.size() : dimension * dimension);
+            numIndices = static_cast<GLuint>(triangulation ? triangulation->indices.size() : (dimension - 1) * (dimension - 1) * 6);
             type = GL_TRIANGLES;
 
             vertices = new Vector3[numVertices];
@@ -394,61 +408,57 @@ namespace {
                 x = std::clamp(x, 0, static_cast<int>(dimension) - 1);
                 z = std::clamp(z, 0, static_cast<int>(dimension) - 1);
                 const size_t index = static_cast<size_t>(z) * dimension + static_cast<size_t>(x);
-                const float normalised = static_cast<float>(samples[index]);
-                return normalised * scale.y;
+                return samples[index] * scale.y;
             };
 
-            for (size_t z = 0; z < dimension; ++z) {
-                for (size_t x = 0; x < dimension; ++x) {
-                    const size_t index = z * dimension + x;
-                    const float height = sampleHeight(static_cast<int>(x), static_cast<int>(z));
-
-                    vertices[index] = Vector3(static_cast<float>(x) * scale.x,
-                                              height,
-                                              static_cast<float>(z) * scale.z);
-                    textureCoords[index] = Vector2(
-                        dimension > 1 ? static_cast<float>(x) / static_cast<float>(dimension - 1) : 0.0f,
-                        dimension > 1 ? static_cast<float>(z) / static_cast<float>(dimension - 1) : 0.0f);
-                    normals[index] = Vector3(0.0f, 1.0f, 0.0f);
-                    tangents[index] = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
-                }
+            for (GLuint index = 0; index < numVertices; ++index) {
+                const size_t grid = triangulation ? triangulation->gridVertices[index] : index;
+                const int x = static_cast<int>(grid % dimension);
+                const int z = static_cast<int>(grid / dimension);
+
+                vertices[index] = Vector3(static_cast<float>(x) * scale.x,
+                                          sampleHeight(x, z),
+                                          static_cast<float>(z) * scale.z);
+                textureCoords[index] = Vector2(
+                    dimension > 1 ? static_cast<float>(x) / static_cast<float>(dimension - 1) : 0.0f,
+                    dimension > 1 ? static_cast<float>(z) / static_cast<float>(dimension - 1) : 0.0f);
+
+                const float hL = sampleHeight(x - 1, z);
+                const float hR = sampleHeight(x + 1, z);
+                const float hD = sampleHeight(x, z - 1);
+                const float hU = sampleHeight(x, z + 1);
+
+                const Vector3 tangentX(2.0f * scale.x, hR - hL, 0.0f);
+                const Vector3 tangentZ(0.0f, hU - hD, 2.0f * scale.z);
+
+                Vector3 normal = Vector3::Cross(tangentZ, tangentX);
+                normal.Normalise();
+                normals[index] = normal;
+
+                Vector3 tangent = tangentX;
+                tangent.Normalise();
+                tangents[index] = Vector4(tangent.x, tangent.y, tangent.z, 1.0f);
             }
 
-            for (size_t z = 0; z < dimension; ++z) {
-                for (size_t x = 0; x < dimension; ++x) {
-                    const size_t index = z * dimension + x;
-                    const float hL = sampleHeight(static_cast<int>(x) - 1, static_cast<int>(z));
-                    const float hR = sampleHeight(static_cast<int>(x) + 1, static_cast<int>(z));
-                    const float hD = sampleHeight(static_cast<int>(x), static_cast<int>(z) - 1);
-                    const float hU = sampleHeight(static_cast<int>(x), static_cast<int>(z) + 1);
-
-                    const Vector3 tangentX(2.0f * scale.x, hR - hL, 0.0f);
-                    const Vector3 tangentZ(0.0f, hU - hD, 2.0f * scale.z);
-
-                    Vector3 normal = Vector3::Cross(tangentZ, tangentX);
-                    normal.Normalise();
-                    normals[index] = normal;
-
-                    Vector3 tangent = tangentX;
-                    tangent.Normalise();
-                    tangents[index] = Vector4(tangent.x, tangent.y, tangent.z, 1.0f);
-                }
+            if (triangulation) {
+                std::copy(triangulation->indices.begin(), triangulation->indices.end(), indices);
             }
-
-            unsigned int indexCursor = 0;
-            for (size_t z = 0; z < dimension - 1; ++z) {
-                for (size_t x = 0; x < dimension - 1; ++x) {
-                    const unsigned int a = static_cast<unsigned int>(z * dimension + x);
-                    const unsigned int b = static_cast<unsigned int>(z * dimension + (x + 1));
-                    const unsigned int c = static_cast<unsigned int>((z + 1) * dimension + (x + 1));
-                    const unsigned int d = static_cast<unsigned int>((z + 1) * dimension + x);
-
-                    indices[indexCursor++] = a;
-                    indices[indexCursor++] = b;
-                    indices[indexCursor++] = c;
-                    indices[indexCursor++] = a;
-                    indices[indexCursor++] = c;
-                    indices[indexCursor++] = d;
+            else {
+                unsigned int indexCursor = 0;
+                for (size_t z = 0; z < dimension - 1; ++z) {
+                    for (size_t x = 0; x < dimension - 1; ++x) {
+                        const unsigned int a = static_cast<unsigned int>(z * dimension + x);
+                        const unsigned int b = static_cast<unsigned int>(z * dimension + (x + 1));
+                        const unsigned int c = static_cast<unsigned int>((z + 1) * dimension + (x + 1));
+                        const unsigned int d = static_cast<unsigned int>((z + 1) * dimension + x);
+
+                        indices[indexCursor++] = a;
+                        indices[indexCursor++] = b;
+                        indices[indexCursor++] = c;
+                        indices[indexCursor++] = a;
+                        indices[indexCursor++] = c;
+                        indices[indexCursor++] = d;
+                    }
                 }
             }
 
@@ -489,13 +499,15 @@ namespace NCLGL_Impl {
 
         try {
             if (extension == ".gltf" || extension == ".glb") {
+                const auto loadStart = std::chrono::steady_clock::now();
                 GLTFScene scene;
                 if (!GLTFLoader::Load(path, scene) || scene.meshes.empty()) {
                     std::cerr << "[B_Factory] GLTF load failed for " << path << "\n";
                     return nullptr;
                 }
                 auto mesh = scene.meshes.front();
-                std::cerr << "[B_Factory] GLTF mesh loaded: " << path << "\n";
+                std::cerr << "[B_Factory] GLTF mesh loaded: " << path
+                    << " (" << ElapsedMilliseconds(loadStart) << " ms)\n";
                 auto wrappedMesh = std::make_shared<B_Mesh>(mesh);
                 if (wrappedMesh) {
                     if (auto texture = ExtractPrimaryTexture(scene)) {
@@ -522,6 +534,13 @@ namespace NCLGL_Impl {
                             wrappedMesh->SetDefaultTexture(material.baseColor);
                         }
                     }
+                    if (!scene.materials.empty() && scene.materials.front().allLayers.size() > 1) {
+                        std::vector<Engine::IAL::PBRMaterial> subMeshMaterials;
+                        for (const auto& layer : scene.materials.front().allLayers) {
+                            subMeshMaterials.emplace_back(BuildPBRMaterial(layer));
+                        }
+                        wrappedMesh->SetSubMeshMaterials(subMeshMaterials);
+                    }
                 }
                 return wrappedMesh;
             }
@@ -583,53 +602,131 @@ namespace NCLGL_Impl {
         return texture;
     }
 
+    namespace {
+        // 图像与程序化高度图共用：网格构建、可选的自适应三角化与法线贴图烘焙
+        std::shared_ptr<Engine::IAL::I_Heightmap> BuildHeightmap(std::vector<float> heightSamples,
+                                                                 size_t dimension,
+                                                                 const Vector3& scale,
+                                                                 float maxError,
+                                                                 const std::string& source) {
+            try {
+                ::Mesh* mesh = nullptr;
+                if (maxError > 0.0f) {
+                    const B_TerrainSimplifier simplifier(heightSamples, dimension, scale.y);
+                    const B_TerrainSimplifier::Triangulation triangulation = simplifier.Extract(maxError);
+                    mesh = new HeightmapMesh(heightSamples, dimension, scale, &triangulation);
+                    std::cerr << "[B_Factory] Heightmap simplified: " << triangulation.indices.size() / 3
+                        << " of " << (dimension - 1) * (dimension - 1) * 2 << " triangles, "
+                        << triangulation.gridVertices.size() << " of " << dimension * dimension
+                        << " vertices at max error " << maxError << "\n";
+                }
+                else {
+                    mesh = new HeightmapMesh(heightSamples, dimension, scale);
+                }
+                std::cerr << "[B_Factory] Heightmap loaded: " << source
+                    << " (" << dimension << "x" << dimension << ") scale="
+                    << scale.x << "," << scale.y << "," << scale.z << "\n";
+                auto heightmap = std::make_shared<B_Heightmap>(mesh, std::move(heightSamples), dimension, scale);
+                if (heightmap) {
+                    Engine::IAL::PBRMaterial material;
+                    material.baseColorFactor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+                    material.metallicFactor = 0.0f;
+                    material.roughnessFactor = 1.0f;
+                    material.alphaMode = Engine::IAL::AlphaMode::Opaque;
+                    material.doubleSided = false;
+                    heightmap->SetPBRMaterial(material);
+
+                    // 光照法线来自烘焙纹理而非顶点，网格简化不会损失光照细节
+                    const auto bakeStart = std::chrono::high_resolution_clock::now();
+                    const std::vector<std::int16_t> normalTexels = heightmap->BakeNormalMap();
+                    const auto bakeEnd = std::chrono::high_resolution_clock::now();
+                    GLuint normalTexture = 0;
+                    glGenTextures(1, &normalTexture);
+                    glBindTexture(GL_TEXTURE_2D, normalTexture);
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16_SNORM, static_cast<GLsizei>(dimension),
+                                 static_cast<GLsizei>(dimension), 0, GL_RG, GL_SHORT, normalTexels.data());
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                    glBindTexture(GL_TEXTURE_2D, 0);
+                    heightmap->SetNormalTexture(std::make_shared<NCLGL_Impl::B_Texture>(
+                        normalTexture, Engine::IAL::TextureType::Texture2D, GL_TEXTURE_2D));
+                    std::cerr << "[B_Factory] Heightmap normal map baked in "
+                        << std::chrono::duration<float, std::milli>(bakeEnd - bakeStart).count() << "ms" << "\n";
+                }
+                return heightmap;
+            }
+            catch (const std::exception& ex) {
+                std::cerr << "[B_Factory] Exception constructing heightmap mesh for " << source
+                    << ": " << ex.what() << std::endl;
+            }
+            return nullptr;
+        }
+    }
+
     std::shared_ptr<Engine::IAL::I_Heightmap> B_Factory::LoadHeightmap(
-        const std::string& path, const Vector3& scale) {
+        const std::string& path, const Vector3& scale, float maxError) {
+        // 16 位 RAW、非正方形或超过单个网格承受范围的高度图改走分块流式路径
+        constexpr int kMaxInMemoryDimension = 4097;
         int width = 0;
         int height = 0;
         int channels = 0;
-        stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 1);
-        if (!data) {
+        const std::string extension = ExtractExtension(path);
+        const bool isRaw = extension == ".r16" || extension == ".raw";
+        if (isRaw || (stbi_info(path.c_str(), &width, &height, &channels) &&
+                      (width != height || width > kMaxInMemoryDimension))) {
+            return B_StreamingHeightmap::Open(path, scale);
+        }
+
+        // 16 位图像按 /257 换算，保持与 8 位高度图相同的 0..255 高度区间
+        std::vector<float> heightSamples;
+        if (stbi_is_16_bit(path.c_str())) {
+            stbi_us* data = stbi_load_16(path.c_str(), &width, &height, &channels, 1);
+            if (data) {
+                heightSamples.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+                for (size_t i = 0; i < heightSamples.size(); ++i) {
+                    heightSamples[i] = static_cast<float>(data[i]) / 257.0f;
+                }
+                stbi_image_free(data);
+            }
+        }
+        else {
+            stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 1);
+            if (data) {
+                heightSamples.assign(data, data + static_cast<size_t>(width) * static_cast<size_t>(height));
+                stbi_image_free(data);
+            }
+        }
+        if (heightSamples.empty()) {
             std::cerr << "[B_Factory] STB_Image Failed to open heightmap: " << path << std::endl;
             return nullptr;
         }
         if (width != height || width < 2) {
             std::cerr << "[B_Factory] Heightmap dimensions invalid: " << path
                 << " (dimensions=" << width << "x" << height << ")" << std::endl;
-            stbi_image_free(data);
             return nullptr;
         }
-        const size_t dimension = static_cast<size_t>(width);
-        const size_t pixelCount = dimension * dimension;
-        std::vector<unsigned char> samples(pixelCount);
-        std::memcpy(samples.data(), data, pixelCount);
-        stbi_image_free(data);
-        std::vector<float> heightSamples(pixelCount);
-        for (size_t i = 0; i < pixelCount; ++i) {
-            heightSamples[i] = static_cast<float>(samples[i]);
-        }
-        try {
-            auto* mesh = new HeightmapMesh(samples, dimension, scale);
-            std::cerr << "[B_Factory] Heightmap loaded: " << path
-                << " (" << dimension << "x" << dimension << ") scale="
-                << scale.x << "," << scale.y << "," << scale.z << "\n";
-            auto heightmap = std::make_shared<B_Heightmap>(mesh, std::move(heightSamples), dimension, scale);
-            if (heightmap) {
-                Engine::IAL::PBRMaterial material;
-                material.baseColorFactor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
-                material.metallicFactor = 0.0f;
-                material.roughnessFactor = 1.0f;
-                material.alphaMode = Engine::IAL::AlphaMode::Opaque;
-                material.doubleSided = false;
-                heightmap->SetPBRMaterial(material);
-            }
-            return heightmap;
-        }
-        catch (const std::exception& ex) {
-            std::cerr << "[B_Factory] Exception constructing heightmap mesh for " << path
-                << ": " << ex.what() << std::endl;
+        return BuildHeightmap(std::move(heightSamples), static_cast<size_t>(width), scale, maxError, path);
+    }
+
+    std::shared_ptr<Engine::IAL::I_Heightmap> B_Factory::CreateProceduralHeightmap(
+        const Engine::IAL::ProceduralTerrainDesc& desc, const Vector3& scale, float maxError) {
+        if (desc.dimension < 2) {
+            std::cerr << "[B_Factory] Procedural heightmap dimension invalid: " << desc.dimension << std::endl;
+            return nullptr;
         }
-        return nullptr;
+        const auto generateStart = std::chrono::high_resolution_clock::now();
+        std::vector<float> heightSamples = B_ProceduralTerrain::Generate(desc);
+        const auto generateEnd = std::chrono::high_resolution_clock::now();
+        std::cerr << "[B_Factory] Procedural heightmap generated in "
+            << std::chrono::duration<float, std::milli>(generateEnd - generateStart).count() << "ms (seed="
+            << desc.seed << ", " << desc.octaves << " octaves, "
+            << (desc.noiseType == Engine::IAL::TerrainNoiseType::Ridged ? "ridged" : "fractal")
+            << ", erosion passes=" << desc.erosionPasses << ")\n";
+        return BuildHeightmap(std::move(heightSamples), desc.dimension, scale, maxError,
+                              "procedural seed " + std::to_string(desc.seed));
     }
 
     namespace {
@@ -690,6 +787,16 @@ namespace NCLGL_Impl {
         return fbo;
     }
 
+    std::shared_ptr<Engine::IAL::I_FrameBuffer> B_Factory::CreateShadowMomentFBO(
+        int width, int height, int components) {
+        const AttachmentFormat format = components <= 2 ? AttachmentFormat::ColorRG32F : AttachmentFormat::Color32F;
+        auto fbo = std::make_shared<B_FrameBuffer>(width, height, format);
+        std::cerr << "[B_Factory] Shadow moment FBO layout "
+            << BuildLayoutDescription(fbo) << ". Size: "
+            << width << "x" << height << "\n";
+        return fbo;
+    }
+
     std::shared_ptr<Engine::IAL::I_AnimatedMesh> B_Factory::LoadAnimatedMesh(
         const std::string& path,
         const std::string& animPathOrName) {
@@ -710,11 +817,14 @@ namespace NCLGL_Impl {
 
         try {
             if (modelExtension == ".gltf" || modelExtension == ".glb") {
+                const auto loadStart = std::chrono::steady_clock::now();
                 GLTFScene scene;
                 if (!GLTFLoader::Load(path, scene) || scene.meshes.empty()) {
                     std::cerr << "[B_Factory] GLTF animated mesh load failed for " << path << "\n";
                     return nullptr;
                 }
+                std::cerr << "[B_Factory] GLTF animated mesh parsed: " << path
+                    << " (" << ElapsedMilliseconds(loadStart) << " ms)\n";
 
                 SharedMesh mesh = scene.meshes.front();
                 if (!mesh) {
@@ -817,4 +927,83 @@ namespace NCLGL_Impl {
         return nullptr;
     }
 
+    std::shared_ptr<Engine::IAL::ModelScene> B_Factory::LoadModelScene(const std::string& path) {
+        if (path.empty()) {
+            return nullptr;
+        }
+        const std::string extension = ExtractExtension(path);
+        if (extension != ".gltf" && extension != ".glb") {
+            std::cerr << "[B_Factory] Model scene import only supports glTF: " << path << "\n";
+            return nullptr;
+        }
+
+        try {
+            const auto loadStart = std::chrono::steady_clock::now();
+            GLTFScene scene;
+            if (!GLTFLoader::Load(path, scene) || scene.meshes.empty()) {
+                std::cerr << "[B_Factory] GLTF scene load failed for " << path << "\n";
+                return nullptr;
+            }
+
+            // 每个 glTF 网格只包装一次，引用它的所有节点共享同一个 B_Mesh 与 GPU 缓冲。
+            // 缓冲按网格而非按文件合并，原因见 B_Factory.h 中 LoadModelScene 的说明。
+            std::unordered_map<const ::Mesh*, std::shared_ptr<B_Mesh>> wrappedMeshes;
+            for (std::size_t i = 0; i < scene.meshes.size(); ++i) {
+                const SharedMesh& mesh = scene.meshes[i];
+                if (!mesh) {
+                    continue;
+                }
+                auto wrappedMesh = std::make_shared<B_Mesh>(mesh);
+                if (i < scene.materials.size()) {
+                    std::vector<Engine::IAL::PBRMaterial> subMeshMaterials;
+                    subMeshMaterials.reserve(scene.materials[i].allLayers.size());
+                    for (const auto& layer : scene.materials[i].allLayers) {
+                        subMeshMaterials.emplace_back(BuildPBRMaterial(layer));
+                    }
+                    if (!subMeshMaterials.empty()) {
+                        wrappedMesh->SetPBRMaterial(subMeshMaterials.front());
+                        if (subMeshMaterials.front().baseColor) {
+                            wrappedMesh->SetDefaultTexture(subMeshMaterials.front().baseColor);
+                        }
+                    }
+                    wrappedMesh->SetSubMeshMaterials(subMeshMaterials);
+                }
+                wrappedMeshes[mesh.get()] = wrappedMesh;
+            }
+
+            auto modelScene = std::make_shared<Engine::IAL::ModelScene>();
+            modelScene->meshCount = wrappedMeshes.size();
+            modelScene->nodes.resize(scene.sceneNodes.size());
+            std::size_t meshInstances = 0;
+            for (std::size_t i = 0; i < scene.sceneNodes.size(); ++i) {
+                const GLTFNode& source = scene.sceneNodes[i];
+                Engine::IAL::ModelNode& node = modelScene->nodes[i];
+                node.name = source.name;
+                node.localTransform = source.localMatrix;
+                node.parent = source.parent;
+                if (source.mesh) {
+                    const auto found = wrappedMeshes.find(source.mesh);
+                    if (found != wrappedMeshes.end()) {
+                        node.mesh = found->second;
+                        ++meshInstances;
+                    }
+                }
+                if (node.parent < 0) {
+                    modelScene->roots.push_back(static_cast<int>(i));
+                }
+            }
+
+            std::cerr << "[B_Factory] GLTF scene loaded: " << path
+                << " (nodes=" << modelScene->nodes.size()
+                << ", meshes=" << modelScene->meshCount
+                << ", mesh instances=" << meshInstances
+                << ", " << ElapsedMilliseconds(loadStart) << " ms)\n";
+            return modelScene;
+        }
+        catch (const std::exception& ex) {
+            std::cerr << "[B_Factory] Exception while loading model scene " << path << ": " << ex.what() << "\n";
+            return nullptr;
+        }
+    }
+
 }
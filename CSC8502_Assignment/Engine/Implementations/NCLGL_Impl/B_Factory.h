@@ -17,11 +17,18 @@
  * LoadMesh: 使用 GLTFLoader 加载 glTF 资产并返回 B_GLTFMesh 适配器。
  * LoadTexture: 加载并返回包装了 OpenGL 纹理 ID 的 B_Texture。
  * LoadCubemap: 加载立方体贴图并返回 B_Texture。
- * LoadHeightmap: 加载 RAW 高度图数据并返回 B_Heightmap。
+ * LoadHeightmap: 加载 RAW 高度图数据并返回 B_Heightmap；maxError > 0 时网格经 B_TerrainSimplifier 自适应三角化。
+ * CreateProceduralHeightmap: 由 B_ProceduralTerrain 生成采样，之后与 LoadHeightmap 共用网格构建与法线烘焙。
  * CreateQuad: 创建一个用于后处理的全屏四边形 B_Mesh。
  * CreateShadowFBO: 创建仅包含深度附件的 B_FrameBuffer（禁用颜色附件，适用于阴影映射）。
  * CreatePostProcessFBO: 创建同时包含颜色/深度附件的 B_FrameBuffer（适用于后处理）。
+ * CreateShadowMomentFBO: 创建仅含 32 位浮点颜色附件的 B_FrameBuffer（适用于预过滤阴影的矩图集）。
  * LoadAnimatedMesh: 加载并返回包装了 Mesh 和 MeshAnimation 的 B_AnimatedMesh。
+ * LoadModelScene: 加载 glTF 的完整节点层级，网格按文件内索引共享，并附带逐子网格材质。
+ *   顶点/索引缓冲按 glTF 网格划分：同一网格的所有图元共用一组 VB/IB，以 SubMesh 的 start/base 区分；
+ *   不同网格不合并到一组缓冲，因为蒙皮数据（jointNames、bindPose）挂在各自的 ::Mesh 上，
+ *   且 GLTFScene::meshes 的逐网格划分也是 LoadMesh/LoadAnimatedMesh 与烘焙缓存格式的约定。
+ *   仓库中的模型均只含一个 glTF 网格，因此实际上每个模型只有一组 VB/IB。
  */
 #pragma once
 #include "IAL/I_ResourceFactory.h"
@@ -49,7 +56,10 @@ namespace NCLGL_Impl {
             const std::string& negz, const std::string& posz) override;
 
         std::shared_ptr<Engine::IAL::I_Heightmap> LoadHeightmap(
-            const std::string& path, const Vector3& scale) override;
+            const std::string& path, const Vector3& scale, float maxError = 0.0f) override;
+
+        std::shared_ptr<Engine::IAL::I_Heightmap> CreateProceduralHeightmap(
+            const Engine::IAL::ProceduralTerrainDesc& desc, const Vector3& scale, float maxError = 0.0f) override;
 
         std::shared_ptr<Engine::IAL::I_Mesh> CreateQuad() override;
 
@@ -59,9 +69,14 @@ namespace NCLGL_Impl {
         std::shared_ptr<Engine::IAL::I_FrameBuffer> CreatePostProcessFBO(
             int width, int height) override;
 
+        std::shared_ptr<Engine::IAL::I_FrameBuffer> CreateShadowMomentFBO(
+            int width, int height, int components) override;
+
         std::shared_ptr<Engine::IAL::I_AnimatedMesh> LoadAnimatedMesh(
             const std::string& path,
             const std::string& animPathOrName) override;
+
+        std::shared_ptr<Engine::IAL::ModelScene> LoadModelScene(const std::string& path) override;
     };
 
 }
\ No newline at end of file
@@ -100,6 +100,65 @@ namespace NCLGL_Impl {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
+    B_FrameBuffer::B_FrameBuffer(int width, int height, AttachmentFormat colorFormat) :
+        m_fboID(0),
+        m_colorTexture(nullptr),
+        m_depthTexture(nullptr),
+        m_hasColorAttachment(true),
+        m_colorFormat(colorFormat),
+        m_depthFormat(AttachmentFormat::None) {
+        GLint internalFormat = GL_RGBA16F;
+        GLenum pixelFormat = GL_RGBA;
+        switch (colorFormat) {
+        case AttachmentFormat::Color8:
+            internalFormat = GL_RGBA8;
+            break;
+        case AttachmentFormat::ColorRG32F:
+            internalFormat = GL_RG32F;
+            pixelFormat = GL_RG;
+            break;
+        case AttachmentFormat::Color32F:
+            internalFormat = GL_RGBA32F;
+            break;
+        default:
+            m_colorFormat = AttachmentFormat::Color16F;
+            break;
+        }
+
+        glGenFramebuffers(1, &m_fboID);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
+
+        unsigned int colorID = 0;
+        glGenTextures(1, &colorID);
+        glBindTexture(GL_TEXTURE_2D, colorID);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, pixelFormat, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorID, 0);
+        m_colorTexture = std::make_shared<B_Texture>(colorID, Engine::IAL::TextureType::Texture2D);
+
+        const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0};
+        glDrawBuffers(1, drawBuffers);
+
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        const std::string layoutDesc = DescribeLayout();
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "[B_FrameBuffer] Incomplete GL_FRAMEBUFFER " << layoutDesc << " "
+                << width << "x" << height << ", status: 0x" << std::hex
+                << status << std::dec << "\n";
+        }
+        else {
+            std::cerr << "[B_FrameBuffer] GL_FRAMEBUFFER complete " << layoutDesc << " "
+                << width << "x" << height << ", status: 0x" << std::hex
+                << status << std::dec << "\n";
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
     B_FrameBuffer::~B_FrameBuffer() {
         GLint bound = 0;
         glGetIntegerv(GL_FRAMEBUFFER_BINDING, &bound);
@@ -148,6 +207,9 @@ namespace NCLGL_Impl {
             }
             return "Depth-only (" + depthStr + ")";
         }
+        if (m_depthFormat == AttachmentFormat::None) {
+            return "Color-only (" + AttachmentFormatToString(m_colorFormat) + ")";
+        }
 
         std::string description = "Color+Depth (" + AttachmentFormatToString(m_colorFormat);
         if (m_depthFormat != AttachmentFormat::None) {
@@ -165,6 +227,10 @@ namespace NCLGL_Impl {
             return "Color8";
         case AttachmentFormat::Color16F:
             return "Color16F";
+        case AttachmentFormat::ColorRG32F:
+            return "ColorRG32F";
+        case AttachmentFormat::Color32F:
+            return "Color32F";
         case AttachmentFormat::Depth24:
             return "Depth24";
         case AttachmentFormat::Depth32F:
@@ -18,6 +18,9 @@
 *   - 当 enableColorAttachment 为 false 时，仅创建深度附件，同时通过 glDrawBuffer/glReadBuffer 设置
 *     GL_NONE，以生成阴影贴图使用的深度专用 FBO。
 *
+* 构造函数 B_FrameBuffer(int width, int height, AttachmentFormat colorFormat):
+* 仅创建指定格式的颜色附件、不带深度附件，供全屏处理的中间结果（例如阴影矩图集）使用。
+*
 * 析构函数 ~B_FrameBuffer():
 * 负责解绑并销毁 OpenGL FBO 资源，同时释放纹理附件。
 *
@@ -43,6 +46,8 @@ namespace NCLGL_Impl {
         None,
         Color8,
         Color16F,
+        ColorRG32F,
+        Color32F,
         Depth24,
         Depth32F
     };
@@ -50,6 +55,7 @@ namespace NCLGL_Impl {
     class B_FrameBuffer : public Engine::IAL::I_FrameBuffer {
     public:
         B_FrameBuffer(int width, int height, bool enableColorAttachment);
+        B_FrameBuffer(int width, int height, AttachmentFormat colorFormat);
         ~B_FrameBuffer() override;
 
         void Bind() override;
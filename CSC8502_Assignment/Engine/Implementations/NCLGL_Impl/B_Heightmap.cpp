@@ -9,10 +9,51 @@
 #include "nclgl/Mesh.h"
 #include "nclgl/Vector4.h"
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <execution>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define B_HEIGHTMAP_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace NCLGL_Impl {
 
+    namespace {
+        std::unique_ptr<B_Heightmap> CreateBenchmarkHeightmap() {
+            constexpr std::size_t kDimension = 1024;
+            std::vector<float> samples(kDimension * kDimension);
+            for (std::size_t z = 0; z < kDimension; ++z) {
+                for (std::size_t x = 0; x < kDimension; ++x) {
+                    samples[z * kDimension + x] = 128.0f + 100.0f * std::sin(x * 0.013f) * std::cos(z * 0.017f) +
+                                                  6.0f * std::sin(x * 0.21f + z * 0.17f);
+                }
+            }
+            return std::make_unique<B_Heightmap>(nullptr, std::move(samples), kDimension, Vector3(4.0f, 0.4f, 4.0f));
+        }
+
+        bool IntersectSlab(float origin, float direction, float inverse, float lo, float hi, float& tEnter, float& tExit) {
+            if (std::abs(direction) < 1e-12f) {
+                return origin >= lo && origin <= hi;
+            }
+            float t0 = (lo - origin) * inverse;
+            float t1 = (hi - origin) * inverse;
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            tEnter = std::max(tEnter, t0);
+            tExit = std::min(tExit, t1);
+            return tEnter <= tExit;
+        }
+    }
+
     B_Heightmap::B_Heightmap(::Mesh* mesh,
                              std::vector<float> samples,
                              size_t dimension,
@@ -27,6 +68,7 @@ namespace NCLGL_Impl {
         m_pbrMaterial.roughnessFactor = 1.0f;
         m_pbrMaterial.alphaMode = Engine::IAL::AlphaMode::Opaque;
         m_pbrMaterial.doubleSided = false;
+        BuildMinMaxPyramid();
     }
 
     B_Heightmap::~B_Heightmap() {
@@ -39,6 +81,24 @@ namespace NCLGL_Impl {
         }
     }
 
+    std::size_t B_Heightmap::GetTriangleCount() const {
+        return m_mesh ? m_mesh->GetTriCount() : 0;
+    }
+
+    void B_Heightmap::DrawDepth() {
+        if (m_mesh) {
+            m_mesh->DrawDepth();
+        }
+    }
+
+    std::size_t B_Heightmap::GetVertexFetchBytes(bool depthStream) const {
+        if (!m_mesh) {
+            return 0;
+        }
+        const std::size_t stride = depthStream ? m_mesh->GetDepthVertexStride() : m_mesh->GetVertexStride();
+        return static_cast<std::size_t>(m_mesh->GetVertexCount()) * stride;
+    }
+
     float B_Heightmap::SampleHeight(float x, float z) const {
         if (m_dimension == 0 || m_samples.empty()) {
             return 0.0f;
@@ -71,6 +131,584 @@ namespace NCLGL_Impl {
         return height * m_scale.y;
     }
 
+    void B_Heightmap::SampleHeights(std::span<const float> xs,
+                                    std::span<const float> zs,
+                                    std::span<float> outHeights) const {
+        const std::size_t count = std::min({ xs.size(), zs.size(), outHeights.size() });
+        if (m_dimension == 0 || m_samples.empty()) {
+            std::fill_n(outHeights.begin(), count, 0.0f);
+            return;
+        }
+        std::size_t i = 0;
+#ifdef B_HEIGHTMAP_SSE2
+        const float* samples = m_samples.data();
+        const int maxIndex = static_cast<int>(m_dimension - 1);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 maxCoord = _mm_set1_ps(static_cast<float>(maxIndex));
+        const __m128 scaleX = _mm_set1_ps(m_scale.x);
+        const __m128 scaleZ = _mm_set1_ps(m_scale.z);
+        const __m128 scaleY = _mm_set1_ps(m_scale.y);
+        for (; i + 4 <= count; i += 4) {
+            // 与 SampleHeight 相同的运算顺序：先除以缩放再 clamp，坐标非负，因此截断即 floor。
+            const __m128 sx = _mm_min_ps(_mm_max_ps(_mm_div_ps(_mm_loadu_ps(xs.data() + i), scaleX), zero), maxCoord);
+            const __m128 sz = _mm_min_ps(_mm_max_ps(_mm_div_ps(_mm_loadu_ps(zs.data() + i), scaleZ), zero), maxCoord);
+            const __m128i ix = _mm_cvttps_epi32(sx);
+            const __m128i iz = _mm_cvttps_epi32(sz);
+            const __m128 tx = _mm_sub_ps(sx, _mm_cvtepi32_ps(ix));
+            const __m128 tz = _mm_sub_ps(sz, _mm_cvtepi32_ps(iz));
+
+            alignas(16) int x0[4];
+            alignas(16) int z0[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(x0), ix);
+            _mm_store_si128(reinterpret_cast<__m128i*>(z0), iz);
+
+            alignas(16) float h00[4];
+            alignas(16) float h10[4];
+            alignas(16) float h01[4];
+            alignas(16) float h11[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                const int x1 = std::min(x0[lane] + 1, maxIndex);
+                const int z1 = std::min(z0[lane] + 1, maxIndex);
+                const float* row0 = samples + static_cast<std::size_t>(z0[lane]) * m_dimension;
+                const float* row1 = samples + static_cast<std::size_t>(z1) * m_dimension;
+                h00[lane] = row0[x0[lane]];
+                h10[lane] = row0[x1];
+                h01[lane] = row1[x0[lane]];
+                h11[lane] = row1[x1];
+            }
+            const __m128 a = _mm_load_ps(h00);
+            const __m128 b = _mm_load_ps(h10);
+            const __m128 c = _mm_load_ps(h01);
+            const __m128 d = _mm_load_ps(h11);
+            const __m128 hx0 = _mm_add_ps(a, _mm_mul_ps(tx, _mm_sub_ps(b, a)));
+            const __m128 hx1 = _mm_add_ps(c, _mm_mul_ps(tx, _mm_sub_ps(d, c)));
+            const __m128 height = _mm_add_ps(hx0, _mm_mul_ps(tz, _mm_sub_ps(hx1, hx0)));
+            _mm_storeu_ps(outHeights.data() + i, _mm_mul_ps(height, scaleY));
+        }
+#endif
+        for (; i < count; ++i) {
+            outHeights[i] = B_Heightmap::SampleHeight(xs[i], zs[i]);
+        }
+    }
+
+    void B_Heightmap::SampleNormals(std::span<const float> xs,
+                                    std::span<const float> zs,
+                                    std::span<Vector3> outNormals,
+                                    std::span<float> outSlopes) const {
+        constexpr std::size_t kChunk = 64;
+        const std::size_t count = std::min(xs.size(), zs.size());
+        // 四组偏移坐标依次为 -x、+x、-z、+z，一次批量采样完成整块的中心差分。
+        std::array<float, kChunk * 4> offsetX{};
+        std::array<float, kChunk * 4> offsetZ{};
+        std::array<float, kChunk * 4> heights{};
+        const float invSpanX = 1.0f / (2.0f * m_scale.x);
+        const float invSpanZ = 1.0f / (2.0f * m_scale.z);
+
+        for (std::size_t start = 0; start < count; start += kChunk) {
+            const std::size_t n = std::min(kChunk, count - start);
+            for (std::size_t j = 0; j < n; ++j) {
+                const float x = xs[start + j];
+                const float z = zs[start + j];
+                offsetX[j] = x - m_scale.x;
+                offsetZ[j] = z;
+                offsetX[kChunk + j] = x + m_scale.x;
+                offsetZ[kChunk + j] = z;
+                offsetX[kChunk * 2 + j] = x;
+                offsetZ[kChunk * 2 + j] = z - m_scale.z;
+                offsetX[kChunk * 3 + j] = x;
+                offsetZ[kChunk * 3 + j] = z + m_scale.z;
+            }
+            SampleHeights(offsetX, offsetZ, heights);
+
+            for (std::size_t j = 0; j < n; ++j) {
+                const float dx = (heights[kChunk + j] - heights[j]) * invSpanX;
+                const float dz = (heights[kChunk * 3 + j] - heights[kChunk * 2 + j]) * invSpanZ;
+                const std::size_t index = start + j;
+                if (index < outNormals.size()) {
+                    Vector3 normal(-dx, 1.0f, -dz);
+                    normal.Normalise();
+                    outNormals[index] = normal;
+                }
+                if (index < outSlopes.size()) {
+                    outSlopes[index] = std::sqrt(dx * dx + dz * dz);
+                }
+            }
+        }
+    }
+
+    void B_Heightmap::BakeNormalTexel(std::size_t x, std::size_t z, std::int16_t* out) const {
+        const std::size_t last = m_dimension - 1;
+        auto sample = [&](std::size_t sx, std::size_t sz) {
+            return m_samples[sz * m_dimension + sx];
+        };
+        const float dx = (sample(std::min(x + 1, last), z) - sample(x > 0 ? x - 1 : 0, z)) * m_scale.y;
+        const float dz = (sample(x, std::min(z + 1, last)) - sample(x, z > 0 ? z - 1 : 0)) * m_scale.y;
+
+        // cross((0, dz, 2sz), (2sx, dx, 0))，与 HeightmapMesh 的顶点法线相同
+        Vector3 normal(-2.0f * m_scale.z * dx, 4.0f * m_scale.x * m_scale.z, -2.0f * m_scale.x * dz);
+        normal.Normalise();
+        out[0] = static_cast<std::int16_t>(std::lround(normal.x * 32767.0f));
+        out[1] = static_cast<std::int16_t>(std::lround(normal.z * 32767.0f));
+    }
+
+    void B_Heightmap::BakeNormalRow(std::size_t z, std::int16_t* out, bool useSimd) const {
+        std::size_t x = 0;
+#if defined(B_HEIGHTMAP_SSE2)
+        if (useSimd && m_dimension >= 6) {
+            const float* row = &m_samples[z * m_dimension];
+            const float* rowDown = &m_samples[(z > 0 ? z - 1 : z) * m_dimension];
+            const float* rowUp = &m_samples[std::min(z + 1, m_dimension - 1) * m_dimension];
+            const __m128 scaleX = _mm_set1_ps(-2.0f * m_scale.z * m_scale.y);
+            const __m128 scaleZ = _mm_set1_ps(-2.0f * m_scale.x * m_scale.y);
+            const __m128 ny = _mm_set1_ps(4.0f * m_scale.x * m_scale.z);
+            const __m128 nySq = _mm_mul_ps(ny, ny);
+            const __m128 quantise = _mm_set1_ps(32767.0f);
+
+            BakeNormalTexel(0, z, out);
+            // 内部点的左右/上下邻居都在范围内，可以直接做非对齐加载
+            for (x = 1; x + 4 <= m_dimension - 1; x += 4) {
+                const __m128 nx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(row + x + 1), _mm_loadu_ps(row + x - 1)), scaleX);
+                const __m128 nz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(rowUp + x), _mm_loadu_ps(rowDown + x)), scaleZ);
+                const __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), nySq), _mm_mul_ps(nz, nz));
+                const __m128 inverse = _mm_div_ps(quantise, _mm_sqrt_ps(lengthSq));
+                const __m128i ix = _mm_cvtps_epi32(_mm_mul_ps(nx, inverse));
+                const __m128i iz = _mm_cvtps_epi32(_mm_mul_ps(nz, inverse));
+                const __m128i packed = _mm_unpacklo_epi16(_mm_packs_epi32(ix, ix), _mm_packs_epi32(iz, iz));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2), packed);
+            }
+        }
+#else
+        (void)useSimd;
+#endif
+        for (; x < m_dimension; ++x) {
+            BakeNormalTexel(x, z, out + x * 2);
+        }
+    }
+
+    std::vector<std::int16_t> B_Heightmap::BakeNormalMap() const {
+        std::vector<std::int16_t> texels(m_dimension * m_dimension * 2);
+        if (m_samples.empty()) {
+            return texels;
+        }
+        std::vector<std::size_t> rows(m_dimension);
+        std::iota(rows.begin(), rows.end(), std::size_t{ 0 });
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::size_t z) {
+            BakeNormalRow(z, &texels[z * m_dimension * 2], true);
+        });
+        return texels;
+    }
+
+    void B_Heightmap::SetNormalTexture(std::shared_ptr<Engine::IAL::I_Texture> texture) {
+        m_normalTexture = std::move(texture);
+    }
+
+    std::shared_ptr<Engine::IAL::I_Texture> B_Heightmap::GetNormalTexture() const {
+        return m_normalTexture;
+    }
+
+    void B_Heightmap::BenchmarkNormalBake() {
+        const std::unique_ptr<B_Heightmap> heightmap = CreateBenchmarkHeightmap();
+        const std::size_t dimension = heightmap->m_dimension;
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        std::vector<std::int16_t> scalar(dimension * dimension * 2);
+        for (std::size_t z = 0; z < dimension; ++z) {
+            heightmap->BakeNormalRow(z, &scalar[z * dimension * 2], false);
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+        const float scalarMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+
+        startTime = std::chrono::high_resolution_clock::now();
+        const std::vector<std::int16_t> baked = heightmap->BakeNormalMap();
+        endTime = std::chrono::high_resolution_clock::now();
+        const float bakedMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+
+        // SSE2 按“最近偶数”取整，标量路径四舍五入，允许 1 个量化单位的差异
+        int maxDifference = 0;
+        for (std::size_t i = 0; i < scalar.size(); ++i) {
+            maxDifference = std::max(maxDifference, std::abs(static_cast<int>(scalar[i]) - static_cast<int>(baked[i])));
+        }
+        std::cerr << "[B_Heightmap] Normal bake " << dimension << "x" << dimension << ": scalar "
+                  << scalarMs << "ms, parallel SIMD " << bakedMs << "ms ("
+                  << (bakedMs > 0.0f ? scalarMs / bakedMs : 0.0f) << "x), max difference " << maxDifference << "\n";
+    }
+
+    void B_Heightmap::BenchmarkSampling(std::size_t queryCount) {
+        auto heightmap = CreateBenchmarkHeightmap();
+        const Engine::IAL::I_Heightmap& terrain = *heightmap;
+        const Vector2 resolution = terrain.GetResolution();
+        const Vector3 scale = terrain.GetWorldScale();
+
+        std::mt19937 rng(1337u);
+        std::uniform_real_distribution<float> dist(0.0f, (resolution.x - 1.0f) * scale.x);
+        std::vector<float> xs(queryCount);
+        std::vector<float> zs(queryCount);
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            xs[i] = dist(rng);
+            zs[i] = dist(rng);
+        }
+        std::vector<float> scalarHeights(queryCount);
+        std::vector<float> batchHeights(queryCount);
+        std::vector<Vector3> normals(queryCount);
+        std::vector<float> slopes(queryCount);
+
+        using Clock = std::chrono::high_resolution_clock;
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            scalarHeights[i] = terrain.SampleHeight(xs[i], zs[i]);
+        }
+        const float scalarMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        start = Clock::now();
+        terrain.SampleHeights(xs, zs, batchHeights);
+        const float batchMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        start = Clock::now();
+        terrain.SampleNormals(xs, zs, normals, slopes);
+        const float normalMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        float maxError = 0.0f;
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            maxError = std::max(maxError, std::abs(scalarHeights[i] - batchHeights[i]));
+        }
+
+        std::cerr << "[B_Heightmap] " << queryCount << " height queries: scalar " << scalarMs
+                  << "ms, batched " << batchMs << "ms (x" << (batchMs > 0.0f ? scalarMs / batchMs : 0.0f)
+                  << "), normals+slopes " << normalMs << "ms, max error " << maxError << "\n";
+    }
+
+    void B_Heightmap::BuildMinMaxPyramid() {
+        m_minMaxLevels.clear();
+        if (m_dimension < 2 || m_samples.size() < m_dimension * m_dimension) {
+            return;
+        }
+        const std::size_t cells = m_dimension - 1;
+        std::size_t childSize = cells;
+        while (childSize > 1) {
+            MinMaxLevel level;
+            level.size = (childSize + 1) / 2;
+            level.minValues.resize(level.size * level.size);
+            level.maxValues.resize(level.size * level.size);
+            const int childLevel = static_cast<int>(m_minMaxLevels.size()) - 1;
+            for (std::size_t j = 0; j < level.size; ++j) {
+                for (std::size_t i = 0; i < level.size; ++i) {
+                    float nodeMin = std::numeric_limits<float>::max();
+                    float nodeMax = std::numeric_limits<float>::lowest();
+                    for (std::size_t cj = j * 2; cj < std::min(j * 2 + 2, childSize); ++cj) {
+                        for (std::size_t ci = i * 2; ci < std::min(i * 2 + 2, childSize); ++ci) {
+                            float childMin = 0.0f;
+                            float childMax = 0.0f;
+                            GetNodeRange(childLevel, ci, cj, childMin, childMax);
+                            nodeMin = std::min(nodeMin, childMin);
+                            nodeMax = std::max(nodeMax, childMax);
+                        }
+                    }
+                    level.minValues[j * level.size + i] = nodeMin;
+                    level.maxValues[j * level.size + i] = nodeMax;
+                }
+            }
+            childSize = level.size;
+            m_minMaxLevels.push_back(std::move(level));
+        }
+    }
+
+    std::size_t B_Heightmap::NodeSpan(int level) const {
+        return static_cast<std::size_t>(1) << (level + 1);
+    }
+
+    void B_Heightmap::GetNodeRange(int level, std::size_t i, std::size_t j, float& outMin, float& outMax) const {
+        if (level < 0) {
+            const float* row0 = m_samples.data() + j * m_dimension;
+            const float* row1 = row0 + m_dimension;
+            outMin = std::min({ row0[i], row0[i + 1], row1[i], row1[i + 1] });
+            outMax = std::max({ row0[i], row0[i + 1], row1[i], row1[i + 1] });
+            return;
+        }
+        const MinMaxLevel& nodes = m_minMaxLevels[level];
+        outMin = nodes.minValues[j * nodes.size + i];
+        outMax = nodes.maxValues[j * nodes.size + i];
+    }
+
+    bool B_Heightmap::IntersectNode(const Ray& ray, int level, std::size_t i, std::size_t j, float& tEnter, float& tExit) const {
+        const std::size_t cells = m_dimension - 1;
+        const std::size_t span = NodeSpan(level);
+        float nodeMin = 0.0f;
+        float nodeMax = 0.0f;
+        GetNodeRange(level, i, j, nodeMin, nodeMax);
+        const float minX = static_cast<float>(i * span) * m_scale.x;
+        const float maxX = static_cast<float>(std::min((i + 1) * span, cells)) * m_scale.x;
+        const float minZ = static_cast<float>(j * span) * m_scale.z;
+        const float maxZ = static_cast<float>(std::min((j + 1) * span, cells)) * m_scale.z;
+        // 地形视为向下无限延伸的实体，因此节点包围盒只用最大高度封顶，最小高度不参与剪枝。
+        (void)nodeMin;
+        return IntersectSlab(ray.origin.x, ray.direction.x, ray.inverse.x, minX, maxX, tEnter, tExit) &&
+               IntersectSlab(ray.origin.z, ray.direction.z, ray.inverse.z, minZ, maxZ, tEnter, tExit) &&
+               IntersectSlab(ray.origin.y, ray.direction.y, ray.inverse.y,
+                             -std::numeric_limits<float>::infinity(), nodeMax * m_scale.y, tEnter, tExit);
+    }
+
+    bool B_Heightmap::IntersectCell(const Ray& ray, std::size_t cellX, std::size_t cellZ, float tEnter, float tExit, float& tHit) const {
+        const float* row0 = m_samples.data() + cellZ * m_dimension;
+        const float* row1 = row0 + m_dimension;
+        const float a = row0[cellX] * m_scale.y;
+        const float b = (row0[cellX + 1] - row0[cellX]) * m_scale.y;
+        const float c = (row1[cellX] - row0[cellX]) * m_scale.y;
+        const float d = (row0[cellX] - row0[cellX + 1] - row1[cellX] + row1[cellX + 1]) * m_scale.y;
+
+        // 单元内 u、v 随 t 线性变化，双线性高度是 t 的二次式：gap(t) = c0 + c1·t + c2·t²。
+        const float u0 = ray.origin.x / m_scale.x - static_cast<float>(cellX);
+        const float v0 = ray.origin.z / m_scale.z - static_cast<float>(cellZ);
+        const float du = ray.direction.x / m_scale.x;
+        const float dv = ray.direction.z / m_scale.z;
+        const float c0 = ray.origin.y - (a + b * u0 + c * v0 + d * u0 * v0);
+        const float c1 = ray.direction.y - (b * du + c * dv + d * (u0 * dv + v0 * du));
+        const float c2 = -d * du * dv;
+        auto gap = [&](float t) { return c0 + (c1 + c2 * t) * t; };
+
+        if (gap(tEnter) <= 0.0f) {
+            tHit = tEnter;
+            return true;
+        }
+        if (gap(tExit) > 0.0f) {
+            // 两端都在曲面之上时，只有二次曲线在区间内下凹穿过曲面才会相交。
+            if (std::abs(c2) < 1e-12f) {
+                return false;
+            }
+            const float tVertex = -c1 / (2.0f * c2);
+            if (tVertex <= tEnter || tVertex >= tExit || gap(tVertex) > 0.0f) {
+                return false;
+            }
+            tExit = tVertex;
+        }
+        float root = tExit;
+        if (std::abs(c2) < 1e-12f) {
+            root = std::abs(c1) > 0.0f ? -c0 / c1 : tExit;
+        }
+        else {
+            const float discriminant = c1 * c1 - 4.0f * c2 * c0;
+            if (discriminant >= 0.0f) {
+                const float q = -0.5f * (c1 + std::copysign(std::sqrt(discriminant), c1));
+                const float r0 = q / c2;
+                const float r1 = q != 0.0f ? c0 / q : r0;
+                root = std::min(r0 >= tEnter ? r0 : tExit, r1 >= tEnter ? r1 : tExit);
+            }
+        }
+        tHit = std::clamp(root, tEnter, tExit);
+        return true;
+    }
+
+    bool B_Heightmap::RaycastNode(const Ray& ray, int level, std::size_t i, std::size_t j, float tMin, float& tBest) const {
+        float tEnter = tMin;
+        float tExit = tBest;
+        if (!IntersectNode(ray, level, i, j, tEnter, tExit)) {
+            return false;
+        }
+        if (level < 0) {
+            float tHit = 0.0f;
+            if (IntersectCell(ray, i, j, tEnter, tExit, tHit) && tHit <= tBest) {
+                tBest = tHit;
+                return true;
+            }
+            return false;
+        }
+
+        // 子节点按进入距离由近及远访问，命中更近的交点后即可跳过其余子节点。
+        const int childLevel = level - 1;
+        const std::size_t childSize = childLevel < 0 ? m_dimension - 1 : m_minMaxLevels[childLevel].size;
+        struct Child {
+            std::size_t i;
+            std::size_t j;
+            float tEnter;
+        };
+        std::array<Child, 4> children{};
+        int childCount = 0;
+        for (std::size_t cj = j * 2; cj < std::min(j * 2 + 2, childSize); ++cj) {
+            for (std::size_t ci = i * 2; ci < std::min(i * 2 + 2, childSize); ++ci) {
+                float childEnter = tMin;
+                float childExit = tBest;
+                if (IntersectNode(ray, childLevel, ci, cj, childEnter, childExit)) {
+                    children[childCount++] = { ci, cj, childEnter };
+                }
+            }
+        }
+        std::sort(children.begin(), children.begin() + childCount, [](const Child& a, const Child& b) {
+            return a.tEnter < b.tEnter;
+        });
+        bool hit = false;
+        for (int c = 0; c < childCount; ++c) {
+            if (children[c].tEnter > tBest) {
+                break;
+            }
+            hit |= RaycastNode(ray, childLevel, children[c].i, children[c].j, tMin, tBest);
+        }
+        return hit;
+    }
+
+    bool B_Heightmap::Raycast(const Vector3& origin,
+                              const Vector3& direction,
+                              float maxDistance,
+                              float& outDistance) const {
+        const float length = direction.Length();
+        if (length <= 0.0f || m_dimension < 2 || m_samples.empty()) {
+            return false;
+        }
+        Ray ray;
+        ray.origin = origin;
+        ray.direction = direction / length;
+        ray.inverse = Vector3(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+        float tBest = maxDistance;
+        const int root = static_cast<int>(m_minMaxLevels.size()) - 1;
+        if (!RaycastNode(ray, root, 0, 0, 0.0f, tBest)) {
+            return false;
+        }
+        outDistance = tBest;
+        return true;
+    }
+
+    void B_Heightmap::QueryRange(int level, std::size_t i, std::size_t j,
+                                 std::size_t x0, std::size_t z0, std::size_t x1, std::size_t z1,
+                                 float& outMin, float& outMax) const {
+        const std::size_t cells = m_dimension - 1;
+        const std::size_t span = NodeSpan(level);
+        const std::size_t nodeX0 = i * span;
+        const std::size_t nodeZ0 = j * span;
+        const std::size_t nodeX1 = std::min((i + 1) * span, cells) - 1;
+        const std::size_t nodeZ1 = std::min((j + 1) * span, cells) - 1;
+        if (nodeX0 > x1 || nodeX1 < x0 || nodeZ0 > z1 || nodeZ1 < z0) {
+            return;
+        }
+        if (level < 0 || (nodeX0 >= x0 && nodeX1 <= x1 && nodeZ0 >= z0 && nodeZ1 <= z1)) {
+            float nodeMin = 0.0f;
+            float nodeMax = 0.0f;
+            GetNodeRange(level, i, j, nodeMin, nodeMax);
+            outMin = std::min(outMin, nodeMin);
+            outMax = std::max(outMax, nodeMax);
+            return;
+        }
+        const int childLevel = level - 1;
+        const std::size_t childSize = childLevel < 0 ? cells : m_minMaxLevels[childLevel].size;
+        for (std::size_t cj = j * 2; cj < std::min(j * 2 + 2, childSize); ++cj) {
+            for (std::size_t ci = i * 2; ci < std::min(i * 2 + 2, childSize); ++ci) {
+                QueryRange(childLevel, ci, cj, x0, z0, x1, z1, outMin, outMax);
+            }
+        }
+    }
+
+    bool B_Heightmap::GetHeightRange(float minX,
+                                     float minZ,
+                                     float maxX,
+                                     float maxZ,
+                                     float& outMin,
+                                     float& outMax) const {
+        if (m_dimension < 2 || m_samples.empty() || minX > maxX || minZ > maxZ) {
+            return false;
+        }
+        const int cells = static_cast<int>(m_dimension) - 1;
+        if (maxX < 0.0f || maxZ < 0.0f || minX > cells * m_scale.x || minZ > cells * m_scale.z) {
+            return false;
+        }
+        const std::size_t x0 = static_cast<std::size_t>(std::clamp(static_cast<int>(std::floor(minX / m_scale.x)), 0, cells - 1));
+        const std::size_t x1 = static_cast<std::size_t>(std::clamp(static_cast<int>(std::floor(maxX / m_scale.x)), 0, cells - 1));
+        const std::size_t z0 = static_cast<std::size_t>(std::clamp(static_cast<int>(std::floor(minZ / m_scale.z)), 0, cells - 1));
+        const std::size_t z1 = static_cast<std::size_t>(std::clamp(static_cast<int>(std::floor(maxZ / m_scale.z)), 0, cells - 1));
+
+        float rangeMin = std::numeric_limits<float>::max();
+        float rangeMax = std::numeric_limits<float>::lowest();
+        const int root = static_cast<int>(m_minMaxLevels.size()) - 1;
+        QueryRange(root, 0, 0, x0, z0, x1, z1, rangeMin, rangeMax);
+        outMin = rangeMin * m_scale.y;
+        outMax = rangeMax * m_scale.y;
+        return true;
+    }
+
+    void B_Heightmap::BenchmarkQueries(std::size_t queryCount) {
+        auto heightmap = CreateBenchmarkHeightmap();
+        const Engine::IAL::I_Heightmap& terrain = *heightmap;
+        const Vector2 resolution = terrain.GetResolution();
+        const Vector3 scale = terrain.GetWorldScale();
+        const float extent = (resolution.x - 1.0f) * scale.x;
+        constexpr std::size_t kValidationCount = 2000;
+        constexpr float kPi = 3.14159265f;
+
+        std::mt19937 rng(1337u);
+        std::uniform_real_distribution<float> position(0.0f, extent);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        std::vector<Vector3> origins(queryCount);
+        std::vector<Vector3> directions(queryCount);
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            const float angle = unit(rng) * 2.0f * kPi;
+            origins[i] = Vector3(position(rng), 120.0f, position(rng));
+            directions[i] = Vector3(std::cos(angle), -(0.05f + unit(rng)), std::sin(angle));
+        }
+        std::vector<float> regions(queryCount * 4);
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            const float x = position(rng);
+            const float z = position(rng);
+            regions[i * 4 + 0] = x;
+            regions[i * 4 + 1] = z;
+            regions[i * 4 + 2] = x + unit(rng) * 256.0f;
+            regions[i * 4 + 3] = z + unit(rng) * 256.0f;
+        }
+
+        using Clock = std::chrono::high_resolution_clock;
+        constexpr float kMaxDistance = 4000.0f;
+        std::size_t hits = 0;
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            float distance = 0.0f;
+            hits += terrain.Raycast(origins[i], directions[i], kMaxDistance, distance) ? 1 : 0;
+        }
+        const float rayMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        float checksum = 0.0f;
+        start = Clock::now();
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            float low = 0.0f;
+            float high = 0.0f;
+            if (terrain.GetHeightRange(regions[i * 4], regions[i * 4 + 1], regions[i * 4 + 2], regions[i * 4 + 3], low, high)) {
+                checksum += high - low;
+            }
+        }
+        const float rangeMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        // 以 I_Heightmap 的逐步采样实现为参照，校验前 kValidationCount 个查询。
+        const std::size_t validation = std::min(queryCount, kValidationCount);
+        std::size_t rayMismatches = 0;
+        std::size_t rangeMismatches = 0;
+        for (std::size_t i = 0; i < validation; ++i) {
+            float fast = 0.0f;
+            float reference = 0.0f;
+            const bool fastHit = terrain.Raycast(origins[i], directions[i], kMaxDistance, fast);
+            const bool referenceHit = terrain.I_Heightmap::Raycast(origins[i], directions[i], kMaxDistance, reference);
+            if (fastHit != referenceHit || (fastHit && std::abs(fast - reference) > 0.01f + 1e-4f * reference)) {
+                ++rayMismatches;
+            }
+
+            float fastMin = 0.0f;
+            float fastMax = 0.0f;
+            float referenceMin = 0.0f;
+            float referenceMax = 0.0f;
+            const float* region = &regions[i * 4];
+            terrain.GetHeightRange(region[0], region[1], region[2], region[3], fastMin, fastMax);
+            terrain.I_Heightmap::GetHeightRange(region[0], region[1], region[2], region[3], referenceMin, referenceMax);
+            if (fastMin != referenceMin || fastMax != referenceMax) {
+                ++rangeMismatches;
+            }
+        }
+
+        const auto perSecond = [](std::size_t count, float ms) {
+            return ms > 0.0f ? static_cast<float>(count) / (ms * 0.001f) : 0.0f;
+        };
+        std::cerr << "[B_Heightmap] " << queryCount << " raycasts (" << hits << " hits) in " << rayMs << "ms, "
+                  << perSecond(queryCount, rayMs) << " rays/s; " << rayMismatches << "/" << validation
+                  << " differ from brute force" << "\n";
+        std::cerr << "[B_Heightmap] " << queryCount << " region queries in " << rangeMs << "ms, "
+                  << perSecond(queryCount, rangeMs) << " queries/s (checksum " << checksum << "); "
+                  << rangeMismatches << "/" << validation << " differ from brute force" << "\n";
+    }
+
     Vector3 B_Heightmap::GetWorldScale() const {
         return m_scale;
     }
@@ -22,10 +22,38 @@
  *
  * 成员变量 m_mesh:
  * 指向包含高度图数据的原生 nclgl::Mesh 对象。
+ *
+ * 成员函数 SampleHeights() / SampleNormals():
+ * 批量高度查询。x86/x64 下每 4 个点一组，用 SSE2 完成缩放、clamp、取整与双线性插值，
+ * 仅四个角点的读取为标量（SSE2 没有 gather 指令）；剩余不足 4 个的点走标量路径。
+ * 法线按 64 点分块，把四个中心差分偏移点交给 SampleHeights 批量求值。
+ *
+ * 最小/最大值金字塔:
+ * 构造时在采样数据上建立 min/max 四叉树（第 0 层每个节点覆盖 2×2 个网格单元，
+ * 逐层合并直到只剩一个根节点；单元本身的范围直接由四个角点求得，不单独存储）。
+ * Raycast 自根节点起按进入距离由近及远遍历子节点，用节点包围盒剪枝，
+ * 在叶单元内对双线性曲面解二次方程求精确交点；GetHeightRange 对完全覆盖的节点直接取值，
+ * 只对部分覆盖的节点继续下探。
+ *
+ * 成员函数 BakeNormalMap():
+ * 由采样数据烘焙逐采样点的世界空间法线（与 HeightmapMesh 的中心差分一致），
+ * 输出交错的 x/z 分量（int16 snorm）。各行并行处理，行内每 4 个点一组用 SSE2 求法线并归一化，
+ * 仅边缘一圈走标量路径。B_Factory 把结果上传为纹理并通过 SetNormalTexture 挂回本对象。
+ *
+ * 静态函数 BenchmarkNormalBake():
+ * 比较单线程标量烘焙与并行 SIMD 烘焙的耗时，并校验两者结果一致。
+ *
+ * 静态函数 BenchmarkQueries():
+ * 以默认的逐步采样实现为参照校验 Raycast / GetHeightRange，并记录每秒查询次数。
+ *
+ * 静态函数 BenchmarkSampling():
+ * 在合成的 1024² 高度图上比较逐点虚调用与批量接口的耗时，并把结果写入日志。
  */
 #pragma once
 #include "IAL/I_Heightmap.h"
 #include "nclgl/Vector3.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 class Mesh;
@@ -45,16 +73,71 @@ namespace NCLGL_Impl {
         float SampleHeight(float x, float z) const override;
         Vector3 GetWorldScale() const override;
         Vector2 GetResolution() const override;
+        void SampleHeights(std::span<const float> xs,
+                           std::span<const float> zs,
+                           std::span<float> outHeights) const override;
+        void SampleNormals(std::span<const float> xs,
+                           std::span<const float> zs,
+                           std::span<Vector3> outNormals,
+                           std::span<float> outSlopes) const override;
+        bool Raycast(const Vector3& origin,
+                     const Vector3& direction,
+                     float maxDistance,
+                     float& outDistance) const override;
+        bool GetHeightRange(float minX,
+                            float minZ,
+                            float maxX,
+                            float maxZ,
+                            float& outMin,
+                            float& outMax) const override;
+        bool HasFastHeightRange() const override { return true; }
+        std::shared_ptr<Engine::IAL::I_Texture> GetNormalTexture() const override;
         const Engine::IAL::PBRMaterial* GetPBRMaterial() const override;
         void SetPBRMaterial(const Engine::IAL::PBRMaterial& material);
+        std::size_t GetTriangleCount() const override;
+        void DrawDepth() override;
+        std::size_t GetVertexFetchBytes(bool depthStream) const override;
+
+        std::vector<std::int16_t> BakeNormalMap() const;
+        void SetNormalTexture(std::shared_ptr<Engine::IAL::I_Texture> texture);
+
+        static void BenchmarkSampling(std::size_t queryCount = 1 << 20);
+        static void BenchmarkQueries(std::size_t queryCount = 100000);
+        static void BenchmarkNormalBake();
 
     private:
+        struct MinMaxLevel {
+            std::size_t size = 0;
+            std::vector<float> minValues;
+            std::vector<float> maxValues;
+        };
+
+        struct Ray {
+            Vector3 origin;
+            Vector3 direction;
+            Vector3 inverse;
+        };
+
+        void BakeNormalTexel(std::size_t x, std::size_t z, std::int16_t* out) const;
+        void BakeNormalRow(std::size_t z, std::int16_t* out, bool useSimd) const;
+        void BuildMinMaxPyramid();
+        std::size_t NodeSpan(int level) const;
+        void GetNodeRange(int level, std::size_t i, std::size_t j, float& outMin, float& outMax) const;
+        bool IntersectNode(const Ray& ray, int level, std::size_t i, std::size_t j, float& tEnter, float& tExit) const;
+        bool RaycastNode(const Ray& ray, int level, std::size_t i, std::size_t j, float tMin, float& tBest) const;
+        bool IntersectCell(const Ray& ray, std::size_t cellX, std::size_t cellZ, float tEnter, float tExit, float& tHit) const;
+        void QueryRange(int level, std::size_t i, std::size_t j,
+                        std::size_t x0, std::size_t z0, std::size_t x1, std::size_t z1,
+                        float& outMin, float& outMax) const;
+
         ::Mesh* m_mesh;
         std::vector<float> m_samples;
         size_t m_dimension;
         Vector3 m_scale;
         bool m_hasMaterial;
         Engine::IAL::PBRMaterial m_pbrMaterial;
+        std::vector<MinMaxLevel> m_minMaxLevels;
+        std::shared_ptr<Engine::IAL::I_Texture> m_normalTexture;
     };
 
 }
\ No newline at end of file
@@ -43,5 +43,70 @@ namespace NCLGL_Impl {
         return m_hasPBR ? &m_pbrMaterial : nullptr;
     }
 
+    int B_Mesh::GetSubMeshCount() const {
+        return m_mesh ? m_mesh->GetSubMeshCount() : 0;
+    }
+
+    void B_Mesh::DrawSubMesh(int index) {
+        if (m_mesh) {
+            m_mesh->DrawSubMesh(index);
+        }
+    }
+
+    const Engine::IAL::PBRMaterial* B_Mesh::GetSubMeshMaterial(int index) const {
+        if (index >= 0 && index < static_cast<int>(m_subMeshMaterials.size())) {
+            return &m_subMeshMaterials[index];
+        }
+        return GetPBRMaterial();
+    }
+
+    void B_Mesh::SetSubMeshMaterials(const std::vector<Engine::IAL::PBRMaterial>& materials) {
+        m_subMeshMaterials = materials;
+    }
+
+    bool B_Mesh::SupportsInstancing() const {
+        return static_cast<bool>(m_mesh);
+    }
+
+    void B_Mesh::DrawInstanced(int instanceCount) {
+        if (m_mesh) {
+            m_mesh->DrawInstanced(instanceCount);
+        }
+    }
+
+    void B_Mesh::DrawSubMeshInstanced(int index, int instanceCount) {
+        if (m_mesh) {
+            m_mesh->DrawSubMeshInstanced(index, instanceCount);
+        }
+    }
+
+    bool B_Mesh::GetLocalBounds(Vector3& outMin, Vector3& outMax) const {
+        return m_mesh && m_mesh->GetBounds(outMin, outMax);
+    }
+
+    std::size_t B_Mesh::GetTriangleCount() const {
+        return m_mesh ? m_mesh->GetTriCount() : 0;
+    }
+
+    void B_Mesh::DrawDepth() {
+        if (m_mesh) {
+            m_mesh->DrawDepth();
+        }
+    }
+
+    void B_Mesh::DrawDepthInstanced(int instanceCount) {
+        if (m_mesh) {
+            m_mesh->DrawDepthInstanced(instanceCount);
+        }
+    }
+
+    std::size_t B_Mesh::GetVertexFetchBytes(bool depthStream) const {
+        if (!m_mesh) {
+            return 0;
+        }
+        const std::size_t stride = depthStream ? m_mesh->GetDepthVertexStride() : m_mesh->GetVertexStride();
+        return static_cast<std::size_t>(m_mesh->GetVertexCount()) * stride;
+    }
+
 
 }
\ No newline at end of file
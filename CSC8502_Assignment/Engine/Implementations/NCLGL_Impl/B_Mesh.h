@@ -23,6 +23,15 @@
  * 在完整实现中，它将调用底层的 m_mesh->Draw() 来执行实际的 OpenGL 绘制命令。
  * 在 Day 2 的空壳实现中，它不执行任何操作。
  *
+ * 子网格接口 GetSubMeshCount / DrawSubMesh / GetSubMeshMaterial:
+ * 转发到 nclgl::Mesh 的子网格绘制，并返回 SetSubMeshMaterials 设置的逐子网格材质；
+ * 同一个 B_Mesh 可被多个场景节点共享，从而复用同一组 GPU 缓冲。
+ *
+ * 实例化接口 SupportsInstancing / DrawInstanced / DrawSubMeshInstanced / GetLocalBounds:
+ * 转发到 nclgl::Mesh 的 glDrawElementsInstanced 系列调用，并提供模型空间包围盒用于 CPU 剔除。
+ * GetTriangleCount 返回 nclgl::Mesh::GetTriCount()，供渲染统计使用。
+ * DrawDepth / DrawDepthInstanced 转发到 nclgl::Mesh 的纯深度 VAO，GetVertexFetchBytes 给出两种顶点流的读取量。
+ *
  * 成员变量 m_mesh:
  * 类型为 std::shared_ptr<::Mesh>。
  * 这是被适配的实际渲染对象。
@@ -31,6 +40,7 @@
 #include "IAL/I_Mesh.h"
 
 #include <memory>
+#include <vector>
 
 class Mesh;
 
@@ -51,10 +61,25 @@ namespace NCLGL_Impl {
 
         const Engine::IAL::PBRMaterial* GetPBRMaterial() const override;
 
+        int GetSubMeshCount() const override;
+        void DrawSubMesh(int index) override;
+        const Engine::IAL::PBRMaterial* GetSubMeshMaterial(int index) const override;
+        void SetSubMeshMaterials(const std::vector<Engine::IAL::PBRMaterial>& materials);
+
+        bool SupportsInstancing() const override;
+        void DrawInstanced(int instanceCount) override;
+        void DrawSubMeshInstanced(int index, int instanceCount) override;
+        bool GetLocalBounds(Vector3& outMin, Vector3& outMax) const override;
+        std::size_t GetTriangleCount() const override;
+        void DrawDepth() override;
+        void DrawDepthInstanced(int instanceCount) override;
+        std::size_t GetVertexFetchBytes(bool depthStream) const override;
+
     private:
         std::shared_ptr<::Mesh> m_mesh;
         std::shared_ptr<Engine::IAL::I_Texture> m_defaultTexture;
         bool m_hasPBR = false;
         Engine::IAL::PBRMaterial m_pbrMaterial;
+        std::vector<Engine::IAL::PBRMaterial> m_subMeshMaterials;
     };
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+/**
+* @file B_ProceduralTerrain.h
+ * @brief 轨道 B (NCLGL_Impl) 的程序化高度图生成器。
+ *
+ * 按 Engine::IAL::ProceduralTerrainDesc 生成 dimension² 个高度采样（0..255），
+ * 由 B_Factory::CreateProceduralHeightmap 交给与图像高度图相同的网格构建流程。
+ *
+ * 噪声核:
+ * 二维梯度噪声，晶格哈希为纯整数运算（无置换表），梯度取 8 个方向之一，五次插值曲线。
+ * 各倍频程的坐标旋转约 37° 并平移，以打散晶格轴向的痕迹。x86/x64 下每 4 个采样一组走 SSE2，
+ * SSE2 没有 32 位整数乘法，哈希中的乘法由两次 _mm_mul_epu32 拼出。
+ * 标量与 SIMD 路径的浮点运算顺序一致，不使用近似指令，两者结果逐位相同。
+ *
+ * 分块与线程:
+ * 噪声按 64 × 64 的分块生成，工作线程通过原子计数领取分块；每个采样只取决于其坐标与参数，
+ * 归一化的最小/最大值按分块归约，热侵蚀使用双缓冲（每遍只读上一遍的结果），
+ * 因此输出与线程数和分块的执行顺序无关。
+ *
+ * 静态函数 Generate():
+ * threadCount 为 0 时使用全部硬件线程。dimension 小于 2 时返回空数组。
+ *
+ * 静态函数 Benchmark():
+ * 对 1k 到 8k 的网格在不同线程数下记录生成耗时与吞吐量，校验各线程数的结果一致，
+ * 并比较单线程标量与 SIMD 噪声核的耗时。
+ */
+#pragma once
+#include "IAL/I_Heightmap.h"
+#include <cstddef>
+#include <vector>
+
+namespace NCLGL_Impl {
+
+    class B_ProceduralTerrain {
+    public:
+        static std::vector<float> Generate(const Engine::IAL::ProceduralTerrainDesc& desc,
+                                           unsigned int threadCount = 0);
+
+        static void Benchmark();
+
+    private:
+        static std::vector<float> GenerateSamples(const Engine::IAL::ProceduralTerrainDesc& desc,
+                                                  unsigned int threadCount,
+                                                  bool useSimd);
+        static void GenerateRow(const Engine::IAL::ProceduralTerrainDesc& desc,
+                                std::size_t z,
+                                std::size_t x0,
+                                std::size_t count,
+                                float* out,
+                                bool useSimd);
+        static void Erode(const Engine::IAL::ProceduralTerrainDesc& desc,
+                          std::vector<float>& samples,
+                          unsigned int threadCount);
+    };
+
+}
\ No newline at end of file
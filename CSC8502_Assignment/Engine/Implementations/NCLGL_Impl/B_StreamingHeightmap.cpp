@@ -0,0 +1,591 @@
+/**
+* @file B_StreamingHeightmap.cpp
+ * @brief 轨道 B (NCLGL_Impl) 的分块流式高度图实现源文件。
+ *
+ * 包含 .hmt 分块缓存的烘焙/校验、基于内存映射的高度采样，
+ * 以及相机驱动的分块网格异步构建与显存预算管理。
+ */
+#include "B_StreamingHeightmap.h"
+#include "nclgl/Mesh.h"
+#include "nclgl/Vector4.h"
+#include "nclgl/Extra/MappedFile.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <nclgl/Extra/stb/stb_image.h>
+
+namespace NCLGL_Impl {
+
+    namespace {
+        constexpr std::uint32_t kCookedMagic = 0x544D4843; // 'CHMT'
+        constexpr std::uint32_t kCookedVersion = 1;
+        constexpr std::size_t kCookedTileSize = 256;
+        constexpr int kStreamingRadiusTiles = 6;
+        constexpr std::size_t kMaxPendingTiles = 4;
+        constexpr std::size_t kBytesPerVertex = sizeof(Vector3) * 2 + sizeof(Vector2) + sizeof(Vector4);
+        constexpr float kSampleToHeight = 1.0f / 257.0f;
+
+        struct CookedHeader {
+            std::uint32_t magic = kCookedMagic;
+            std::uint32_t version = kCookedVersion;
+            std::uint64_t sourceSize = 0;
+            std::int64_t sourceTime = 0;
+            std::uint32_t width = 0;
+            std::uint32_t height = 0;
+            std::uint32_t tileSize = 0;
+            std::uint32_t reserved = 0;
+        };
+
+        bool GetSourceStamp(const std::string& filename, std::uint64_t& size, std::int64_t& time) {
+            std::error_code error;
+            size = static_cast<std::uint64_t>(std::filesystem::file_size(filename, error));
+            if (error) {
+                return false;
+            }
+            auto writeTime = std::filesystem::last_write_time(filename, error);
+            if (error) {
+                return false;
+            }
+            time = static_cast<std::int64_t>(writeTime.time_since_epoch().count());
+            return true;
+        }
+
+        bool IsRawExtension(const std::string& path) {
+            std::string extension = std::filesystem::path(path).extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension == ".r16" || extension == ".raw";
+        }
+
+        // 无文件头的 RAW 约定把尺寸写在文件名末尾（如 terrain_16384x16384.r16），
+        // 缺省时按正方形推断。
+        bool GetRawDimensions(const std::string& path, std::size_t byteCount, std::size_t& width, std::size_t& height) {
+            const std::string stem = std::filesystem::path(path).stem().string();
+            const std::size_t underscore = stem.find_last_of('_');
+            unsigned int w = 0;
+            unsigned int h = 0;
+            if (underscore != std::string::npos &&
+                std::sscanf(stem.c_str() + underscore + 1, "%ux%u", &w, &h) == 2) {
+                width = w;
+                height = h;
+            }
+            else {
+                const std::size_t side = static_cast<std::size_t>(std::sqrt(static_cast<double>(byteCount / 2)));
+                width = side;
+                height = side;
+            }
+            return width >= 2 && height >= 2 && width * height * 2 <= byteCount;
+        }
+
+        std::size_t TileCount(std::size_t samples, std::size_t tileSize) {
+            return std::max<std::size_t>(1, (samples - 1 + tileSize - 1) / tileSize);
+        }
+
+        std::size_t ExpectedCookedSize(const CookedHeader& header) {
+            const std::size_t tileSamples = (header.tileSize + 1u) * (header.tileSize + 1u);
+            return sizeof(CookedHeader) + TileCount(header.width, header.tileSize) *
+                   TileCount(header.height, header.tileSize) * tileSamples * sizeof(std::uint16_t);
+        }
+
+        bool IsCookedValid(const std::string& sourcePath, const std::string& cookedPath) {
+            std::uint64_t sourceSize = 0;
+            std::int64_t sourceTime = 0;
+            if (!GetSourceStamp(sourcePath, sourceSize, sourceTime)) {
+                return false;
+            }
+            std::ifstream file(cookedPath, std::ios::binary);
+            CookedHeader header;
+            if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                return false;
+            }
+            std::error_code error;
+            const auto cookedSize = std::filesystem::file_size(cookedPath, error);
+            return !error &&
+                   header.magic == kCookedMagic &&
+                   header.version == kCookedVersion &&
+                   header.sourceSize == sourceSize &&
+                   header.sourceTime == sourceTime &&
+                   header.tileSize > 0 &&
+                   cookedSize == ExpectedCookedSize(header);
+        }
+
+        class TileMesh final : public ::Mesh {
+        public:
+            template <class Geometry>
+            explicit TileMesh(const Geometry& geometry) {
+                numVertices = static_cast<GLuint>(geometry.vertices.size());
+                numIndices = static_cast<GLuint>(geometry.indices.size());
+                type = GL_TRIANGLES;
+
+                vertices = new Vector3[numVertices];
+                normals = new Vector3[numVertices];
+                textureCoords = new Vector2[numVertices];
+                tangents = new Vector4[numVertices];
+                indices = new unsigned int[numIndices];
+                std::copy(geometry.vertices.begin(), geometry.vertices.end(), vertices);
+                std::copy(geometry.normals.begin(), geometry.normals.end(), normals);
+                std::copy(geometry.textureCoords.begin(), geometry.textureCoords.end(), textureCoords);
+                std::copy(geometry.tangents.begin(), geometry.tangents.end(), tangents);
+                std::copy(geometry.indices.begin(), geometry.indices.end(), indices);
+
+                BufferData();
+
+                // 上传后 CPU 端副本不再需要，立即释放，预算只计显存
+                delete[] vertices;
+                delete[] normals;
+                delete[] textureCoords;
+                delete[] tangents;
+                delete[] indices;
+                vertices = nullptr;
+                normals = nullptr;
+                textureCoords = nullptr;
+                tangents = nullptr;
+                indices = nullptr;
+            }
+        };
+    }
+
+    std::shared_ptr<B_StreamingHeightmap> B_StreamingHeightmap::Open(const std::string& path,
+                                                                     const Vector3& scale,
+                                                                     std::size_t memoryBudget) {
+        const std::string cookedPath = path + ".hmt";
+        if (!IsCookedValid(path, cookedPath) && !CookTiles(path, cookedPath, kCookedTileSize)) {
+            return nullptr;
+        }
+        auto file = std::make_unique<MappedFile>(cookedPath);
+        if (!file->Data() || file->Size() < sizeof(CookedHeader)) {
+            std::cerr << "[B_StreamingHeightmap] Failed to map " << cookedPath << "\n";
+            return nullptr;
+        }
+        CookedHeader header;
+        std::memcpy(&header, file->Data(), sizeof(header));
+        if (file->Size() != ExpectedCookedSize(header)) {
+            std::cerr << "[B_StreamingHeightmap] Cooked file is truncated: " << cookedPath << "\n";
+            return nullptr;
+        }
+        auto heightmap = std::make_shared<B_StreamingHeightmap>(std::move(file), header.width, header.height,
+                                                                header.tileSize, scale, memoryBudget);
+        std::cerr << "[B_StreamingHeightmap] Opened " << path << " (" << header.width << "x" << header.height
+                  << ", " << heightmap->m_tilesX << "x" << heightmap->m_tilesZ << " tiles of " << header.tileSize
+                  << ") budget=" << (memoryBudget >> 20) << "MB" << "\n";
+        return heightmap;
+    }
+
+    bool B_StreamingHeightmap::CookTiles(const std::string& sourcePath,
+                                         const std::string& cookedPath,
+                                         std::size_t tileSize) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        CookedHeader header;
+        if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceTime)) {
+            std::cerr << "[B_StreamingHeightmap] Missing heightmap source: " << sourcePath << "\n";
+            return false;
+        }
+
+        // RAW 直接映射，不占用额外内存；图像格式只能整体解码一次，之后都走缓存。
+        std::unique_ptr<MappedFile> rawFile;
+        stbi_us* decoded = nullptr;
+        const std::uint16_t* source = nullptr;
+        std::size_t width = 0;
+        std::size_t height = 0;
+        if (IsRawExtension(sourcePath)) {
+            rawFile = std::make_unique<MappedFile>(sourcePath);
+            if (!rawFile->Data() || !GetRawDimensions(sourcePath, rawFile->Size(), width, height)) {
+                std::cerr << "[B_StreamingHeightmap] Invalid 16-bit RAW heightmap: " << sourcePath << "\n";
+                return false;
+            }
+            source = reinterpret_cast<const std::uint16_t*>(rawFile->Data());
+        }
+        else {
+            int w = 0;
+            int h = 0;
+            int channels = 0;
+            decoded = stbi_load_16(sourcePath.c_str(), &w, &h, &channels, 1);
+            if (!decoded || w < 2 || h < 2) {
+                std::cerr << "[B_StreamingHeightmap] STB_Image Failed to open heightmap: " << sourcePath << "\n";
+                stbi_image_free(decoded);
+                return false;
+            }
+            width = static_cast<std::size_t>(w);
+            height = static_cast<std::size_t>(h);
+            source = decoded;
+        }
+
+        header.width = static_cast<std::uint32_t>(width);
+        header.height = static_cast<std::uint32_t>(height);
+        header.tileSize = static_cast<std::uint32_t>(tileSize);
+
+        std::ofstream file(cookedPath, std::ios::binary | std::ios::trunc);
+        bool written = static_cast<bool>(file);
+        if (written) {
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            const std::size_t tilesX = TileCount(width, tileSize);
+            const std::size_t tilesZ = TileCount(height, tileSize);
+            std::vector<std::uint16_t> row(tileSize + 1);
+            for (std::size_t tz = 0; tz < tilesZ && written; ++tz) {
+                for (std::size_t tx = 0; tx < tilesX && written; ++tx) {
+                    for (std::size_t lz = 0; lz <= tileSize; ++lz) {
+                        const std::size_t z = std::min(tz * tileSize + lz, height - 1);
+                        const std::uint16_t* sourceRow = source + z * width;
+                        for (std::size_t lx = 0; lx <= tileSize; ++lx) {
+                            row[lx] = sourceRow[std::min(tx * tileSize + lx, width - 1)];
+                        }
+                        file.write(reinterpret_cast<const char*>(row.data()),
+                                   static_cast<std::streamsize>(row.size() * sizeof(std::uint16_t)));
+                    }
+                    written = static_cast<bool>(file);
+                }
+            }
+        }
+        stbi_image_free(decoded);
+        file.close();
+
+        if (!written) {
+            std::cerr << "[B_StreamingHeightmap] Failed to write " << cookedPath << "\n";
+            std::error_code error;
+            std::filesystem::remove(cookedPath, error);
+            return false;
+        }
+
+        const auto endTime = std::chrono::high_resolution_clock::now();
+        std::cerr << "[B_StreamingHeightmap] Cooked " << sourcePath << " (" << width << "x" << height << ") in "
+                  << std::chrono::duration<float, std::milli>(endTime - startTime).count() << "ms" << "\n";
+        return true;
+    }
+
+    B_StreamingHeightmap::B_StreamingHeightmap(std::unique_ptr<MappedFile> file,
+                                               std::size_t width,
+                                               std::size_t height,
+                                               std::size_t tileSize,
+                                               const Vector3& scale,
+                                               std::size_t memoryBudget)
+        : m_file(std::move(file))
+        , m_tiles(reinterpret_cast<const std::uint16_t*>(m_file->Data() + sizeof(CookedHeader)))
+        , m_width(width)
+        , m_height(height)
+        , m_tileSize(tileSize)
+        , m_tilesX(static_cast<int>(TileCount(width, tileSize)))
+        , m_tilesZ(static_cast<int>(TileCount(height, tileSize)))
+        , m_scale(scale)
+        , m_memoryBudget(memoryBudget)
+        , m_residentBytes(0)
+        , m_hasMaterial(true) {
+        m_pbrMaterial.baseColorFactor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+        m_pbrMaterial.metallicFactor = 0.0f;
+        m_pbrMaterial.roughnessFactor = 1.0f;
+        m_pbrMaterial.alphaMode = Engine::IAL::AlphaMode::Opaque;
+        m_pbrMaterial.doubleSided = false;
+    }
+
+    B_StreamingHeightmap::~B_StreamingHeightmap() {
+        // 工作线程仍在读取映射内存，必须先等它们结束
+        for (auto& [key, pending] : m_pending) {
+            if (pending.geometry.valid()) {
+                pending.geometry.wait();
+            }
+        }
+    }
+
+    void B_StreamingHeightmap::Draw() {
+        for (auto& [key, tile] : m_resident) {
+            tile.mesh->Draw();
+        }
+    }
+
+    std::size_t B_StreamingHeightmap::GetTriangleCount() const {
+        std::size_t triangles = 0;
+        for (const auto& [key, tile] : m_resident) {
+            triangles += tile.mesh->GetTriCount();
+        }
+        return triangles;
+    }
+
+    void B_StreamingHeightmap::DrawDepth() {
+        for (auto& [key, tile] : m_resident) {
+            tile.mesh->DrawDepth();
+        }
+    }
+
+    std::size_t B_StreamingHeightmap::GetVertexFetchBytes(bool depthStream) const {
+        std::size_t bytes = 0;
+        for (const auto& [key, tile] : m_resident) {
+            const std::size_t stride = depthStream ? tile.mesh->GetDepthVertexStride() : tile.mesh->GetVertexStride();
+            bytes += static_cast<std::size_t>(tile.mesh->GetVertexCount()) * stride;
+        }
+        return bytes;
+    }
+
+    float B_StreamingHeightmap::RawSample(int x, int z) const {
+        x = std::clamp(x, 0, static_cast<int>(m_width) - 1);
+        z = std::clamp(z, 0, static_cast<int>(m_height) - 1);
+        const int tileSize = static_cast<int>(m_tileSize);
+        const int tileX = std::min(x / tileSize, m_tilesX - 1);
+        const int tileZ = std::min(z / tileSize, m_tilesZ - 1);
+        const std::size_t stride = m_tileSize + 1;
+        const std::size_t tileIndex = static_cast<std::size_t>(tileZ) * static_cast<std::size_t>(m_tilesX) +
+                                      static_cast<std::size_t>(tileX);
+        const std::size_t localX = static_cast<std::size_t>(x - tileX * tileSize);
+        const std::size_t localZ = static_cast<std::size_t>(z - tileZ * tileSize);
+        return static_cast<float>(m_tiles[tileIndex * stride * stride + localZ * stride + localX]) * kSampleToHeight;
+    }
+
+    float B_StreamingHeightmap::SampleHeight(float x, float z) const {
+        const float scaledX = std::clamp(x / m_scale.x, 0.0f, static_cast<float>(m_width - 1));
+        const float scaledZ = std::clamp(z / m_scale.z, 0.0f, static_cast<float>(m_height - 1));
+
+        const int x0 = static_cast<int>(std::floor(scaledX));
+        const int z0 = static_cast<int>(std::floor(scaledZ));
+        const float tx = scaledX - static_cast<float>(x0);
+        const float tz = scaledZ - static_cast<float>(z0);
+
+        const float hx0 = std::lerp(RawSample(x0, z0), RawSample(x0 + 1, z0), tx);
+        const float hx1 = std::lerp(RawSample(x0, z0 + 1), RawSample(x0 + 1, z0 + 1), tx);
+        return std::lerp(hx0, hx1, tz) * m_scale.y;
+    }
+
+    Vector3 B_StreamingHeightmap::GetWorldScale() const {
+        return m_scale;
+    }
+
+    Vector2 B_StreamingHeightmap::GetResolution() const {
+        return Vector2(static_cast<float>(m_width), static_cast<float>(m_height));
+    }
+
+    int B_StreamingHeightmap::StrideForRing(int ring) const {
+        if (ring <= 1) {
+            return 1;
+        }
+        if (ring == 2) {
+            return 2;
+        }
+        return ring <= 4 ? 4 : 8;
+    }
+
+    int B_StreamingHeightmap::TileKey(int tileX, int tileZ) const {
+        return tileZ * m_tilesX + tileX;
+    }
+
+    std::size_t B_StreamingHeightmap::EstimateTileBytes(int tileX, int tileZ, int stride) const {
+        const std::size_t cellsX = std::min(m_tileSize, m_width - 1 - static_cast<std::size_t>(tileX) * m_tileSize);
+        const std::size_t cellsZ = std::min(m_tileSize, m_height - 1 - static_cast<std::size_t>(tileZ) * m_tileSize);
+        const std::size_t countX = (cellsX + stride - 1) / stride + 1;
+        const std::size_t countZ = (cellsZ + stride - 1) / stride + 1;
+        const std::size_t vertexCount = countX * countZ + 2 * (countX + countZ);
+        const std::size_t indexCount = (countX - 1) * (countZ - 1) * 6 + 2 * ((countX - 1) + (countZ - 1)) * 6;
+        return vertexCount * kBytesPerVertex + indexCount * sizeof(unsigned int);
+    }
+
+    std::unique_ptr<B_StreamingHeightmap::TileGeometry> B_StreamingHeightmap::BuildTileGeometry(int tileX,
+                                                                                                int tileZ,
+                                                                                                int stride) const {
+        auto geometry = std::make_unique<TileGeometry>();
+        geometry->stride = stride;
+
+        const int originX = tileX * static_cast<int>(m_tileSize);
+        const int originZ = tileZ * static_cast<int>(m_tileSize);
+        const int cellsX = std::min(static_cast<int>(m_tileSize), static_cast<int>(m_width) - 1 - originX);
+        const int cellsZ = std::min(static_cast<int>(m_tileSize), static_cast<int>(m_height) - 1 - originZ);
+        const int countX = (cellsX + stride - 1) / stride + 1;
+        const int countZ = (cellsZ + stride - 1) / stride + 1;
+
+        const std::size_t gridVertices = static_cast<std::size_t>(countX) * static_cast<std::size_t>(countZ);
+        geometry->vertices.reserve(gridVertices + 2 * (countX + countZ));
+        geometry->normals.reserve(geometry->vertices.capacity());
+        geometry->textureCoords.reserve(geometry->vertices.capacity());
+        geometry->tangents.reserve(geometry->vertices.capacity());
+
+        const float invWidth = 1.0f / static_cast<float>(m_width - 1);
+        const float invHeight = 1.0f / static_cast<float>(m_height - 1);
+        float minHeight = std::numeric_limits<float>::max();
+
+        for (int j = 0; j < countZ; ++j) {
+            const int z = originZ + std::min(j * stride, cellsZ);
+            for (int i = 0; i < countX; ++i) {
+                const int x = originX + std::min(i * stride, cellsX);
+                const float height = RawSample(x, z) * m_scale.y;
+                minHeight = std::min(minHeight, height);
+
+                // 法线始终按原始分辨率的中心差分求得，抽稀后的远处分块光照不变
+                const float hL = RawSample(x - 1, z) * m_scale.y;
+                const float hR = RawSample(x + 1, z) * m_scale.y;
+                const float hD = RawSample(x, z - 1) * m_scale.y;
+                const float hU = RawSample(x, z + 1) * m_scale.y;
+                const Vector3 tangentX(2.0f * m_scale.x, hR - hL, 0.0f);
+                const Vector3 tangentZ(0.0f, hU - hD, 2.0f * m_scale.z);
+                Vector3 normal = Vector3::Cross(tangentZ, tangentX);
+                normal.Normalise();
+                Vector3 tangent = tangentX;
+                tangent.Normalise();
+
+                geometry->vertices.emplace_back(static_cast<float>(x) * m_scale.x, height, static_cast<float>(z) * m_scale.z);
+                geometry->normals.push_back(normal);
+                geometry->textureCoords.emplace_back(static_cast<float>(x) * invWidth, static_cast<float>(z) * invHeight);
+                geometry->tangents.emplace_back(tangent.x, tangent.y, tangent.z, 1.0f);
+            }
+        }
+
+        auto& indices = geometry->indices;
+        indices.reserve(static_cast<std::size_t>(countX - 1) * (countZ - 1) * 6 +
+                        2 * static_cast<std::size_t>((countX - 1) + (countZ - 1)) * 6);
+        for (int j = 0; j < countZ - 1; ++j) {
+            for (int i = 0; i < countX - 1; ++i) {
+                const unsigned int a = static_cast<unsigned int>(j * countX + i);
+                const unsigned int b = static_cast<unsigned int>(j * countX + i + 1);
+                const unsigned int c = static_cast<unsigned int>((j + 1) * countX + i + 1);
+                const unsigned int d = static_cast<unsigned int>((j + 1) * countX + i);
+                indices.insert(indices.end(), { a, b, c, a, c, d });
+            }
+        }
+
+        // 裙边：每条边的顶点复制一份并下沉到分块最低点以下，遮住与相邻 LOD 的 T 形裂缝。
+        // 每个裙边四边形只输出一次，绕序与地表三角形一致且朝向分块外侧：
+        // 地表三角形 (a, b, c) 的叉积朝 -y，裙边取叉积朝分块内侧的绕序，背面剔除时与地表同侧可见。
+        const float skirtHeight = minHeight - static_cast<float>(stride) * std::max(m_scale.x, m_scale.z);
+        auto addSkirt = [&](int startI, int startJ, int stepI, int stepJ, int count, bool flip) {
+            const unsigned int skirtStart = static_cast<unsigned int>(geometry->vertices.size());
+            for (int k = 0; k < count; ++k) {
+                const std::size_t source = static_cast<std::size_t>((startJ + k * stepJ) * countX + startI + k * stepI);
+                Vector3 vertex = geometry->vertices[source];
+                vertex.y = skirtHeight;
+                geometry->vertices.push_back(vertex);
+                geometry->normals.push_back(geometry->normals[source]);
+                geometry->textureCoords.push_back(geometry->textureCoords[source]);
+                geometry->tangents.push_back(geometry->tangents[source]);
+            }
+            for (int k = 0; k < count - 1; ++k) {
+                const unsigned int top0 = static_cast<unsigned int>((startJ + k * stepJ) * countX + startI + k * stepI);
+                const unsigned int top1 = static_cast<unsigned int>((startJ + (k + 1) * stepJ) * countX + startI + (k + 1) * stepI);
+                const unsigned int bottom0 = skirtStart + static_cast<unsigned int>(k);
+                const unsigned int bottom1 = bottom0 + 1;
+                if (flip) {
+                    indices.insert(indices.end(), { top0, bottom1, bottom0, top0, top1, bottom1 });
+                }
+                else {
+                    indices.insert(indices.end(), { top0, bottom0, bottom1, top0, bottom1, top1 });
+                }
+            }
+        };
+        // (top0, bottom0, bottom1) 的叉积为 (-stepZ, 0, stepX)：z = 0 与 x = max 两边本身朝内，另外两边需要翻转
+        addSkirt(0, 0, 1, 0, countX, false);
+        addSkirt(0, countZ - 1, 1, 0, countX, true);
+        addSkirt(0, 0, 0, 1, countZ, true);
+        addSkirt(countX - 1, 0, 0, 1, countZ, false);
+
+        return geometry;
+    }
+
+    void B_StreamingHeightmap::UpdateStreaming(const Vector3& cameraPosition) {
+        const float tileWorldX = static_cast<float>(m_tileSize) * m_scale.x;
+        const float tileWorldZ = static_cast<float>(m_tileSize) * m_scale.z;
+        const int cameraTileX = std::clamp(static_cast<int>(std::floor(cameraPosition.x / tileWorldX)), 0, m_tilesX - 1);
+        const int cameraTileZ = std::clamp(static_cast<int>(std::floor(cameraPosition.z / tileWorldZ)), 0, m_tilesZ - 1);
+
+        struct Candidate {
+            int key;
+            int tileX;
+            int tileZ;
+            int stride;
+            float distanceSq;
+        };
+        std::vector<Candidate> candidates;
+        for (int tz = std::max(0, cameraTileZ - kStreamingRadiusTiles);
+             tz <= std::min(m_tilesZ - 1, cameraTileZ + kStreamingRadiusTiles); ++tz) {
+            for (int tx = std::max(0, cameraTileX - kStreamingRadiusTiles);
+                 tx <= std::min(m_tilesX - 1, cameraTileX + kStreamingRadiusTiles); ++tx) {
+                const int ring = std::max(std::abs(tx - cameraTileX), std::abs(tz - cameraTileZ));
+                const float dx = (static_cast<float>(tx) + 0.5f) * tileWorldX - cameraPosition.x;
+                const float dz = (static_cast<float>(tz) + 0.5f) * tileWorldZ - cameraPosition.z;
+                candidates.push_back({ TileKey(tx, tz), tx, tz, StrideForRing(ring), dx * dx + dz * dz });
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.distanceSq < b.distanceSq; });
+
+        // 由近到远累加，超出预算的远处分块不再保留
+        std::unordered_map<int, int> wanted;
+        std::size_t plannedBytes = 0;
+        for (const Candidate& candidate : candidates) {
+            const std::size_t bytes = EstimateTileBytes(candidate.tileX, candidate.tileZ, candidate.stride);
+            if (plannedBytes + bytes > m_memoryBudget) {
+                break;
+            }
+            plannedBytes += bytes;
+            wanted.emplace(candidate.key, candidate.stride);
+        }
+
+        for (auto it = m_resident.begin(); it != m_resident.end();) {
+            if (wanted.find(it->first) == wanted.end()) {
+                m_residentBytes -= it->second.bytes;
+                it = m_resident.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if (it->second.geometry.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            std::unique_ptr<TileGeometry> geometry = it->second.geometry.get();
+            const auto target = wanted.find(it->first);
+            if (geometry && target != wanted.end() && target->second == geometry->stride) {
+                ResidentTile& tile = m_resident[it->first];
+                m_residentBytes -= tile.bytes;
+                tile.mesh = std::make_unique<TileMesh>(*geometry);
+                tile.stride = geometry->stride;
+                tile.bytes = geometry->vertices.size() * kBytesPerVertex + geometry->indices.size() * sizeof(unsigned int);
+                m_residentBytes += tile.bytes;
+            }
+            it = m_pending.erase(it);
+        }
+
+        for (const Candidate& candidate : candidates) {
+            if (m_pending.size() >= kMaxPendingTiles) {
+                break;
+            }
+            const auto target = wanted.find(candidate.key);
+            if (target == wanted.end()) {
+                break;
+            }
+            const auto resident = m_resident.find(candidate.key);
+            if ((resident != m_resident.end() && resident->second.stride == target->second) ||
+                m_pending.find(candidate.key) != m_pending.end()) {
+                continue;
+            }
+            PendingTile& pending = m_pending[candidate.key];
+            pending.stride = target->second;
+            pending.geometry = std::async(std::launch::async, [this, candidate, stride = target->second]() {
+                return BuildTileGeometry(candidate.tileX, candidate.tileZ, stride);
+            });
+        }
+    }
+
+    std::size_t B_StreamingHeightmap::GetResidentTileCount() const {
+        return m_resident.size();
+    }
+
+    std::size_t B_StreamingHeightmap::GetResidentBytes() const {
+        return m_residentBytes;
+    }
+
+    const Engine::IAL::PBRMaterial* B_StreamingHeightmap::GetPBRMaterial() const {
+        return m_hasMaterial ? &m_pbrMaterial : nullptr;
+    }
+
+    void B_StreamingHeightmap::SetPBRMaterial(const Engine::IAL::PBRMaterial& material) {
+        m_pbrMaterial = material;
+        m_hasMaterial = true;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+/**
+* @file B_StreamingHeightmap.h
+ * @brief 轨道 B (NCLGL_Impl) 的分块流式高度图实现。
+ *
+ * 16k × 16k 的 16 位高度图仅原始采样就有 512MB，整张网格更是数 GB，
+ * 无法像 B_Heightmap 那样一次性读入并建成单个 Mesh。本类把高度数据保留在磁盘上，
+ * 只为相机附近的分块建立网格，驻留量受显存预算约束。
+ *
+ * 烘焙格式 (.hmt):
+ * 首次打开时把源文件（16 位小端 .r16/.raw，或任意 stb_image 可读的 8/16 位图像）
+ * 转写为分块优先排列的缓存文件，放在源文件旁边。每个分块保存 (T+1)² 个 uint16 采样
+ * （与右侧/下侧相邻块共享一行/一列），因此任意分块的网格只需读取一段连续内存。
+ * 缓存以源文件大小与修改时间为键，与 MeshCache 的约定一致；之后的打开直接内存映射，
+ * 由操作系统按页调入，不再整体读取。
+ *
+ * 采样:
+ * SampleHeight 直接读取映射内存，高度值按 /257 换算到与 8 位高度图相同的 0..255 区间，
+ * 使 TerrainConfig 中的缩放对两种格式含义一致。分辨率可以不是正方形。
+ *
+ * 分块网格:
+ * UpdateStreaming 每帧按到相机的距离排序候选分块，按近到远累加估算显存直到预算用尽，
+ * 预算外的驻留块被卸载。远处分块以 2/4/8 倍步长抽稀，四边附加垂直裙边以遮挡相邻
+ * LOD 之间的裂缝。顶点生成在 std::async 工作线程上完成，主线程只负责上传，
+ * 并限制同时进行的任务数；新 LOD 就绪前旧网格继续绘制。
+ *
+ * 成员函数 GetResidentTileCount() / GetResidentBytes():
+ * 当前驻留的分块数与其占用的显存估算，供调试界面显示。
+ */
+#pragma once
+#include "IAL/I_Heightmap.h"
+#include "nclgl/Vector3.h"
+#include "nclgl/Vector4.h"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class MappedFile;
+
+namespace NCLGL_Impl {
+
+    class B_StreamingHeightmap : public virtual Engine::IAL::I_Heightmap {
+    public:
+        static constexpr std::size_t kDefaultMemoryBudget = 256u * 1024u * 1024u;
+
+        static std::shared_ptr<B_StreamingHeightmap> Open(const std::string& path,
+                                                          const Vector3& scale,
+                                                          std::size_t memoryBudget = kDefaultMemoryBudget);
+
+        B_StreamingHeightmap(std::unique_ptr<MappedFile> file,
+                             std::size_t width,
+                             std::size_t height,
+                             std::size_t tileSize,
+                             const Vector3& scale,
+                             std::size_t memoryBudget);
+        ~B_StreamingHeightmap() override;
+
+        void Draw() override;
+        std::size_t GetTriangleCount() const override;
+        void DrawDepth() override;
+        std::size_t GetVertexFetchBytes(bool depthStream) const override;
+
+        float SampleHeight(float x, float z) const override;
+        Vector3 GetWorldScale() const override;
+        Vector2 GetResolution() const override;
+        void UpdateStreaming(const Vector3& cameraPosition) override;
+        const Engine::IAL::PBRMaterial* GetPBRMaterial() const override;
+        void SetPBRMaterial(const Engine::IAL::PBRMaterial& material);
+
+        std::size_t GetResidentTileCount() const;
+        std::size_t GetResidentBytes() const;
+
+    private:
+        struct TileGeometry {
+            int stride = 1;
+            std::vector<Vector3> vertices;
+            std::vector<Vector3> normals;
+            std::vector<Vector2> textureCoords;
+            std::vector<Vector4> tangents;
+            std::vector<unsigned int> indices;
+        };
+
+        struct ResidentTile {
+            std::unique_ptr<::Mesh> mesh;
+            int stride = 1;
+            std::size_t bytes = 0;
+        };
+
+        struct PendingTile {
+            int stride = 1;
+            std::future<std::unique_ptr<TileGeometry>> geometry;
+        };
+
+        static bool CookTiles(const std::string& sourcePath, const std::string& cookedPath, std::size_t tileSize);
+
+        float RawSample(int x, int z) const;
+        std::unique_ptr<TileGeometry> BuildTileGeometry(int tileX, int tileZ, int stride) const;
+        std::size_t EstimateTileBytes(int tileX, int tileZ, int stride) const;
+        int StrideForRing(int ring) const;
+        int TileKey(int tileX, int tileZ) const;
+
+        std::unique_ptr<MappedFile> m_file;
+        const std::uint16_t* m_tiles;
+        std::size_t m_width;
+        std::size_t m_height;
+        std::size_t m_tileSize;
+        int m_tilesX;
+        int m_tilesZ;
+        Vector3 m_scale;
+        std::size_t m_memoryBudget;
+        std::size_t m_residentBytes;
+        bool m_hasMaterial;
+        Engine::IAL::PBRMaterial m_pbrMaterial;
+        std::unordered_map<int, ResidentTile> m_resident;
+        std::unordered_map<int, PendingTile> m_pending;
+    };
+
+}
\ No newline at end of file
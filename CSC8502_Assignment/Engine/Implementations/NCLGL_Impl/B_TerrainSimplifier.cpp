@@ -0,0 +1,314 @@
+/**
+* @file B_TerrainSimplifier.cpp
+ * @brief 轨道 B (NCLGL_Impl) 的地形自适应三角化实现源文件。
+ *
+ * 误差计算与三角形提取沿用 Martini 的 RTIN 编号方式：
+ * 三角形 id 的二进制位记录了从两个根三角形出发的左右细分路径。
+ */
+#include "B_TerrainSimplifier.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <nclgl/Extra/stb/stb_image.h>
+
+namespace NCLGL_Impl {
+
+    B_TerrainSimplifier::B_TerrainSimplifier(const std::vector<float>& samples,
+                                             std::size_t dimension,
+                                             float heightScale)
+        : m_samples(samples)
+        , m_dimension(dimension)
+        , m_heightScale(heightScale)
+        , m_tiles(std::max(1, static_cast<int>((dimension - 1 + kTileCells - 1) / kTileCells))) {
+        // 每个三角形只需保存斜边两端点，直角顶点由它们推出
+        const int triangleCount = kTileCells * kTileCells * 2 - 2;
+        m_coords.resize(static_cast<std::size_t>(triangleCount));
+        for (int i = 0; i < triangleCount; ++i) {
+            int id = i + 2;
+            int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+            if (id & 1) {
+                bx = by = cx = kTileCells;
+            }
+            else {
+                ax = ay = cy = kTileCells;
+            }
+            while ((id >>= 1) > 1) {
+                const int mx = (ax + bx) >> 1;
+                const int my = (ay + by) >> 1;
+                if (id & 1) {
+                    bx = ax;
+                    by = ay;
+                    ax = cx;
+                    ay = cy;
+                }
+                else {
+                    ax = bx;
+                    ay = by;
+                    bx = cx;
+                    by = cy;
+                }
+                cx = mx;
+                cy = my;
+            }
+            m_coords[static_cast<std::size_t>(i)] = { static_cast<unsigned short>(ax), static_cast<unsigned short>(ay),
+                                                      static_cast<unsigned short>(bx), static_cast<unsigned short>(by) };
+        }
+
+        m_errors.assign(static_cast<std::size_t>(m_tiles * m_tiles),
+                        std::vector<float>(static_cast<std::size_t>(kTileGrid * kTileGrid), 0.0f));
+
+        // 补齐的分块：真实边界线上的点必须保留，任何跨越边界线的三角形才会被细分掉
+        const int limit = static_cast<int>(dimension) - 1;
+        if (m_tiles * kTileCells > limit) {
+            for (int tileZ = 0; tileZ < m_tiles; ++tileZ) {
+                for (int tileX = 0; tileX < m_tiles; ++tileX) {
+                    std::vector<float>& errors = m_errors[static_cast<std::size_t>(tileZ * m_tiles + tileX)];
+                    for (int z = 0; z < kTileGrid; ++z) {
+                        for (int x = 0; x < kTileGrid; ++x) {
+                            const int globalX = tileX * kTileCells + x;
+                            const int globalZ = tileZ * kTileCells + z;
+                            if ((globalX == limit && globalZ <= limit) || (globalZ == limit && globalX <= limit)) {
+                                errors[static_cast<std::size_t>(z * kTileGrid + x)] = std::numeric_limits<float>::infinity();
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<int> tiles(static_cast<std::size_t>(m_tiles * m_tiles));
+        std::iota(tiles.begin(), tiles.end(), 0);
+        auto propagateAll = [&](bool measureTriangles) {
+            std::for_each(std::execution::par, tiles.begin(), tiles.end(), [&](int tile) {
+                PropagateErrors(tile % m_tiles, tile / m_tiles, measureTriangles);
+            });
+        };
+        propagateAll(true);
+        UnifyBorderErrors();
+        propagateAll(false);
+    }
+
+    float B_TerrainSimplifier::Height(int x, int z) const {
+        const int limit = static_cast<int>(m_dimension) - 1;
+        x = std::min(x, limit);
+        z = std::min(z, limit);
+        return m_samples[static_cast<std::size_t>(z) * m_dimension + static_cast<std::size_t>(x)] * m_heightScale;
+    }
+
+    float B_TerrainSimplifier::TriangleError(const int xs[3], const int zs[3]) const {
+        const int area = (xs[1] - xs[0]) * (zs[2] - zs[0]) - (xs[2] - xs[0]) * (zs[1] - zs[0]);
+        if (area == 0) {
+            return 0.0f;
+        }
+        const float h0 = Height(xs[0], zs[0]);
+        const float h1 = Height(xs[1], zs[1]);
+        const float h2 = Height(xs[2], zs[2]);
+        float worst = 0.0f;
+        for (int z = std::min({ zs[0], zs[1], zs[2] }); z <= std::max({ zs[0], zs[1], zs[2] }); ++z) {
+            for (int x = std::min({ xs[0], xs[1], xs[2] }); x <= std::max({ xs[0], xs[1], xs[2] }); ++x) {
+                const int w0 = (xs[1] - x) * (zs[2] - z) - (xs[2] - x) * (zs[1] - z);
+                const int w1 = (xs[2] - x) * (zs[0] - z) - (xs[0] - x) * (zs[2] - z);
+                const int w2 = area - w0 - w1;
+                if ((area > 0 && (w0 < 0 || w1 < 0 || w2 < 0)) || (area < 0 && (w0 > 0 || w1 > 0 || w2 > 0))) {
+                    continue;
+                }
+                const float interpolated = (w0 * h0 + w1 * h1 + w2 * h2) / static_cast<float>(area);
+                worst = std::max(worst, std::abs(interpolated - Height(x, z)));
+            }
+        }
+        return worst;
+    }
+
+    void B_TerrainSimplifier::PropagateErrors(int tileX, int tileZ, bool measureTriangles) {
+        std::vector<float>& errors = m_errors[static_cast<std::size_t>(tileZ * m_tiles + tileX)];
+        const int originX = tileX * kTileCells;
+        const int originZ = tileZ * kTileCells;
+        const int triangleCount = static_cast<int>(m_coords.size());
+        const int parentCount = triangleCount - kTileCells * kTileCells;
+
+        // 由细到粗：每个斜边中点的误差取三角形内所有网格点的真实偏差与两个子三角形中点误差的最大值。
+        // Martini 原版只计算斜边中点一处的插值误差，三角形内部的偏差可能超过容差数倍；
+        // 这里逐点计算，保留下来的三角形误差严格不超过容差。
+        // 边界统一后的第二遍只需重新传播，三角形自身误差已在第一遍写入
+        for (int i = triangleCount - 1; i >= 0; --i) {
+            const TriangleCoords& t = m_coords[static_cast<std::size_t>(i)];
+            const int mx = (t.ax + t.bx) >> 1;
+            const int my = (t.ay + t.by) >> 1;
+            const int cx = mx + my - t.ay;
+            const int cy = my + t.ax - mx;
+
+            float& middle = errors[static_cast<std::size_t>(my * kTileGrid + mx)];
+            if (measureTriangles) {
+                const int xs[3] = { originX + t.ax, originX + t.bx, originX + cx };
+                const int zs[3] = { originZ + t.ay, originZ + t.by, originZ + cy };
+                middle = std::max(middle, TriangleError(xs, zs));
+            }
+
+            if (i < parentCount) {
+                const float left = errors[static_cast<std::size_t>(((t.ay + cy) >> 1) * kTileGrid + ((t.ax + cx) >> 1))];
+                const float right = errors[static_cast<std::size_t>(((t.by + cy) >> 1) * kTileGrid + ((t.bx + cx) >> 1))];
+                middle = std::max({ middle, left, right });
+            }
+        }
+    }
+
+    void B_TerrainSimplifier::UnifyBorderErrors() {
+        auto tileErrors = [&](int tileX, int tileZ) -> std::vector<float>& {
+            return m_errors[static_cast<std::size_t>(tileZ * m_tiles + tileX)];
+        };
+        for (int tileZ = 0; tileZ < m_tiles; ++tileZ) {
+            for (int tileX = 0; tileX < m_tiles; ++tileX) {
+                std::vector<float>& errors = tileErrors(tileX, tileZ);
+                if (tileX + 1 < m_tiles) {
+                    std::vector<float>& right = tileErrors(tileX + 1, tileZ);
+                    for (int z = 0; z < kTileGrid; ++z) {
+                        float& a = errors[static_cast<std::size_t>(z * kTileGrid + kTileCells)];
+                        float& b = right[static_cast<std::size_t>(z * kTileGrid)];
+                        a = b = std::max(a, b);
+                    }
+                }
+                if (tileZ + 1 < m_tiles) {
+                    std::vector<float>& below = tileErrors(tileX, tileZ + 1);
+                    for (int x = 0; x < kTileGrid; ++x) {
+                        float& a = errors[static_cast<std::size_t>(kTileCells * kTileGrid + x)];
+                        float& b = below[static_cast<std::size_t>(x)];
+                        a = b = std::max(a, b);
+                    }
+                }
+            }
+        }
+    }
+
+    void B_TerrainSimplifier::ExtractTile(int tileX, int tileZ, float maxError, Triangulation& out) const {
+        const std::vector<float>& errors = m_errors[static_cast<std::size_t>(tileZ * m_tiles + tileX)];
+        const int originX = tileX * kTileCells;
+        const int originZ = tileZ * kTileCells;
+        const int limit = static_cast<int>(m_dimension) - 1;
+        std::vector<int> vertexLookup(static_cast<std::size_t>(kTileGrid * kTileGrid), -1);
+
+        auto vertex = [&](int x, int z) {
+            int& index = vertexLookup[static_cast<std::size_t>(z * kTileGrid + x)];
+            if (index < 0) {
+                index = static_cast<int>(out.gridVertices.size());
+                out.gridVertices.push_back(static_cast<unsigned int>(
+                    static_cast<std::size_t>(originZ + z) * m_dimension + static_cast<std::size_t>(originX + x)));
+            }
+            return static_cast<unsigned int>(index);
+        };
+
+        auto process = [&](auto& self, int ax, int ay, int bx, int by, int cx, int cy) -> void {
+            const int mx = (ax + bx) >> 1;
+            const int my = (ay + by) >> 1;
+            if (std::abs(ax - cx) + std::abs(ay - cy) > 1 && errors[static_cast<std::size_t>(my * kTileGrid + mx)] > maxError) {
+                self(self, cx, cy, ax, ay, mx, my);
+                self(self, bx, by, cx, cy, mx, my);
+                return;
+            }
+            if (originX + std::max({ ax, bx, cx }) > limit || originZ + std::max({ ay, by, cy }) > limit) {
+                return;
+            }
+            // RTIN 的顶点顺序与规则网格相反，交换后两者绕序一致
+            out.indices.push_back(vertex(ax, ay));
+            out.indices.push_back(vertex(cx, cy));
+            out.indices.push_back(vertex(bx, by));
+        };
+        process(process, 0, 0, kTileCells, kTileCells, kTileCells, 0);
+        process(process, kTileCells, kTileCells, 0, 0, 0, kTileCells);
+    }
+
+    B_TerrainSimplifier::Triangulation B_TerrainSimplifier::Extract(float maxError) const {
+        std::vector<Triangulation> tileResults(static_cast<std::size_t>(m_tiles * m_tiles));
+        std::vector<int> tiles(tileResults.size());
+        std::iota(tiles.begin(), tiles.end(), 0);
+        std::for_each(std::execution::par, tiles.begin(), tiles.end(), [&](int tile) {
+            ExtractTile(tile % m_tiles, tile / m_tiles, maxError, tileResults[static_cast<std::size_t>(tile)]);
+        });
+
+        Triangulation result;
+        std::size_t vertexCount = 0;
+        std::size_t indexCount = 0;
+        for (const Triangulation& tile : tileResults) {
+            vertexCount += tile.gridVertices.size();
+            indexCount += tile.indices.size();
+        }
+        result.gridVertices.reserve(vertexCount);
+        result.indices.reserve(indexCount);
+        for (const Triangulation& tile : tileResults) {
+            const unsigned int base = static_cast<unsigned int>(result.gridVertices.size());
+            result.gridVertices.insert(result.gridVertices.end(), tile.gridVertices.begin(), tile.gridVertices.end());
+            for (unsigned int index : tile.indices) {
+                result.indices.push_back(base + index);
+            }
+        }
+        return result;
+    }
+
+    float B_TerrainSimplifier::MeasureMaxError(const Triangulation& triangulation) const {
+        std::vector<std::size_t> triangles(triangulation.indices.size() / 3);
+        std::iota(triangles.begin(), triangles.end(), std::size_t{ 0 });
+        return std::transform_reduce(std::execution::par, triangles.begin(), triangles.end(), 0.0f,
+            [](float a, float b) { return std::max(a, b); },
+            [&](std::size_t triangle) {
+                int xs[3];
+                int zs[3];
+                for (int k = 0; k < 3; ++k) {
+                    const unsigned int grid = triangulation.gridVertices[triangulation.indices[triangle * 3 + k]];
+                    xs[k] = static_cast<int>(grid % m_dimension);
+                    zs[k] = static_cast<int>(grid / m_dimension);
+                }
+                return TriangleError(xs, zs);
+            });
+    }
+
+    void B_TerrainSimplifier::Benchmark(const std::string& heightmapPath, float heightScale) {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        std::vector<float> samples;
+        if (stbi_is_16_bit(heightmapPath.c_str())) {
+            if (stbi_us* data = stbi_load_16(heightmapPath.c_str(), &width, &height, &channels, 1)) {
+                samples.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+                for (std::size_t i = 0; i < samples.size(); ++i) {
+                    samples[i] = static_cast<float>(data[i]) / 257.0f;
+                }
+                stbi_image_free(data);
+            }
+        }
+        else if (stbi_uc* data = stbi_load(heightmapPath.c_str(), &width, &height, &channels, 1)) {
+            samples.assign(data, data + static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+            stbi_image_free(data);
+        }
+        if (samples.empty() || width != height || width < 2) {
+            std::cerr << "[B_TerrainSimplifier] Benchmark could not load " << heightmapPath << "\n";
+            return;
+        }
+
+        const std::size_t dimension = static_cast<std::size_t>(width);
+        const std::size_t fullTriangles = (dimension - 1) * (dimension - 1) * 2;
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        B_TerrainSimplifier simplifier(samples, dimension, heightScale);
+        auto endTime = std::chrono::high_resolution_clock::now();
+        std::cerr << "[B_TerrainSimplifier] " << heightmapPath << " (" << dimension << "x" << dimension
+                  << ", height scale " << heightScale << "): error pass "
+                  << std::chrono::duration<float, std::milli>(endTime - startTime).count()
+                  << "ms, full grid " << fullTriangles << " triangles" << "\n";
+
+        for (float tolerance : { 0.05f, 0.1f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f }) {
+            startTime = std::chrono::high_resolution_clock::now();
+            const Triangulation triangulation = simplifier.Extract(tolerance);
+            endTime = std::chrono::high_resolution_clock::now();
+            const std::size_t triangles = triangulation.indices.size() / 3;
+            std::cerr << "[B_TerrainSimplifier]   tolerance " << tolerance << ": " << triangles << " triangles ("
+                      << 100.0f * static_cast<float>(triangles) / static_cast<float>(fullTriangles) << "%), "
+                      << triangulation.gridVertices.size() << " vertices, max error "
+                      << simplifier.MeasureMaxError(triangulation) << ", extract "
+                      << std::chrono::duration<float, std::milli>(endTime - startTime).count() << "ms" << "\n";
+        }
+    }
+
+}
\ No newline at end of file
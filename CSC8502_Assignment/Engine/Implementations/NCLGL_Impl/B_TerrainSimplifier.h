@@ -0,0 +1,74 @@
+/**
+* @file B_TerrainSimplifier.h
+ * @brief 轨道 B (NCLGL_Impl) 的地形自适应三角化（RTIN）。
+ *
+ * 规则网格在平坦谷地与水下区域与山脊处使用相同的三角形密度。本类在加载时
+ * 按直角三角形不规则网络（RTIN，Martini 算法）对高度图做自适应三角化：
+ * 每个网格点记录“该点被省略时的最大垂直误差”，提取时只细分误差超过容差的三角形。
+ *
+ * 分块:
+ * RTIN 要求 (2^k + 1)² 的网格，因此高度图被切分为 256 × 256 单元的分块，
+ * 误差计算与三角形提取均按分块并行执行。尺寸不足的最后一行/列分块按边缘 clamp 补齐，
+ * 真实边界线上的点强制保留，补齐区域的三角形在提取时丢弃。
+ *
+ * 无裂缝:
+ * 相邻分块共享边界上的点。第一遍各自计算误差后，边界点取两侧误差的较大值，
+ * 再各自执行一遍自底向上的误差传播，两侧对边界点的取舍因此完全一致，不会出现 T 形裂缝。
+ *
+ * 成员函数 Extract():
+ * 以世界单位的垂直容差提取三角形，返回使用到的网格点（z * dimension + x）与索引，
+ * 绕序与 B_Factory 中的规则网格一致。
+ *
+ * 成员函数 MeasureMaxError():
+ * 逐网格点与三角形插值结果比较，返回实际最大垂直误差，用于校验容差。
+ *
+ * 静态函数 Benchmark():
+ * 对给定高度图在多个容差下记录三角形数、实际最大误差与耗时。
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace NCLGL_Impl {
+
+    class B_TerrainSimplifier {
+    public:
+        struct Triangulation {
+            std::vector<unsigned int> gridVertices;
+            std::vector<unsigned int> indices;
+        };
+
+        B_TerrainSimplifier(const std::vector<float>& samples, std::size_t dimension, float heightScale);
+
+        Triangulation Extract(float maxError) const;
+        float MeasureMaxError(const Triangulation& triangulation) const;
+
+        static void Benchmark(const std::string& heightmapPath, float heightScale);
+
+    private:
+        static constexpr int kTileCells = 256;
+        static constexpr int kTileGrid = kTileCells + 1;
+
+        struct TriangleCoords {
+            unsigned short ax;
+            unsigned short ay;
+            unsigned short bx;
+            unsigned short by;
+        };
+
+        float Height(int x, int z) const;
+        float TriangleError(const int xs[3], const int zs[3]) const;
+        void PropagateErrors(int tileX, int tileZ, bool measureTriangles);
+        void UnifyBorderErrors();
+        void ExtractTile(int tileX, int tileZ, float maxError, Triangulation& out) const;
+
+        const std::vector<float>& m_samples;
+        std::size_t m_dimension;
+        float m_heightScale;
+        int m_tiles;
+        std::vector<TriangleCoords> m_coords;
+        std::vector<std::vector<float>> m_errors;
+    };
+
+}
\ No newline at end of file
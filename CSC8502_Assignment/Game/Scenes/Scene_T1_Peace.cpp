@@ -4,6 +4,7 @@
  */
 #include "Scene_T1_Peace.h"
 
+#include "../../Core/TerrainConfig.h"
 #include "../../Engine/IAL/I_Heightmap.h"
 #include "../../Engine/IAL/I_Texture.h"
 #include "../../Engine/IAL/I_AnimatedMesh.h"
@@ -31,7 +32,7 @@ void Scene_T1_Peace::Init() {
     }
     m_environment.pointLights.clear();
 
-    m_heightmap = m_factory->LoadHeightmap("../Heightmaps/terrain.png", Vector3(2.0f, 0.4f, 2.0f));
+    m_heightmap = m_factory->LoadHeightmap("../Heightmaps/terrain.png", Vector3(2.0f, 0.4f, 2.0f), kTerrainMaxError);
     if (!m_heightmap) {
         return;
     }
@@ -76,6 +77,10 @@ void Scene_T1_Peace::Init() {
             m_buildingNode->SetMesh(buildingMesh);
             m_buildingNode->SetScale(Vector3(55.0f, 80.0f, 55.0f));
             m_buildingNode->SetPosition(Vector3(512.0f, 15.0f, 512.0f));
+            // 遮挡盒取墙体实心部分的内缩盒：左右墙墩与拱门上方的横梁，拱门洞口不遮挡
+            m_buildingNode->AddOccluderBox(Vector3(0.02f, 0.0f, -0.38f), Vector3(1.85f, 4.45f, 0.38f));
+            m_buildingNode->AddOccluderBox(Vector3(3.98f, 0.0f, -0.38f), Vector3(4.98f, 4.45f, 0.38f));
+            m_buildingNode->AddOccluderBox(Vector3(0.02f, 3.55f, -0.38f), Vector3(4.98f, 4.45f, 0.38f));
             if (root) {
                 root->AddChild(m_buildingNode);
             }
@@ -4,6 +4,7 @@
  */
 #include "Scene_T2_War.h"
 
+#include "../../Core/TerrainConfig.h"
 #include "../../Engine/IAL/I_Heightmap.h"
 #include "../../Engine/IAL/I_Texture.h"
 #include "../../Engine/IAL/I_AnimatedMesh.h"
@@ -31,7 +32,7 @@ void Scene_T2_War::Init() {
     }
     m_environment.pointLights.clear();
 
-    m_heightmap = m_factory->LoadHeightmap("../Heightmaps/terrain.png", Vector3(2.0f, 0.4f, 2.0f));
+    m_heightmap = m_factory->LoadHeightmap("../Heightmaps/terrain.png", Vector3(2.0f, 0.4f, 2.0f), kTerrainMaxError);
     if (!m_heightmap) {
         return;
     }
@@ -65,6 +66,9 @@ void Scene_T2_War::Init() {
         m_ruinsNode->SetMesh(ruinsMesh);
         m_ruinsNode->SetScale(Vector3(50.0f, 50.0f, 50.0f));
         m_ruinsNode->SetPosition(Vector3(512.0f, 15.0f, 512.0f));
+        // 废墟只剩右侧墙墩与左侧矮墙基可作为遮挡体
+        m_ruinsNode->AddOccluderBox(Vector3(3.95f, 0.0f, -0.38f), Vector3(4.98f, 4.45f, 0.38f));
+        m_ruinsNode->AddOccluderBox(Vector3(0.02f, 0.0f, -0.38f), Vector3(1.85f, 0.95f, 0.38f));
         if (root) {
             root->AddChild(m_ruinsNode);
         }
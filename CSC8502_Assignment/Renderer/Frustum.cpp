@@ -0,0 +1,102 @@
+﻿/**
+ * @file Frustum.cpp
+ * @brief 实现视锥体平面提取与包围体相交测试。
+ */
+#include "Frustum.h"
+
+#include <cmath>
+
+namespace {
+    Vector4 MatrixRow(const Matrix4& m, int row) {
+        return Vector4(m.values[row], m.values[4 + row], m.values[8 + row], m.values[12 + row]);
+    }
+
+    Vector4 NormalisePlane(const Vector4& plane) {
+        const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length <= 0.0f) {
+            return plane;
+        }
+        const float inv = 1.0f / length;
+        return Vector4(plane.x * inv, plane.y * inv, plane.z * inv, plane.w * inv);
+    }
+
+    Vector4 AddRows(const Vector4& a, const Vector4& b, float sign) {
+        return Vector4(a.x + b.x * sign, a.y + b.y * sign, a.z + b.z * sign, a.w + b.w * sign);
+    }
+}
+
+Frustum::Frustum() {
+    for (auto& plane : m_planes) {
+        plane = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum Frustum::FromViewProjection(const Matrix4& viewProj) {
+    Frustum frustum;
+    const Vector4 row0 = MatrixRow(viewProj, 0);
+    const Vector4 row1 = MatrixRow(viewProj, 1);
+    const Vector4 row2 = MatrixRow(viewProj, 2);
+    const Vector4 row3 = MatrixRow(viewProj, 3);
+    frustum.m_planes[0] = NormalisePlane(AddRows(row3, row0, 1.0f));
+    frustum.m_planes[1] = NormalisePlane(AddRows(row3, row0, -1.0f));
+    frustum.m_planes[2] = NormalisePlane(AddRows(row3, row1, 1.0f));
+    frustum.m_planes[3] = NormalisePlane(AddRows(row3, row1, -1.0f));
+    frustum.m_planes[4] = NormalisePlane(AddRows(row3, row2, 1.0f));
+    frustum.m_planes[5] = NormalisePlane(AddRows(row3, row2, -1.0f));
+    return frustum;
+}
+
+bool Frustum::IntersectsAABB(const Vector3& worldMin, const Vector3& worldMax) const {
+    for (const auto& plane : m_planes) {
+        if (!IntersectsHalfSpace(plane, worldMin, worldMax)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::IntersectsHalfSpace(const Vector4& plane, const Vector3& worldMin, const Vector3& worldMax) {
+    // 取包围盒在平面法线方向上最远的角点，若它仍在平面外侧则整个盒子不可见。
+    const float x = plane.x >= 0.0f ? worldMax.x : worldMin.x;
+    const float y = plane.y >= 0.0f ? worldMax.y : worldMin.y;
+    const float z = plane.z >= 0.0f ? worldMax.z : worldMin.z;
+    return plane.x * x + plane.y * y + plane.z * z + plane.w >= 0.0f;
+}
+
+void Frustum::SetNearPlane(const Vector4& plane) {
+    m_planes[4] = NormalisePlane(plane);
+}
+
+bool Frustum::IntersectsBox(const Matrix4& model, const Vector3& localMin, const Vector3& localMax) const {
+    Vector3 worldMin;
+    Vector3 worldMax;
+    TransformAABB(model, localMin, localMax, worldMin, worldMax);
+    return IntersectsAABB(worldMin, worldMax);
+}
+
+bool Frustum::IntersectsSphere(const Vector3& centre, float radius) const {
+    for (const auto& plane : m_planes) {
+        if (plane.x * centre.x + plane.y * centre.y + plane.z * centre.z + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Frustum::TransformAABB(const Matrix4& model,
+                            const Vector3& localMin,
+                            const Vector3& localMax,
+                            Vector3& outMin,
+                            Vector3& outMax) {
+    const Vector3 centre = (localMin + localMax) * 0.5f;
+    const Vector3 extent = (localMax - localMin) * 0.5f;
+    const float* m = model.values;
+    const Vector3 worldCentre(m[0] * centre.x + m[4] * centre.y + m[8] * centre.z + m[12],
+                              m[1] * centre.x + m[5] * centre.y + m[9] * centre.z + m[13],
+                              m[2] * centre.x + m[6] * centre.y + m[10] * centre.z + m[14]);
+    const Vector3 worldExtent(std::fabs(m[0]) * extent.x + std::fabs(m[4]) * extent.y + std::fabs(m[8]) * extent.z,
+                              std::fabs(m[1]) * extent.x + std::fabs(m[5]) * extent.y + std::fabs(m[9]) * extent.z,
+                              std::fabs(m[2]) * extent.x + std::fabs(m[6]) * extent.y + std::fabs(m[10]) * extent.z);
+    outMin = worldCentre - worldExtent;
+    outMax = worldCentre + worldExtent;
+}
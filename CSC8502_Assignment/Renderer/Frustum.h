@@ -0,0 +1,40 @@
+﻿/**
+ * @file Frustum.h
+ * @brief 声明从视图投影矩阵提取六个裁剪平面的视锥体辅助类。
+ * @details
+ * Frustum 按 Gribb/Hartmann 方法从 viewProj 的行向量组合出左右上下近远六个平面，
+ * 平面法线指向视锥体内部。Renderer 用它在 CPU 端逐实例剔除包围盒，
+ * 包围盒由网格的局部 AABB 与模型矩阵变换得到（中心 + 绝对值矩阵扩展），无需变换 8 个角点。
+ * 水面通道用 SetNearPlane 把近平面替换为水面裁剪平面：侧面四个平面都经过相机，
+ * 原近平面之外的剔除由它们完成，替换后整个包围盒位于水面错误一侧的节点即被剔除。
+ */
+#pragma once
+
+#include <array>
+
+#include "nclgl/Matrix4.h"
+#include "nclgl/Vector3.h"
+#include "nclgl/Vector4.h"
+
+class Frustum {
+public:
+    Frustum();
+
+    static Frustum FromViewProjection(const Matrix4& viewProj);
+
+    bool IntersectsAABB(const Vector3& worldMin, const Vector3& worldMax) const;
+    bool IntersectsBox(const Matrix4& model, const Vector3& localMin, const Vector3& localMax) const;
+    bool IntersectsSphere(const Vector3& centre, float radius) const;
+    void SetNearPlane(const Vector4& plane);
+
+    static bool IntersectsHalfSpace(const Vector4& plane, const Vector3& worldMin, const Vector3& worldMax);
+
+    static void TransformAABB(const Matrix4& model,
+                              const Vector3& localMin,
+                              const Vector3& localMax,
+                              Vector3& outMin,
+                              Vector3& outMax);
+
+private:
+    std::array<Vector4, 6> m_planes;
+};
@@ -4,42 +4,150 @@
  */
 
 #include "GrassField.h"
+#include "Frustum.h"
 
 #include "../Engine/IAL/I_ResourceFactory.h"
 #include "../Engine/IAL/I_Heightmap.h"
 #include "../Engine/IAL/I_Shader.h"
 
 #include <glad/glad.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include <random>
+#include <span>
 #include <vector>
+#include "nclgl/Vector2.h"
 #include "nclgl/Vector4.h"
 
 namespace {
-    constexpr int kGrassInstanceCount = 80000;
+    constexpr float kGrassTileSize = 48.0f;
+    constexpr int kGrassRingRadius = 8;
+    constexpr int kGrassRingWidth = kGrassRingRadius * 2 + 1;
+    constexpr int kGrassSlotCount = kGrassRingWidth * kGrassRingWidth;
+    constexpr int kGrassBladesPerTile = 3072;
+    // 同时在工作线程上生成的草块上限，以及 CPU 缓存保留的草块数量。
+    constexpr int kGrassMaxPendingTiles = 8;
+    constexpr std::size_t kGrassCachedTiles = 96;
+    // 草叶最大高度（含摆动），用于扩展块包围盒。
+    constexpr float kGrassBladeReach = 2.8f;
+    // 该距离内保持全密度，之后按 (kGrassFullDensityDistance / d)^2 稀疏。
+    constexpr float kGrassFullDensityDistance = 60.0f;
+    constexpr float kGrassMinDensity = 0.04f;
+
+    struct GrassSample {
+        Vector3 position;
+        float seed;
+        float threshold;
+    };
+
+    std::int64_t TileKey(int tileX, int tileZ) {
+        return (static_cast<std::int64_t>(tileZ) << 32) | static_cast<std::uint32_t>(tileX);
+    }
+
+    int TileKeyX(std::int64_t key) {
+        return static_cast<int>(static_cast<std::uint32_t>(key & 0xffffffff));
+    }
+
+    int TileKeyZ(std::int64_t key) {
+        return static_cast<int>(key >> 32);
+    }
+
+    std::uint16_t Quantize(float value, float origin, float extent) {
+        const float t = extent > 0.0f ? std::clamp((value - origin) / extent, 0.0f, 1.0f) : 0.0f;
+        return static_cast<std::uint16_t>(std::lround(t * 65535.0f));
+    }
+
+    float DistanceToBox(const Vector3& point, const Vector3& boxMin, const Vector3& boxMax) {
+        const float dx = std::max({ boxMin.x - point.x, 0.0f, point.x - boxMax.x });
+        const float dy = std::max({ boxMin.y - point.y, 0.0f, point.y - boxMax.y });
+        const float dz = std::max({ boxMin.z - point.z, 0.0f, point.z - boxMax.z });
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
 }
 
 GrassField::GrassField(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factory,
                        const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap,
                        float waterHeight) :
     m_shader(nullptr)
+    , m_heightmap(heightmap)
+    , m_waterHeight(waterHeight)
     , m_vao(0)
     , m_vbo(0)
+    , m_tileBuffer(0)
     , m_instanceCount(0)
+    , m_tilesX(0)
+    , m_tilesZ(0)
+    , m_centerX(0)
+    , m_centerZ(0)
+    , m_hasCenter(false)
     , m_color(Vector3(0.35f, 0.65f, 0.35f))
     , m_defaultBaseColorTexture(nullptr)
     , m_baseColorTexture(nullptr)
     , m_alphaShapeTexture(nullptr)
-    , m_fallbackAlpha(0.75f) {
+    , m_fallbackAlpha(0.75f)
+    , m_bladesSubmitted(0) {
     if (factory) {
         m_shader = factory->CreateShader("Shared/grass.vert", "Shared/grass.frag", "Shared/grass.geom");
         m_baseColorTexture = factory->LoadTexture("../Textures/grass/grass.png", false);
         m_defaultBaseColorTexture = m_baseColorTexture;
         m_alphaShapeTexture = factory->LoadTexture("../Textures/grass/grassAlpha.png", false);
     }
-    GenerateInstances(heightmap, waterHeight);
+    if (!m_heightmap) {
+        return;
+    }
+
+    Vector2 resolution = m_heightmap->GetResolution();
+    Vector3 scale = m_heightmap->GetWorldScale();
+    const float maxX = (resolution.x > 1.0f) ? (resolution.x - 1.0f) * scale.x : 0.0f;
+    const float maxZ = (resolution.y > 1.0f) ? (resolution.y - 1.0f) * scale.z : 0.0f;
+    m_tilesX = static_cast<int>(std::ceil(maxX / kGrassTileSize));
+    m_tilesZ = static_cast<int>(std::ceil(maxZ / kGrassTileSize));
+
+    // 槽位在构造时一次性分配，之后只做 glBufferSubData；草块数据稍后由 Update 流式填充。
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glGenBuffers(1, &m_tileBuffer);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(kGrassSlotCount) * kGrassBladesPerTile * sizeof(GrassInstance),
+                 nullptr,
+                 GL_DYNAMIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(GrassInstance), reinterpret_cast<void*>(0));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_tileBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 static_cast<GLsizeiptr>(kGrassSlotCount) * 2 * sizeof(Vector4),
+                 nullptr,
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    m_freeSlots.reserve(kGrassSlotCount);
+    for (int slot = kGrassSlotCount - 1; slot >= 0; --slot) {
+        m_freeSlots.push_back(slot);
+    }
+    m_residentTiles.reserve(kGrassSlotCount);
+    m_drawFirsts.reserve(kGrassSlotCount);
+    m_drawCounts.reserve(kGrassSlotCount);
 }
 
 GrassField::~GrassField() {
+    // 等待仍在工作线程上的草块，避免其在 GrassField 销毁后继续访问高度图。
+    for (auto& pending : m_pendingTiles) {
+        if (pending.second.valid()) {
+            pending.second.wait();
+        }
+    }
+    if (m_tileBuffer != 0) {
+        glDeleteBuffers(1, &m_tileBuffer);
+        m_tileBuffer = 0;
+    }
     if (m_vbo != 0) {
         glDeleteBuffers(1, &m_vbo);
         m_vbo = 0;
@@ -63,55 +171,215 @@ void GrassField::SetBaseColorTexture(const std::shared_ptr<Engine::IAL::I_Textur
     }
 }
 
-void GrassField::GenerateInstances(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap,
-                                   float waterHeight) {
-    if (!heightmap) {
-        return;
-    }
-
-    Vector2 resolution = heightmap->GetResolution();
-    Vector3 scale = heightmap->GetWorldScale();
+std::shared_ptr<const GrassField::TileData> GrassField::GenerateTile(
+    const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap,
+    float waterHeight,
+    int tileX,
+    int tileZ) {
+    auto data = std::make_shared<TileData>();
+    const float originX = static_cast<float>(tileX) * kGrassTileSize;
+    const float originZ = static_cast<float>(tileZ) * kGrassTileSize;
+    // 最后一行/列的块在地形边界处截断，不在 [0, maxX] × [0, maxZ] 之外撒草
+    const Vector2 resolution = heightmap->GetResolution();
+    const Vector3 scale = heightmap->GetWorldScale();
     const float maxX = (resolution.x > 1.0f) ? (resolution.x - 1.0f) * scale.x : 0.0f;
     const float maxZ = (resolution.y > 1.0f) ? (resolution.y - 1.0f) * scale.z : 0.0f;
+    const float endX = std::min(originX + kGrassTileSize, maxX);
+    const float endZ = std::min(originZ + kGrassTileSize, maxZ);
+    if (endX <= originX || endZ <= originZ) {
+        return data;
+    }
 
-    std::mt19937 rng(1337u);
-    std::uniform_real_distribution<float> distX(0.0f, maxX);
-    std::uniform_real_distribution<float> distZ(0.0f, maxZ);
+    // 种子只取决于块坐标，同一块无论何时、在哪个线程生成，结果都相同。
+    std::mt19937 rng(1337u + static_cast<unsigned int>(tileZ) * 73856093u + static_cast<unsigned int>(tileX) * 19349663u);
+    std::uniform_real_distribution<float> distX(originX, endX);
+    std::uniform_real_distribution<float> distZ(originZ, endZ);
     std::uniform_real_distribution<float> distRandom(0.0f, 1.0f);
 
-    std::vector<Vector4> instances;
-    instances.reserve(kGrassInstanceCount);
+    std::vector<GrassSample> samples;
+    samples.reserve(kGrassBladesPerTile);
+    // 候选点按批生成并一次性查询高度，避免逐点虚调用。
+    constexpr int kCandidateBatch = 256;
+    std::array<float, kCandidateBatch> candidateX{};
+    std::array<float, kCandidateBatch> candidateZ{};
+    std::array<float, kCandidateBatch> candidateHeight{};
+    const int maxAttempts = kGrassBladesPerTile * 4;
+    for (int attempt = 0; attempt < maxAttempts && static_cast<int>(samples.size()) < kGrassBladesPerTile;) {
+        const int batch = std::min(kCandidateBatch, maxAttempts - attempt);
+        for (int i = 0; i < batch; ++i) {
+            candidateX[i] = distX(rng);
+            candidateZ[i] = distZ(rng);
+        }
+        heightmap->SampleHeights(std::span<const float>(candidateX.data(), batch),
+                                 std::span<const float>(candidateZ.data(), batch),
+                                 std::span<float>(candidateHeight.data(), batch));
+        for (int i = 0; i < batch && static_cast<int>(samples.size()) < kGrassBladesPerTile; ++i) {
+            if (candidateHeight[i] < waterHeight + 0.5f) {
+                continue;
+            }
+            const float seed = distRandom(rng);
+            samples.push_back({ Vector3(candidateX[i], candidateHeight[i], candidateZ[i]), seed, distRandom(rng) });
+        }
+        attempt += batch;
+    }
+    if (samples.empty()) {
+        return data;
+    }
+    // 阈值升序排列后，任意前缀都是该块的一个均匀子集。
+    std::sort(samples.begin(), samples.end(), [](const GrassSample& a, const GrassSample& b) {
+        return a.threshold < b.threshold;
+    });
+
+    float minHeight = std::numeric_limits<float>::max();
+    float maxHeight = std::numeric_limits<float>::lowest();
+    for (const auto& sample : samples) {
+        minHeight = std::min(minHeight, sample.position.y);
+        maxHeight = std::max(maxHeight, sample.position.y);
+    }
+    data->quantOrigin = Vector3(originX, minHeight, originZ);
+    data->quantExtent = Vector3(endX - originX, maxHeight - minHeight, endZ - originZ);
+    data->boundsMin = Vector3(originX - kGrassBladeReach, minHeight, originZ - kGrassBladeReach);
+    data->boundsMax = Vector3(endX + kGrassBladeReach,
+                              maxHeight + kGrassBladeReach,
+                              endZ + kGrassBladeReach);
 
-    const int maxAttempts = kGrassInstanceCount * 4;
-    for (int attempt = 0; attempt < maxAttempts && static_cast<int>(instances.size()) < kGrassInstanceCount; ++
-         attempt) {
-        const float x = distX(rng);
-        const float z = distZ(rng);
-        const float height = heightmap->SampleHeight(x, z);
-        if (height < waterHeight + 0.5f) {
+    data->instances.reserve(samples.size());
+    for (const auto& sample : samples) {
+        const Vector3& p = sample.position;
+        data->instances.push_back({ Quantize(p.x, data->quantOrigin.x, data->quantExtent.x),
+                                    Quantize(p.y, data->quantOrigin.y, data->quantExtent.y),
+                                    Quantize(p.z, data->quantOrigin.z, data->quantExtent.z),
+                                    Quantize(sample.seed, 0.0f, 1.0f) });
+    }
+    return data;
+}
+
+bool GrassField::IsInRing(int tileX, int tileZ) const {
+    return m_hasCenter &&
+           std::abs(tileX - m_centerX) <= kGrassRingRadius &&
+           std::abs(tileZ - m_centerZ) <= kGrassRingRadius;
+}
+
+void GrassField::CacheTile(std::int64_t key, const std::shared_ptr<const TileData>& data) {
+    if (m_tileCache.emplace(key, data).second) {
+        m_tileCacheOrder.push_back(key);
+    }
+    while (m_tileCacheOrder.size() > kGrassCachedTiles) {
+        m_tileCache.erase(m_tileCacheOrder.front());
+        m_tileCacheOrder.pop_front();
+    }
+}
+
+void GrassField::UploadTile(std::int64_t key, const TileData& data) {
+    if (m_freeSlots.empty() || m_residentTiles.count(key) != 0) {
+        return;
+    }
+    Tile tile;
+    tile.slot = m_freeSlots.back();
+    tile.count = static_cast<int>(data.instances.size());
+    tile.boundsMin = data.boundsMin;
+    tile.boundsMax = data.boundsMax;
+    m_freeSlots.pop_back();
+
+    if (tile.count > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(tile.slot) * kGrassBladesPerTile * sizeof(GrassInstance),
+                        static_cast<GLsizeiptr>(tile.count) * sizeof(GrassInstance),
+                        data.instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        const Vector4 quant[2] = {
+            Vector4(data.quantOrigin.x, data.quantOrigin.y, data.quantOrigin.z, 0.0f),
+            Vector4(data.quantExtent.x, data.quantExtent.y, data.quantExtent.z, 0.0f)
+        };
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_tileBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                        static_cast<GLintptr>(tile.slot) * sizeof(quant),
+                        sizeof(quant),
+                        quant);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    m_residentTiles.emplace(key, tile);
+    m_instanceCount += tile.count;
+}
+
+void GrassField::CollectFinishedTiles() {
+    for (auto it = m_pendingTiles.begin(); it != m_pendingTiles.end();) {
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+        const std::int64_t key = it->first;
+        auto data = it->second.get();
+        it = m_pendingTiles.erase(it);
+        if (!data) {
             continue;
         }
-        Vector4 instance(x, height, z, distRandom(rng));
-        instances.push_back(instance);
+        CacheTile(key, data);
+        if (IsInRing(TileKeyX(key), TileKeyZ(key))) {
+            UploadTile(key, *data);
+        }
     }
+}
 
-    if (instances.empty()) {
+void GrassField::Update(const Vector3& cameraPosition) {
+    if (!m_heightmap || m_vao == 0) {
         return;
     }
+    CollectFinishedTiles();
 
-    if (m_vbo == 0) {
-        glGenVertexArrays(1, &m_vao);
-        glGenBuffers(1, &m_vbo);
+    const int centerX = static_cast<int>(std::floor(cameraPosition.x / kGrassTileSize));
+    const int centerZ = static_cast<int>(std::floor(cameraPosition.z / kGrassTileSize));
+    if (!m_hasCenter || centerX != m_centerX || centerZ != m_centerZ) {
+        m_centerX = centerX;
+        m_centerZ = centerZ;
+        m_hasCenter = true;
+        // 离开环带的块归还槽位；仍在生成中的块在完成后只进入缓存。
+        for (auto it = m_residentTiles.begin(); it != m_residentTiles.end();) {
+            if (IsInRing(TileKeyX(it->first), TileKeyZ(it->first))) {
+                ++it;
+                continue;
+            }
+            m_freeSlots.push_back(it->second.slot);
+            m_instanceCount -= it->second.count;
+            it = m_residentTiles.erase(it);
+        }
     }
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Vector4), instances.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vector4), reinterpret_cast<void*>(0));
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    m_instanceCount = static_cast<int>(instances.size());
+    // 由近及远补齐环带内缺失的块：命中缓存直接上传，否则提交到工作线程。
+    for (int ring = 0; ring <= kGrassRingRadius; ++ring) {
+        for (int dz = -ring; dz <= ring; ++dz) {
+            for (int dx = -ring; dx <= ring; ++dx) {
+                if (std::max(std::abs(dx), std::abs(dz)) != ring) {
+                    continue;
+                }
+                const int tileX = m_centerX + dx;
+                const int tileZ = m_centerZ + dz;
+                if (tileX < 0 || tileZ < 0 || tileX >= m_tilesX || tileZ >= m_tilesZ) {
+                    continue;
+                }
+                const std::int64_t key = TileKey(tileX, tileZ);
+                if (m_residentTiles.count(key) != 0 || m_pendingTiles.count(key) != 0) {
+                    continue;
+                }
+                auto cached = m_tileCache.find(key);
+                if (cached != m_tileCache.end()) {
+                    UploadTile(key, *cached->second);
+                    continue;
+                }
+                if (static_cast<int>(m_pendingTiles.size()) >= kGrassMaxPendingTiles) {
+                    continue;
+                }
+                m_pendingTiles.emplace(key, std::async(std::launch::async,
+                                                       &GrassField::GenerateTile,
+                                                       m_heightmap,
+                                                       m_waterHeight,
+                                                       tileX,
+                                                       tileZ));
+            }
+        }
+    }
 }
 
 void GrassField::Render(const Matrix4& view,
@@ -121,11 +389,39 @@ void GrassField::Render(const Matrix4& view,
                         int debugMode,
                         float nearPlane,
                         float farPlane) {
-    if (!m_shader || m_instanceCount <= 0 || m_vao == 0) {
+    if (!m_shader || m_residentTiles.empty() || m_vao == 0) {
         return;
     }
 
     Matrix4 viewProj = projection * view;
+    const Frustum frustum = Frustum::FromViewProjection(viewProj);
+    m_drawFirsts.clear();
+    m_drawCounts.clear();
+    int blades = 0;
+    for (const auto& entry : m_residentTiles) {
+        const Tile& tile = entry.second;
+        if (tile.count <= 0 || !frustum.IntersectsAABB(tile.boundsMin, tile.boundsMax)) {
+            continue;
+        }
+        const float distance = DistanceToBox(cameraPosition, tile.boundsMin, tile.boundsMax);
+        float density = 1.0f;
+        if (distance > kGrassFullDensityDistance) {
+            const float ratio = kGrassFullDensityDistance / distance;
+            density = std::max(ratio * ratio, kGrassMinDensity);
+        }
+        const int count = std::min(tile.count, static_cast<int>(std::ceil(static_cast<float>(tile.count) * density)));
+        if (count <= 0) {
+            continue;
+        }
+        m_drawFirsts.push_back(tile.slot * kGrassBladesPerTile);
+        m_drawCounts.push_back(count);
+        blades += count;
+    }
+    if (m_drawFirsts.empty()) {
+        return;
+    }
+    m_bladesSubmitted += blades;
+
     m_shader->Bind();
     m_shader->SetUniform("uViewProj", viewProj);
     m_shader->SetUniform("uCameraPos", cameraPosition);
@@ -134,6 +430,8 @@ void GrassField::Render(const Matrix4& view,
     m_shader->SetUniform("uDebugMode", debugMode);
     m_shader->SetUniform("uNearPlane", nearPlane);
     m_shader->SetUniform("uFarPlane", farPlane);
+    m_shader->SetUniform("uSlotCapacity", kGrassBladesPerTile);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_tileBuffer);
     
     const bool hasBaseTexture = static_cast<bool>(m_baseColorTexture);
     const bool hasAlphaTexture = static_cast<bool>(m_alphaShapeTexture);
@@ -179,8 +477,12 @@ void GrassField::Render(const Matrix4& view,
     // 在绘制草叶前关闭传统混合并启用 GL_SAMPLE_ALPHA_TO_COVERAGE，完成后恢复状态。
 
     glBindVertexArray(m_vao);
-    glDrawArrays(GL_POINTS, 0, m_instanceCount);
+    glMultiDrawArrays(GL_POINTS,
+                      m_drawFirsts.data(),
+                      m_drawCounts.data(),
+                      static_cast<GLsizei>(m_drawFirsts.size()));
     glBindVertexArray(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
 
     if (prevCull) {
         glEnable(GL_CULL_FACE);
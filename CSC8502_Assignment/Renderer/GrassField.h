@@ -6,9 +6,33 @@
  * 将每个点扩展成草叶。Renderer 在水体与主场景之间调用 Render，以与
  * 反射/折射结果共享相同的视图投影矩阵。类内部缓存 VAO/VBO 与草地着色器，
  * 允许在不同帧重复渲染而无需重新生成实例数据。
+ *
+ * 流式分块：草地不再一次性铺满整张地形，而是以相机为中心维护
+ * (2 × kGrassRingRadius + 1)² 个固定尺寸的草块。每块的实例由 (tileX, tileZ)
+ * 决定的随机种子生成，因此同一块无论何时生成结果都一致。Update 每帧按相机位置
+ * 回收离开环带的块、在工作线程上（std::async）生成新进入的块，
+ * 生成完成后再由主线程写入 VBO 中空闲的槽位。最近生成的块保存在一个有界的
+ * CPU 缓存中，相机来回移动时无需重新采样高度图。
+ *
+ * 每个槽位容纳 kGrassBladesPerTile 株草，VBO 与槽位表在构造时一次性分配，
+ * 因此显存占用与相机位置、地形尺寸无关。
+ *
+ * 分块与 LOD：块内实例按生成时随机抽取的“密度阈值”升序排列，
+ * 因此按距离保留前 N 个实例即可稀疏远处草地，且同一株草在相机移动时不会闪烁。
+ * Render 先用视锥剔除整块，再以一次 glMultiDrawArrays 提交所有可见块的前缀区间。
+ *
+ * 实例以 4 × uint16 归一化格式存储（位置相对所在块的包围盒量化，加一个随机种子），
+ * 每株 8 字节。各槽位的量化原点与范围存放在 binding = 2 的 SSBO 中，
+ * 顶点着色器通过 gl_VertexID / 槽位容量找到所属块。GetBladesSubmitted 返回自上次
+ * ResetFrameStats 以来实际提交的草叶数量。
  */
 #pragma once
+#include <cstdint>
+#include <deque>
+#include <future>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "nclgl/Matrix4.h"
 #include "nclgl/Vector3.h"
 
@@ -26,6 +50,8 @@ public:
                float waterHeight);
     ~GrassField();
 
+    void Update(const Vector3& cameraPosition);
+
     void Render(const Matrix4& view,
                     const Matrix4& projection,
                     const Vector3& cameraPosition,
@@ -37,17 +63,67 @@ public:
     void SetColor(const Vector3& color);
     void SetBaseColorTexture(const std::shared_ptr<Engine::IAL::I_Texture>& texture);
 
+    float GetWaterHeight() const { return m_waterHeight; }
+    const std::shared_ptr<Engine::IAL::I_Heightmap>& GetHeightmap() const { return m_heightmap; }
+    void ResetFrameStats() { m_bladesSubmitted = 0; }
+    int GetBladesSubmitted() const { return m_bladesSubmitted; }
+    int GetInstanceCount() const { return m_instanceCount; }
+
 private:
-    void GenerateInstances(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap,
-                           float waterHeight);
+    struct GrassInstance {
+        std::uint16_t x;
+        std::uint16_t y;
+        std::uint16_t z;
+        std::uint16_t seed;
+    };
+
+    struct TileData {
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+        Vector3 quantOrigin;
+        Vector3 quantExtent;
+        std::vector<GrassInstance> instances;
+    };
+
+    struct Tile {
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+        int slot = -1;
+        int count = 0;
+    };
+
+    static std::shared_ptr<const TileData> GenerateTile(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap,
+                                                        float waterHeight,
+                                                        int tileX,
+                                                        int tileZ);
+    void CollectFinishedTiles();
+    void UploadTile(std::int64_t key, const TileData& data);
+    void CacheTile(std::int64_t key, const std::shared_ptr<const TileData>& data);
+    bool IsInRing(int tileX, int tileZ) const;
 
     std::shared_ptr<Engine::IAL::I_Shader> m_shader;
+    std::shared_ptr<Engine::IAL::I_Heightmap> m_heightmap;
+    float m_waterHeight;
     unsigned int m_vao;
     unsigned int m_vbo;
+    unsigned int m_tileBuffer;
     int m_instanceCount;
+    int m_tilesX;
+    int m_tilesZ;
+    int m_centerX;
+    int m_centerZ;
+    bool m_hasCenter;
+    std::unordered_map<std::int64_t, Tile> m_residentTiles;
+    std::unordered_map<std::int64_t, std::future<std::shared_ptr<const TileData>>> m_pendingTiles;
+    std::unordered_map<std::int64_t, std::shared_ptr<const TileData>> m_tileCache;
+    std::deque<std::int64_t> m_tileCacheOrder;
+    std::vector<int> m_freeSlots;
+    std::vector<int> m_drawFirsts;
+    std::vector<int> m_drawCounts;
     Vector3 m_color;
     std::shared_ptr<Engine::IAL::I_Texture> m_defaultBaseColorTexture;
     std::shared_ptr<Engine::IAL::I_Texture> m_baseColorTexture;
     std::shared_ptr<Engine::IAL::I_Texture> m_alphaShapeTexture;
     float m_fallbackAlpha;
+    int m_bladesSubmitted;
 };
\ No newline at end of file
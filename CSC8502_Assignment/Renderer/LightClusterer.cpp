@@ -0,0 +1,321 @@
+﻿/**
+ * @file LightClusterer.cpp
+ * @brief 实现分簇前向着色的视图空间簇划分与点光源分配。
+ */
+#include "LightClusterer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define LIGHT_CLUSTERER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr int kTilesPerSlice = LightClusterer::kClustersX * LightClusterer::kClustersY;
+
+    static_assert(LightClusterer::kClustersX % 4 == 0, "cluster rows must be a multiple of the SIMD width");
+    static_assert(LightClusterer::kClustersZ >= 2, "the first slice is special-cased, at least two slices are needed");
+
+    int ClusterIndex(int x, int y, int slice) {
+        return (slice * LightClusterer::kClustersY + y) * LightClusterer::kClustersX + x;
+    }
+}
+
+LightClusterer::LightClusterer() :
+    m_ambientSum(0.0f, 0.0f, 0.0f)
+    , m_lightsVersion(0)
+    , m_builtVersion(~std::uint64_t(0))
+    , m_builtView()
+    , m_projectionScaleX(0.0f)
+    , m_projectionScaleY(0.0f)
+    , m_nearPlane(0.0f)
+    , m_farPlane(0.0f)
+    , m_firstSliceDepth(kFirstSliceDepth)
+    , m_sliceScale(0.0f)
+    , m_boundsMinX(kClusterCount, 0.0f)
+    , m_boundsMaxX(kClusterCount, 0.0f)
+    , m_boundsMinY(kClusterCount, 0.0f)
+    , m_boundsMaxY(kClusterCount, 0.0f)
+    , m_sliceNear(kClustersZ, 0.0f)
+    , m_sliceFar(kClustersZ, 0.0f)
+    , m_clusterLists(kClusterCount)
+    , m_clusterRanges(static_cast<std::size_t>(kClusterCount) * 2, 0u)
+    , m_maxLightsPerCluster(0)
+    , m_occupiedClusters(0)
+    , m_buildMs(0.0f) {
+    m_builtView.ToIdentity();
+}
+
+float LightClusterer::ComputeInfluenceRadius(const Light& light) {
+    // 平方反比衰减：|color| / d² 降到 kRadianceCutoff 时的距离
+    const float intensity = std::max({ light.color.x, light.color.y, light.color.z, 0.0f });
+    return std::sqrt(intensity / kRadianceCutoff);
+}
+
+void LightClusterer::SetLights(const std::vector<Light>& lights) {
+    m_gpuLights.clear();
+    m_gpuLights.reserve(lights.size());
+    m_ambientSum = Vector3(0.0f, 0.0f, 0.0f);
+    for (const Light& light : lights) {
+        m_ambientSum = m_ambientSum + light.ambient;
+        const float radius = ComputeInfluenceRadius(light);
+        if (radius <= 0.0f) {
+            continue;
+        }
+        GpuLight gpuLight{};
+        gpuLight.positionRadius[0] = light.position.x;
+        gpuLight.positionRadius[1] = light.position.y;
+        gpuLight.positionRadius[2] = light.position.z;
+        gpuLight.positionRadius[3] = radius;
+        gpuLight.color[0] = light.color.x;
+        gpuLight.color[1] = light.color.y;
+        gpuLight.color[2] = light.color.z;
+        m_gpuLights.push_back(gpuLight);
+    }
+    ++m_lightsVersion;
+}
+
+Vector4 LightClusterer::GetShaderParameters() const {
+    return Vector4(m_projectionScaleX, m_projectionScaleY, m_firstSliceDepth, m_sliceScale);
+}
+
+bool LightClusterer::Build(const Matrix4& view, float projectionScaleX, float projectionScaleY, float nearPlane, float farPlane) {
+    const bool boundsChanged = projectionScaleX != m_projectionScaleX || projectionScaleY != m_projectionScaleY ||
+                               nearPlane != m_nearPlane || farPlane != m_farPlane;
+    if (!boundsChanged && m_builtVersion == m_lightsVersion &&
+        std::memcmp(view.values, m_builtView.values, sizeof(view.values)) == 0) {
+        return false;
+    }
+    const auto start = std::chrono::high_resolution_clock::now();
+    if (boundsChanged) {
+        UpdateClusterBounds(projectionScaleX, projectionScaleY, nearPlane, farPlane);
+    }
+
+    m_viewLights.resize(m_gpuLights.size());
+    for (std::size_t i = 0; i < m_gpuLights.size(); ++i) {
+        const GpuLight& light = m_gpuLights[i];
+        const Vector3 centre = view * Vector3(light.positionRadius[0], light.positionRadius[1], light.positionRadius[2]);
+        m_viewLights[i] = ViewLight{ centre.x, centre.y, -centre.z, light.positionRadius[3] };
+    }
+    AssignSlices(true, true);
+    GatherLists();
+
+    m_builtView = view;
+    m_builtVersion = m_lightsVersion;
+    m_buildMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return true;
+}
+
+void LightClusterer::UpdateClusterBounds(float projectionScaleX, float projectionScaleY, float nearPlane, float farPlane) {
+    m_projectionScaleX = projectionScaleX;
+    m_projectionScaleY = projectionScaleY;
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+    // 远平面过近时把第一个切片收窄，保证指数切片的比例为正
+    m_firstSliceDepth = std::clamp(kFirstSliceDepth, nearPlane, farPlane * 0.5f);
+    m_sliceScale = static_cast<float>(kClustersZ - 1) / std::log(farPlane / m_firstSliceDepth);
+
+    m_sliceNear[0] = nearPlane;
+    m_sliceFar[0] = m_firstSliceDepth;
+    for (int slice = 1; slice < kClustersZ; ++slice) {
+        m_sliceNear[slice] = m_sliceFar[slice - 1];
+        m_sliceFar[slice] = slice + 1 == kClustersZ
+            ? farPlane
+            : m_firstSliceDepth * std::exp(static_cast<float>(slice) / m_sliceScale);
+    }
+
+    // NDC 坐标 n 在视图深度 d 处对应 n * d / 投影缩放，包围盒取切片两端深度的极值
+    for (int slice = 0; slice < kClustersZ; ++slice) {
+        const float sliceNear = m_sliceNear[slice];
+        const float sliceFar = m_sliceFar[slice];
+        for (int y = 0; y < kClustersY; ++y) {
+            const float y0 = -1.0f + 2.0f * static_cast<float>(y) / kClustersY;
+            const float y1 = -1.0f + 2.0f * static_cast<float>(y + 1) / kClustersY;
+            for (int x = 0; x < kClustersX; ++x) {
+                const float x0 = -1.0f + 2.0f * static_cast<float>(x) / kClustersX;
+                const float x1 = -1.0f + 2.0f * static_cast<float>(x + 1) / kClustersX;
+                const int index = ClusterIndex(x, y, slice);
+                m_boundsMinX[index] = std::min(x0 * sliceNear, x0 * sliceFar) / projectionScaleX;
+                m_boundsMaxX[index] = std::max(x1 * sliceNear, x1 * sliceFar) / projectionScaleX;
+                m_boundsMinY[index] = std::min(y0 * sliceNear, y0 * sliceFar) / projectionScaleY;
+                m_boundsMaxY[index] = std::max(y1 * sliceNear, y1 * sliceFar) / projectionScaleY;
+            }
+        }
+    }
+}
+
+void LightClusterer::AssignSlices(bool parallel, bool useSimd) {
+    if (parallel) {
+        std::vector<int> slices(kClustersZ);
+        std::iota(slices.begin(), slices.end(), 0);
+        std::for_each(std::execution::par, slices.begin(), slices.end(), [this, useSimd](int slice) {
+            AssignSlice(slice, useSimd);
+        });
+        return;
+    }
+    for (int slice = 0; slice < kClustersZ; ++slice) {
+        AssignSlice(slice, useSimd);
+    }
+}
+
+void LightClusterer::AssignSlice(int slice, bool useSimd) {
+    const int base = slice * kTilesPerSlice;
+    for (int tile = 0; tile < kTilesPerSlice; ++tile) {
+        m_clusterLists[base + tile].clear();
+    }
+    const float sliceNear = m_sliceNear[slice];
+    const float sliceFar = m_sliceFar[slice];
+    const float* minX = m_boundsMinX.data() + base;
+    const float* maxX = m_boundsMaxX.data() + base;
+    const float* minY = m_boundsMinY.data() + base;
+    const float* maxY = m_boundsMaxY.data() + base;
+
+    for (std::size_t index = 0; index < m_viewLights.size(); ++index) {
+        const ViewLight& light = m_viewLights[index];
+        if (light.depth + light.radius < sliceNear || light.depth - light.radius > sliceFar) {
+            continue;
+        }
+        // 深度方向的距离对整个切片相同，只需计算一次
+        const float dz = std::max(std::max(sliceNear - light.depth, light.depth - sliceFar), 0.0f);
+        const float dz2 = dz * dz;
+        const float radius2 = light.radius * light.radius;
+        const std::uint32_t lightIndex = static_cast<std::uint32_t>(index);
+        // 同一行分块的 y 范围相同，先按行排除，行内再逐簇测试 x
+        for (int y = 0; y < kClustersY; ++y) {
+            const int row = y * kClustersX;
+            const float dy = std::max(std::max(minY[row] - light.y, light.y - maxY[row]), 0.0f);
+            const float dy2 = dy * dy;
+            if (dy2 + dz2 > radius2) {
+                continue;
+            }
+#ifdef LIGHT_CLUSTERER_SSE2
+            if (useSimd) {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 centreX = _mm_set1_ps(light.x);
+                const __m128 rowDistance2 = _mm_set1_ps(dy2);
+                const __m128 depthDistance2 = _mm_set1_ps(dz2);
+                const __m128 limit = _mm_set1_ps(radius2);
+                for (int tile = row; tile < row + kClustersX; tile += 4) {
+                    const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(minX + tile), centreX),
+                                                            _mm_sub_ps(centreX, _mm_loadu_ps(maxX + tile))), zero);
+                    const __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), rowDistance2), depthDistance2);
+                    int mask = _mm_movemask_ps(_mm_cmple_ps(distance2, limit));
+                    while (mask != 0) {
+                        const int lane = (mask & 1) ? 0 : ((mask & 2) ? 1 : ((mask & 4) ? 2 : 3));
+                        m_clusterLists[base + tile + lane].push_back(lightIndex);
+                        mask &= mask - 1;
+                    }
+                }
+                continue;
+            }
+#endif
+            for (int tile = row; tile < row + kClustersX; ++tile) {
+                const float dx = std::max(std::max(minX[tile] - light.x, light.x - maxX[tile]), 0.0f);
+                if (dx * dx + dy2 + dz2 <= radius2) {
+                    m_clusterLists[base + tile].push_back(lightIndex);
+                }
+            }
+        }
+    }
+}
+
+void LightClusterer::GatherLists() {
+    m_lightIndices.clear();
+    m_maxLightsPerCluster = 0;
+    m_occupiedClusters = 0;
+    for (int cluster = 0; cluster < kClusterCount; ++cluster) {
+        const auto& list = m_clusterLists[cluster];
+        m_clusterRanges[cluster * 2] = static_cast<std::uint32_t>(m_lightIndices.size());
+        m_clusterRanges[cluster * 2 + 1] = static_cast<std::uint32_t>(list.size());
+        m_lightIndices.insert(m_lightIndices.end(), list.begin(), list.end());
+        m_maxLightsPerCluster = std::max(m_maxLightsPerCluster, list.size());
+        m_occupiedClusters += list.empty() ? 0 : 1;
+    }
+}
+
+void LightClusterer::Benchmark() {
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int kRepeats = 20;
+    constexpr float kNearPlane = 0.3f;
+    constexpr float kFarPlane = 2250.0f;
+
+    const Matrix4 projection = Matrix4::Perspective(kNearPlane, kFarPlane, 16.0f / 9.0f, 35.0f);
+    const Matrix4 view = Matrix4::BuildViewMatrix(Vector3(160.0f, 70.0f, 160.0f), Vector3(1024.0f, 20.0f, 1024.0f));
+    std::mt19937 rng(1337u);
+    std::uniform_real_distribution<float> horizontal(0.0f, 2048.0f);
+    std::uniform_real_distribution<float> height(0.0f, 120.0f);
+    std::uniform_real_distribution<float> intensity(0.5f, 6.0f);
+
+    for (const int count : { 10, 100, 1000, 10000 }) {
+        std::vector<Light> lights(static_cast<std::size_t>(count));
+        for (Light& light : lights) {
+            light.position = Vector3(horizontal(rng), height(rng), horizontal(rng));
+            light.color = Vector3(intensity(rng), intensity(rng), intensity(rng));
+            light.ambient = Vector3(0.0f, 0.0f, 0.0f);
+        }
+
+        LightClusterer clusterer;
+        float buildMs = 0.0f;
+        for (int repeat = 0; repeat < kRepeats; ++repeat) {
+            clusterer.SetLights(lights);
+            clusterer.Build(view, projection.values[0], projection.values[5], kNearPlane, kFarPlane);
+            buildMs += clusterer.GetBuildMs();
+        }
+
+        float scalarMs = 0.0f;
+        float simdMs = 0.0f;
+        float parallelMs = 0.0f;
+        std::vector<std::vector<std::uint32_t>> results;
+        for (const auto& [parallel, useSimd] : { std::pair{ false, false }, std::pair{ false, true }, std::pair{ true, true } }) {
+            const auto start = Clock::now();
+            for (int repeat = 0; repeat < kRepeats; ++repeat) {
+                clusterer.AssignSlices(parallel, useSimd);
+                clusterer.GatherLists();
+            }
+            const float ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count() / kRepeats;
+            (parallel ? parallelMs : (useSimd ? simdMs : scalarMs)) = ms;
+            results.push_back(clusterer.m_lightIndices);
+            results.back().insert(results.back().end(), clusterer.m_clusterRanges.begin(), clusterer.m_clusterRanges.end());
+        }
+        const std::size_t pathMismatches = (results[0] != results[1] ? 1 : 0) + (results[0] != results[2] ? 1 : 0);
+
+        // 朴素参照：每个光源对每个簇做完整的三维球与包围盒测试，不做切片预筛
+        std::size_t referenceMismatches = 0;
+        for (int cluster = 0; cluster < kClusterCount; ++cluster) {
+            const int slice = cluster / kTilesPerSlice;
+            std::vector<std::uint32_t> expected;
+            for (std::size_t index = 0; index < clusterer.m_viewLights.size(); ++index) {
+                const ViewLight& light = clusterer.m_viewLights[index];
+                const float dx = std::max(std::max(clusterer.m_boundsMinX[cluster] - light.x, light.x - clusterer.m_boundsMaxX[cluster]), 0.0f);
+                const float dy = std::max(std::max(clusterer.m_boundsMinY[cluster] - light.y, light.y - clusterer.m_boundsMaxY[cluster]), 0.0f);
+                const float dz = std::max(std::max(clusterer.m_sliceNear[slice] - light.depth, light.depth - clusterer.m_sliceFar[slice]), 0.0f);
+                if (dx * dx + dy * dy + dz * dz <= light.radius * light.radius) {
+                    expected.push_back(static_cast<std::uint32_t>(index));
+                }
+            }
+            const std::uint32_t offset = clusterer.m_clusterRanges[cluster * 2];
+            const std::uint32_t size = clusterer.m_clusterRanges[cluster * 2 + 1];
+            if (size != expected.size() ||
+                !std::equal(expected.begin(), expected.end(), clusterer.m_lightIndices.begin() + offset)) {
+                ++referenceMismatches;
+            }
+        }
+
+        std::cerr << "[LightClusterer] " << count << " lights, " << kClustersX << "x" << kClustersY << "x" << kClustersZ
+                  << " clusters: scalar " << scalarMs << "ms, SIMD " << simdMs << "ms, SIMD + parallel slices "
+                  << parallelMs << "ms (x" << (parallelMs > 0.0f ? scalarMs / parallelMs : 0.0f) << "), full Build "
+                  << buildMs / kRepeats << "ms" << "\n";
+        std::cerr << "[LightClusterer] " << clusterer.m_lightIndices.size() << " light indices, "
+                  << clusterer.GetOccupiedClusterCount() << " occupied clusters, at most "
+                  << clusterer.GetMaxLightsPerCluster() << " lights per cluster, " << pathMismatches
+                  << " path(s) differing from scalar, " << referenceMismatches << " cluster(s) differing from the reference" << "\n";
+    }
+}
@@ -0,0 +1,113 @@
+﻿/**
+ * @file LightClusterer.h
+ * @brief 声明为分簇前向着色在 CPU 上构建点光源列表的 LightClusterer。
+ * @details
+ * 视锥在屏幕上划分为 kClustersX × kClustersY 的分块，深度方向划分为 kClustersZ 个切片：
+ * 切片 0 覆盖近平面到 kFirstSliceDepth，其余切片在 kFirstSliceDepth 与远平面之间按指数分布，
+ * 使每个簇在屏幕与深度方向上的尺寸大致成比例。每个簇在视图空间中以轴对齐包围盒表示，
+ * 包围盒只取决于投影参数，参数不变时不重新计算。
+ *
+ * 光源影响半径:
+ * Light 不带半径，ComputeInfluenceRadius 取颜色最大分量按平方反比衰减到 kRadianceCutoff 的距离。
+ * 着色器在半径处用平滑窗口把辐照度压到 0，光源因此只需分配给与其影响球相交的簇。
+ * 点光源的环境光分量与距离无关，不参与分簇，而是汇总为 GetAmbientSum 交给着色器。
+ *
+ * 构建:
+ * Build 先把光源球心变换到视图空间，再按深度切片由 std::execution::par 并行分配：
+ * 每个切片只写自己的簇列表，无需同步。切片内逐光源先按分块行排除（同一行的 y 范围相同），
+ * 行内每 4 个簇一组用 SSE2 计算球心到包围盒的距离平方（无 SSE2 时走标量路径），两条路径的运算顺序一致，
+ * 结果逐位相同。最后按簇顺序拼接为 GetClusterRanges（每簇 offset、count）与 GetLightIndices，
+ * 簇内光源按索引升序排列，输出与线程调度无关。视图矩阵、投影参数与光源都未变化时 Build 直接返回。
+ *
+ * 着色器侧通过 GetShaderParameters 得到 (投影 x 缩放, 投影 y 缩放, kFirstSliceDepth, 切片比例)，
+ * 由片元的视图空间坐标算出所在簇，只遍历该簇列表中的光源。
+ *
+ * 静态函数 Benchmark():
+ * 对 10 到 10k 个随机光源记录构建耗时，比较标量/SIMD 与单线程/并行结果，
+ * 并以逐光源逐簇的朴素测试为参照校验簇列表一致。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Core/Light.h"
+
+#include "nclgl/Matrix4.h"
+#include "nclgl/Vector3.h"
+#include "nclgl/Vector4.h"
+
+class LightClusterer {
+public:
+    static constexpr int kClustersX = 16;
+    static constexpr int kClustersY = 9;
+    static constexpr int kClustersZ = 24;
+    static constexpr int kClusterCount = kClustersX * kClustersY * kClustersZ;
+    static constexpr float kFirstSliceDepth = 8.0f;
+    static constexpr float kRadianceCutoff = 1e-3f;
+
+    // 与着色器中 std430 布局的 ClusterLight 一致
+    struct GpuLight {
+        float positionRadius[4];
+        float color[4];
+    };
+
+    LightClusterer();
+
+    void SetLights(const std::vector<Light>& lights);
+    bool Build(const Matrix4& view, float projectionScaleX, float projectionScaleY, float nearPlane, float farPlane);
+
+    const std::vector<GpuLight>& GetGpuLights() const { return m_gpuLights; }
+    const std::vector<std::uint32_t>& GetClusterRanges() const { return m_clusterRanges; }
+    const std::vector<std::uint32_t>& GetLightIndices() const { return m_lightIndices; }
+    Vector4 GetShaderParameters() const;
+    Vector3 GetAmbientSum() const { return m_ambientSum; }
+
+    std::size_t GetLightCount() const { return m_gpuLights.size(); }
+    std::size_t GetMaxLightsPerCluster() const { return m_maxLightsPerCluster; }
+    std::size_t GetOccupiedClusterCount() const { return m_occupiedClusters; }
+    float GetBuildMs() const { return m_buildMs; }
+
+    static float ComputeInfluenceRadius(const Light& light);
+    static void Benchmark();
+
+private:
+    struct ViewLight {
+        float x;
+        float y;
+        float depth;
+        float radius;
+    };
+
+    void UpdateClusterBounds(float projectionScaleX, float projectionScaleY, float nearPlane, float farPlane);
+    void AssignSlices(bool parallel, bool useSimd);
+    void AssignSlice(int slice, bool useSimd);
+    void GatherLists();
+
+    std::vector<GpuLight> m_gpuLights;
+    std::vector<ViewLight> m_viewLights;
+    Vector3 m_ambientSum;
+    std::uint64_t m_lightsVersion;
+    std::uint64_t m_builtVersion;
+    Matrix4 m_builtView;
+    float m_projectionScaleX;
+    float m_projectionScaleY;
+    float m_nearPlane;
+    float m_farPlane;
+    float m_firstSliceDepth;
+    float m_sliceScale;
+    // 视图空间簇包围盒：x/y 按簇存放（SoA，便于 SIMD），深度按切片存放
+    std::vector<float> m_boundsMinX;
+    std::vector<float> m_boundsMaxX;
+    std::vector<float> m_boundsMinY;
+    std::vector<float> m_boundsMaxY;
+    std::vector<float> m_sliceNear;
+    std::vector<float> m_sliceFar;
+    std::vector<std::vector<std::uint32_t>> m_clusterLists;
+    std::vector<std::uint32_t> m_clusterRanges;
+    std::vector<std::uint32_t> m_lightIndices;
+    std::size_t m_maxLightsPerCluster;
+    std::size_t m_occupiedClusters;
+    float m_buildMs;
+};
@@ -0,0 +1,621 @@
+﻿/**
+ * @file OcclusionCuller.cpp
+ * @brief 实现 CPU 软件光栅化遮挡剔除与 Hi-Z 金字塔。
+ */
+#include "OcclusionCuller.h"
+#include "Frustum.h"
+#include "SyntheticTerrain.h"
+
+#include "../Engine/IAL/I_Heightmap.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include "nclgl/Vector2.h"
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define OCCLUSION_CULLER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr int kTileWidth = 64;
+    constexpr int kTileHeight = 32;
+    constexpr int kTilesX = OcclusionCuller::kDepthWidth / kTileWidth;
+    constexpr int kTilesY = OcclusionCuller::kDepthHeight / kTileHeight;
+    // 地形遮挡网格的单元数与每个分组的单元数
+    constexpr int kTerrainCells = 64;
+    constexpr int kChunkCells = 8;
+    constexpr float kMinTriangleArea = 1e-6f;
+    // 保守光栅化时边函数按半个像素再多收缩的比例，吸收像素中心处求值的浮点误差
+    constexpr float kCoverageMargin = 1e-3f;
+
+    static_assert(OcclusionCuller::kDepthWidth % kTileWidth == 0, "depth width must be a multiple of the tile width");
+    static_assert(OcclusionCuller::kDepthHeight % kTileHeight == 0, "depth height must be a multiple of the tile height");
+    static_assert(kTileWidth % 4 == 0, "tile width must be a multiple of the SIMD width");
+
+    // 近平面为 z = -w，z + w >= 0 的一侧可见
+    float NearDistance(const Vector4& v) {
+        return v.z + v.w;
+    }
+
+    Vector4 LerpClip(const Vector4& a, const Vector4& b, float t) {
+        return Vector4(a.x + (b.x - a.x) * t,
+                       a.y + (b.y - a.y) * t,
+                       a.z + (b.z - a.z) * t,
+                       a.w + (b.w - a.w) * t);
+    }
+
+    Vector3 ToScreen(const Vector4& clip) {
+        const float inverseW = 1.0f / clip.w;
+        return Vector3((clip.x * inverseW * 0.5f + 0.5f) * OcclusionCuller::kDepthWidth,
+                       (clip.y * inverseW * 0.5f + 0.5f) * OcclusionCuller::kDepthHeight,
+                       clip.z * inverseW);
+    }
+}
+
+OcclusionCuller::OcclusionCuller() :
+    m_viewProj()
+    , m_terrainGrid(0)
+    , m_rasterMs(0.0f) {
+    m_viewProj.ToIdentity();
+    int width = kDepthWidth;
+    int height = kDepthHeight;
+    while (true) {
+        m_levelWidths.push_back(width);
+        m_levelHeights.push_back(height);
+        m_levels.emplace_back(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), 1.0f);
+        if (width == 1 && height == 1) {
+            break;
+        }
+        width = std::max(1, (width + 1) / 2);
+        height = std::max(1, (height + 1) / 2);
+    }
+}
+
+void OcclusionCuller::SetTerrain(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap) {
+    m_terrainGrid = 0;
+    m_terrainVertices.clear();
+    m_terrainChunks.clear();
+    if (!heightmap) {
+        return;
+    }
+    const Vector2 resolution = heightmap->GetResolution();
+    const Vector3 scale = heightmap->GetWorldScale();
+    if (resolution.x < 2.0f || resolution.y < 2.0f) {
+        return;
+    }
+    // 逐采样扫描的区间查询在大地形上过慢，只有加速实现才生成地形遮挡体
+    if (!heightmap->HasFastHeightRange()) {
+        std::cerr << "[OcclusionCuller] Terrain " << resolution.x << "x" << resolution.y
+                  << " has no fast height range query, terrain will not occlude" << "\n";
+        return;
+    }
+
+    const float cellWidth = (resolution.x - 1.0f) * scale.x / kTerrainCells;
+    const float cellDepth = (resolution.y - 1.0f) * scale.z / kTerrainCells;
+    std::vector<float> cellMin(static_cast<std::size_t>(kTerrainCells) * kTerrainCells, 0.0f);
+    for (int z = 0; z < kTerrainCells; ++z) {
+        for (int x = 0; x < kTerrainCells; ++x) {
+            float lo = 0.0f;
+            float hi = 0.0f;
+            if (heightmap->GetHeightRange(x * cellWidth, z * cellDepth, (x + 1) * cellWidth, (z + 1) * cellDepth, lo, hi)) {
+                cellMin[z * kTerrainCells + x] = lo;
+            }
+        }
+    }
+
+    // 顶点取相邻单元最小值中的最小者，粗网格的每个三角形因此都不高于对应区域的真实地表
+    m_terrainGrid = kTerrainCells + 1;
+    m_terrainVertices.resize(static_cast<std::size_t>(m_terrainGrid) * m_terrainGrid);
+    for (int z = 0; z < m_terrainGrid; ++z) {
+        for (int x = 0; x < m_terrainGrid; ++x) {
+            float height = std::numeric_limits<float>::max();
+            for (int dz = -1; dz <= 0; ++dz) {
+                for (int dx = -1; dx <= 0; ++dx) {
+                    const int cx = x + dx;
+                    const int cz = z + dz;
+                    if (cx >= 0 && cz >= 0 && cx < kTerrainCells && cz < kTerrainCells) {
+                        height = std::min(height, cellMin[cz * kTerrainCells + cx]);
+                    }
+                }
+            }
+            m_terrainVertices[z * m_terrainGrid + x] = Vector3(x * cellWidth, height, z * cellDepth);
+        }
+    }
+
+    for (int z0 = 0; z0 < kTerrainCells; z0 += kChunkCells) {
+        for (int x0 = 0; x0 < kTerrainCells; x0 += kChunkCells) {
+            TerrainChunk chunk;
+            chunk.cellX0 = x0;
+            chunk.cellZ0 = z0;
+            chunk.cellX1 = std::min(x0 + kChunkCells, kTerrainCells);
+            chunk.cellZ1 = std::min(z0 + kChunkCells, kTerrainCells);
+            chunk.boundsMin = m_terrainVertices[z0 * m_terrainGrid + x0];
+            chunk.boundsMax = chunk.boundsMin;
+            for (int z = z0; z <= chunk.cellZ1; ++z) {
+                for (int x = x0; x <= chunk.cellX1; ++x) {
+                    const Vector3& v = m_terrainVertices[z * m_terrainGrid + x];
+                    chunk.boundsMin.y = std::min(chunk.boundsMin.y, v.y);
+                    chunk.boundsMax.y = std::max(chunk.boundsMax.y, v.y);
+                }
+            }
+            chunk.boundsMax.x = m_terrainVertices[chunk.cellX1].x;
+            chunk.boundsMax.z = m_terrainVertices[chunk.cellZ1 * m_terrainGrid].z;
+            m_terrainChunks.push_back(chunk);
+        }
+    }
+}
+
+void OcclusionCuller::BeginFrame(const Matrix4& viewProj) {
+    m_viewProj = viewProj;
+    m_triangles.clear();
+    std::fill(m_levels[0].begin(), m_levels[0].end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluderBox(const Matrix4& model, const Vector3& localMin, const Vector3& localMax) {
+    static constexpr int kBoxTriangles[12][3] = {
+        { 0, 1, 3 }, { 0, 3, 2 }, { 4, 6, 7 }, { 4, 7, 5 },
+        { 0, 4, 5 }, { 0, 5, 1 }, { 2, 3, 7 }, { 2, 7, 6 },
+        { 0, 2, 6 }, { 0, 6, 4 }, { 1, 5, 7 }, { 1, 7, 3 }
+    };
+    const Matrix4 modelViewProj = m_viewProj * model;
+    std::array<Vector4, 8> corners;
+    for (int i = 0; i < 8; ++i) {
+        const Vector3 local((i & 1) ? localMax.x : localMin.x,
+                            (i & 2) ? localMax.y : localMin.y,
+                            (i & 4) ? localMax.z : localMin.z);
+        corners[i] = modelViewProj * Vector4(local.x, local.y, local.z, 1.0f);
+    }
+    for (const auto& triangle : kBoxTriangles) {
+        AddTriangle(corners[triangle[0]], corners[triangle[1]], corners[triangle[2]]);
+    }
+}
+
+void OcclusionCuller::AddTriangle(const Vector4& a, const Vector4& b, const Vector4& c) {
+    // 三个顶点都在同一裁剪平面外侧时整块丢弃
+    if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+        (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w) ||
+        (a.z > a.w && b.z > b.w && c.z > c.w)) {
+        return;
+    }
+    const Vector4 vertices[3] = { a, b, c };
+    if (NearDistance(a) >= 0.0f && NearDistance(b) >= 0.0f && NearDistance(c) >= 0.0f) {
+        SetupTriangle(ToScreen(a), ToScreen(b), ToScreen(c));
+        return;
+    }
+    AddClippedTriangle(vertices, 3);
+}
+
+void OcclusionCuller::AddClippedTriangle(const Vector4* vertices, int count) {
+    std::array<Vector4, 4> clipped;
+    int clippedCount = 0;
+    for (int i = 0; i < count; ++i) {
+        const Vector4& current = vertices[i];
+        const Vector4& next = vertices[(i + 1) % count];
+        const float dCurrent = NearDistance(current);
+        const float dNext = NearDistance(next);
+        if (dCurrent >= 0.0f) {
+            clipped[clippedCount++] = current;
+        }
+        if ((dCurrent >= 0.0f) != (dNext >= 0.0f)) {
+            clipped[clippedCount++] = LerpClip(current, next, dCurrent / (dCurrent - dNext));
+        }
+    }
+    if (clippedCount < 3) {
+        return;
+    }
+    const Vector3 first = ToScreen(clipped[0]);
+    for (int i = 1; i + 1 < clippedCount; ++i) {
+        SetupTriangle(first, ToScreen(clipped[i]), ToScreen(clipped[i + 1]));
+    }
+}
+
+void OcclusionCuller::SetupTriangle(const Vector3& a, const Vector3& bIn, const Vector3& cIn) {
+    Vector3 b = bIn;
+    Vector3 c = cIn;
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (std::abs(area) < kMinTriangleArea) {
+        return;
+    }
+    // 统一为逆时针，内部点的三条边函数均为正；正反面都参与光栅化
+    if (area < 0.0f) {
+        std::swap(b, c);
+        area = -area;
+    }
+    ScreenTriangle triangle;
+    triangle.minX = std::min({ a.x, b.x, c.x });
+    triangle.minY = std::min({ a.y, b.y, c.y });
+    triangle.maxX = std::max({ a.x, b.x, c.x });
+    triangle.maxY = std::max({ a.y, b.y, c.y });
+    if (triangle.maxX < 0.0f || triangle.maxY < 0.0f ||
+        triangle.minX > static_cast<float>(kDepthWidth) || triangle.minY > static_cast<float>(kDepthHeight)) {
+        return;
+    }
+    const Vector3* points[3] = { &a, &b, &c };
+    float depthA = 0.0f;
+    float depthB = 0.0f;
+    float depthC = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        // 第 i 条边为第 i 个顶点的对边，其边函数在该顶点处等于面积
+        const Vector3& from = *points[(i + 1) % 3];
+        const Vector3& to = *points[(i + 2) % 3];
+        triangle.edgeA[i] = from.y - to.y;
+        triangle.edgeB[i] = to.x - from.x;
+        triangle.edgeC[i] = -(triangle.edgeA[i] * from.x + triangle.edgeB[i] * from.y);
+        depthA += triangle.edgeA[i] * points[i]->z;
+        depthB += triangle.edgeB[i] * points[i]->z;
+        depthC += triangle.edgeC[i] * points[i]->z;
+    }
+    const float inverseArea = 1.0f / area;
+    triangle.depthA = depthA * inverseArea;
+    triangle.depthB = depthB * inverseArea;
+    triangle.depthC = depthC * inverseArea;
+    // 保守光栅化：线性函数在以像素中心为中心的单位方格上的最小/最大值等于中心值 ∓ 0.5 × (|A| + |B|)。
+    // 三条边函数各收缩该量，中心测试通过即说明整个像素都在三角形内；深度平面取方格上的最远值。
+    // 光栅化循环不变，标量与 SIMD 路径仍逐位一致，写入的深度只会比像素内任何一点的真实深度更远。
+    for (int i = 0; i < 3; ++i) {
+        triangle.edgeC[i] -= (0.5f + kCoverageMargin) * (std::abs(triangle.edgeA[i]) + std::abs(triangle.edgeB[i]));
+    }
+    triangle.depthC += 0.5f * (std::abs(triangle.depthA) + std::abs(triangle.depthB));
+    m_triangles.push_back(triangle);
+}
+
+void OcclusionCuller::Rasterize() {
+    const auto start = std::chrono::high_resolution_clock::now();
+    if (!m_terrainChunks.empty()) {
+        const Frustum frustum = Frustum::FromViewProjection(m_viewProj);
+        std::vector<Vector4> clipVertices;
+        for (const auto& chunk : m_terrainChunks) {
+            if (!frustum.IntersectsAABB(chunk.boundsMin, chunk.boundsMax)) {
+                continue;
+            }
+            if (clipVertices.empty()) {
+                clipVertices.resize(m_terrainVertices.size());
+                for (std::size_t i = 0; i < m_terrainVertices.size(); ++i) {
+                    const Vector3& v = m_terrainVertices[i];
+                    clipVertices[i] = m_viewProj * Vector4(v.x, v.y, v.z, 1.0f);
+                }
+            }
+            for (int z = chunk.cellZ0; z < chunk.cellZ1; ++z) {
+                for (int x = chunk.cellX0; x < chunk.cellX1; ++x) {
+                    const std::size_t i00 = static_cast<std::size_t>(z) * m_terrainGrid + x;
+                    const std::size_t i10 = i00 + 1;
+                    const std::size_t i01 = i00 + m_terrainGrid;
+                    const std::size_t i11 = i01 + 1;
+                    AddTriangle(clipVertices[i00], clipVertices[i01], clipVertices[i11]);
+                    AddTriangle(clipVertices[i00], clipVertices[i11], clipVertices[i10]);
+                }
+            }
+        }
+    }
+#ifdef OCCLUSION_CULLER_SSE2
+    RasterizeTiles(true, true);
+#else
+    RasterizeTiles(true, false);
+#endif
+    BuildHierarchy();
+    m_rasterMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void OcclusionCuller::RasterizeTiles(bool parallel, bool useSimd) {
+    std::vector<int> tiles(kTilesX * kTilesY);
+    std::iota(tiles.begin(), tiles.end(), 0);
+    auto rasterizeTile = [&](int tile) {
+        RasterizeTile(tile % kTilesX, tile / kTilesX, useSimd);
+    };
+    if (parallel) {
+        std::for_each(std::execution::par, tiles.begin(), tiles.end(), rasterizeTile);
+    }
+    else {
+        std::for_each(tiles.begin(), tiles.end(), rasterizeTile);
+    }
+}
+
+void OcclusionCuller::RasterizeTile(int tileX, int tileY, bool useSimd) {
+    const int tileX0 = tileX * kTileWidth;
+    const int tileY0 = tileY * kTileHeight;
+    const int tileX1 = tileX0 + kTileWidth - 1;
+    const int tileY1 = tileY0 + kTileHeight - 1;
+    float* depth = m_levels[0].data();
+
+    for (const auto& triangle : m_triangles) {
+        // 只处理像素中心落在包围盒内的像素；完全覆盖的像素必在其中
+        const int x0 = std::max(tileX0, static_cast<int>(std::ceil(triangle.minX - 0.5f)));
+        const int x1 = std::min(tileX1, static_cast<int>(std::floor(triangle.maxX - 0.5f)));
+        const int y0 = std::max(tileY0, static_cast<int>(std::ceil(triangle.minY - 0.5f)));
+        const int y1 = std::min(tileY1, static_cast<int>(std::floor(triangle.maxY - 0.5f)));
+        if (x0 > x1 || y0 > y1) {
+            continue;
+        }
+        for (int y = y0; y <= y1; ++y) {
+            const float centreY = static_cast<float>(y) + 0.5f;
+            const float row0 = triangle.edgeB[0] * centreY + triangle.edgeC[0];
+            const float row1 = triangle.edgeB[1] * centreY + triangle.edgeC[1];
+            const float row2 = triangle.edgeB[2] * centreY + triangle.edgeC[2];
+            const float rowDepth = triangle.depthB * centreY + triangle.depthC;
+            float* depthRow = depth + static_cast<std::size_t>(y) * kDepthWidth;
+            int x = x0;
+#ifdef OCCLUSION_CULLER_SSE2
+            if (useSimd) {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]);
+                const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA[1]);
+                const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+                const __m128 depthA = _mm_set1_ps(triangle.depthA);
+                const __m128 rowE0 = _mm_set1_ps(row0);
+                const __m128 rowE1 = _mm_set1_ps(row1);
+                const __m128 rowE2 = _mm_set1_ps(row2);
+                const __m128 rowZ = _mm_set1_ps(rowDepth);
+                const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+                // 分块宽度是 4 的倍数，按 4 对齐后的最后一组不会越过分块边界；包围盒外的通道必在三角形外
+                for (x = x0 & ~3; x <= x1; x += 4) {
+                    const __m128 centreX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+                    const __m128 e0 = _mm_add_ps(_mm_mul_ps(edgeA0, centreX), rowE0);
+                    const __m128 e1 = _mm_add_ps(_mm_mul_ps(edgeA1, centreX), rowE1);
+                    const __m128 e2 = _mm_add_ps(_mm_mul_ps(edgeA2, centreX), rowE2);
+                    const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                                                     _mm_cmpge_ps(e2, zero));
+                    if (_mm_movemask_ps(inside) == 0) {
+                        continue;
+                    }
+                    const __m128 z = _mm_add_ps(_mm_mul_ps(depthA, centreX), rowZ);
+                    const __m128 current = _mm_loadu_ps(depthRow + x);
+                    const __m128 nearest = _mm_min_ps(current, z);
+                    _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+                }
+            }
+#endif
+            for (; x <= x1; ++x) {
+                const float centreX = static_cast<float>(x) + 0.5f;
+                const float e0 = triangle.edgeA[0] * centreX + row0;
+                const float e1 = triangle.edgeA[1] * centreX + row1;
+                const float e2 = triangle.edgeA[2] * centreX + row2;
+                if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f) {
+                    const float z = triangle.depthA * centreX + rowDepth;
+                    depthRow[x] = std::min(depthRow[x], z);
+                }
+            }
+        }
+    }
+}
+
+void OcclusionCuller::BuildHierarchy() {
+    for (std::size_t level = 1; level < m_levels.size(); ++level) {
+        const std::vector<float>& source = m_levels[level - 1];
+        std::vector<float>& target = m_levels[level];
+        const int sourceWidth = m_levelWidths[level - 1];
+        const int sourceHeight = m_levelHeights[level - 1];
+        const int width = m_levelWidths[level];
+        const int height = m_levelHeights[level];
+        for (int y = 0; y < height; ++y) {
+            const int sy0 = std::min(y * 2, sourceHeight - 1);
+            const int sy1 = std::min(y * 2 + 1, sourceHeight - 1);
+            for (int x = 0; x < width; ++x) {
+                const int sx0 = std::min(x * 2, sourceWidth - 1);
+                const int sx1 = std::min(x * 2 + 1, sourceWidth - 1);
+                target[y * width + x] = std::max(std::max(source[sy0 * sourceWidth + sx0], source[sy0 * sourceWidth + sx1]),
+                                                 std::max(source[sy1 * sourceWidth + sx0], source[sy1 * sourceWidth + sx1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::ProjectBounds(const Vector3& worldMin, const Vector3& worldMax,
+                                    int& x0, int& y0, int& x1, int& y1, float& nearestDepth, bool& straddlesNear) const {
+    straddlesNear = false;
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    nearestDepth = std::numeric_limits<float>::max();
+    for (int i = 0; i < 8; ++i) {
+        const Vector4 clip = m_viewProj * Vector4((i & 1) ? worldMax.x : worldMin.x,
+                                                  (i & 2) ? worldMax.y : worldMin.y,
+                                                  (i & 4) ? worldMax.z : worldMin.z,
+                                                  1.0f);
+        if (NearDistance(clip) <= 0.0f) {
+            straddlesNear = true;
+            return true;
+        }
+        const Vector3 screen = ToScreen(clip);
+        minX = std::min(minX, screen.x);
+        minY = std::min(minY, screen.y);
+        maxX = std::max(maxX, screen.x);
+        maxY = std::max(maxY, screen.y);
+        nearestDepth = std::min(nearestDepth, screen.z);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX > static_cast<float>(kDepthWidth) || minY > static_cast<float>(kDepthHeight)) {
+        return false;
+    }
+    x0 = std::clamp(static_cast<int>(std::floor(minX)), 0, kDepthWidth - 1);
+    y0 = std::clamp(static_cast<int>(std::floor(minY)), 0, kDepthHeight - 1);
+    x1 = std::clamp(static_cast<int>(std::floor(maxX)), 0, kDepthWidth - 1);
+    y1 = std::clamp(static_cast<int>(std::floor(maxY)), 0, kDepthHeight - 1);
+    return true;
+}
+
+bool OcclusionCuller::IsVisible(const Vector3& worldMin, const Vector3& worldMax) const {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+    float nearestDepth = 0.0f;
+    bool straddlesNear = false;
+    if (!ProjectBounds(worldMin, worldMax, x0, y0, x1, y1, nearestDepth, straddlesNear)) {
+        return false;
+    }
+    if (straddlesNear) {
+        return true;
+    }
+    // 选择矩形最多覆盖 2×2 个纹素的层级
+    std::size_t level = 0;
+    while (level + 1 < m_levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+        ++level;
+    }
+    const std::vector<float>& depth = m_levels[level];
+    const int width = m_levelWidths[level];
+    for (int y = y0 >> level; y <= (y1 >> level); ++y) {
+        for (int x = x0 >> level; x <= (x1 >> level); ++x) {
+            if (depth[y * width + x] >= nearestDepth) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool OcclusionCuller::IsVisibleExact(const Vector3& worldMin, const Vector3& worldMax) const {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+    float nearestDepth = 0.0f;
+    bool straddlesNear = false;
+    if (!ProjectBounds(worldMin, worldMax, x0, y0, x1, y1, nearestDepth, straddlesNear)) {
+        return false;
+    }
+    if (straddlesNear) {
+        return true;
+    }
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            if (m_levels[0][y * kDepthWidth + x] >= nearestDepth) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void OcclusionCuller::Benchmark() {
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int kViews = 16;
+    constexpr int kBoxesPerView = 4096;
+    constexpr int kRepeats = 20;
+    constexpr std::size_t kRayChecksPerView = 256;
+
+    auto terrain = std::make_shared<SyntheticTerrain>();
+    OcclusionCuller culler;
+    auto start = Clock::now();
+    culler.SetTerrain(terrain);
+    const float setupMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+    const Matrix4 projection = Matrix4::Perspective(0.3f, 2250.0f, 16.0f / 9.0f, 35.0f);
+    std::mt19937 rng(1337u);
+    std::uniform_real_distribution<float> position(100.0f, 1946.0f);
+    std::uniform_real_distribution<float> boxSize(2.0f, 24.0f);
+    std::uniform_real_distribution<float> lift(0.0f, 12.0f);
+
+    float scalarMs = 0.0f;
+    float simdMs = 0.0f;
+    float parallelMs = 0.0f;
+    float queryMs = 0.0f;
+    std::size_t triangles = 0;
+    std::size_t tested = 0;
+    std::size_t culled = 0;
+    std::size_t culledExact = 0;
+    std::size_t falseOcclusions = 0;
+    std::size_t rasterMismatches = 0;
+    std::size_t offscreen = 0;
+    std::size_t rayChecked = 0;
+    std::size_t rayVisible = 0;
+
+    for (int view = 0; view < kViews; ++view) {
+        // 相机贴近地表、略微俯视，大部分物体位于山脊之后
+        const Vector3 eye(position(rng), 0.0f, position(rng));
+        const Vector3 target(position(rng), 0.0f, position(rng));
+        const Vector3 from(eye.x, terrain->SampleHeight(eye.x, eye.z) + 6.0f, eye.z);
+        const Vector3 lookAt(target.x, terrain->SampleHeight(target.x, target.z), target.z);
+        culler.BeginFrame(projection * Matrix4::BuildViewMatrix(from, lookAt));
+        culler.Rasterize();
+        triangles += culler.m_triangles.size();
+
+        std::vector<std::vector<float>> results;
+        for (const auto& [parallel, useSimd] : { std::pair{ false, false }, std::pair{ false, true }, std::pair{ true, true } }) {
+            start = Clock::now();
+            for (int repeat = 0; repeat < kRepeats; ++repeat) {
+                std::fill(culler.m_levels[0].begin(), culler.m_levels[0].end(), 1.0f);
+                culler.RasterizeTiles(parallel, useSimd);
+            }
+            const float ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count() / kRepeats;
+            (parallel ? parallelMs : (useSimd ? simdMs : scalarMs)) += ms;
+            results.push_back(culler.m_levels[0]);
+        }
+        if (results[0] != results[1] || results[0] != results[2]) {
+            ++rasterMismatches;
+        }
+        culler.BuildHierarchy();
+
+        std::vector<std::pair<Vector3, Vector3>> boxes(kBoxesPerView);
+        for (auto& [boxMin, boxMax] : boxes) {
+            const float x = position(rng);
+            const float z = position(rng);
+            const float size = boxSize(rng);
+            boxMin = Vector3(x, terrain->SampleHeight(x, z) + lift(rng), z);
+            boxMax = boxMin + Vector3(size, size, size);
+        }
+        start = Clock::now();
+        std::size_t visible = 0;
+        for (const auto& [boxMin, boxMax] : boxes) {
+            visible += culler.IsVisible(boxMin, boxMax) ? 1 : 0;
+        }
+        queryMs += std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+        std::size_t rayChecks = 0;
+        for (const auto& [boxMin, boxMax] : boxes) {
+            int x0 = 0;
+            int y0 = 0;
+            int x1 = 0;
+            int y1 = 0;
+            float nearestDepth = 0.0f;
+            bool straddlesNear = false;
+            if (!culler.ProjectBounds(boxMin, boxMax, x0, y0, x1, y1, nearestDepth, straddlesNear)) {
+                ++offscreen;
+                continue;
+            }
+            const bool hierarchical = culler.IsVisible(boxMin, boxMax);
+            const bool exact = culler.IsVisibleExact(boxMin, boxMax);
+            culledExact += exact ? 0 : 1;
+            falseOcclusions += (!hierarchical && exact) ? 1 : 0;
+            if (hierarchical || rayChecks >= kRayChecksPerView) {
+                continue;
+            }
+            // 以地形射线检测为真值：被剔除的盒子的角点与中心都应被地形挡住
+            ++rayChecks;
+            ++rayChecked;
+            for (int i = 0; i < 9; ++i) {
+                const Vector3 point = i == 8 ? (boxMin + boxMax) * 0.5f
+                                             : Vector3((i & 1) ? boxMax.x : boxMin.x,
+                                                       (i & 2) ? boxMax.y : boxMin.y,
+                                                       (i & 4) ? boxMax.z : boxMin.z);
+                const Vector3 toPoint = point - from;
+                float hitDistance = 0.0f;
+                if (!terrain->Raycast(from, toPoint, toPoint.Length() - 0.5f, hitDistance)) {
+                    ++rayVisible;
+                    break;
+                }
+            }
+        }
+        tested += boxes.size();
+        culled += boxes.size() - visible;
+    }
+
+    std::cerr << "[OcclusionCuller] Terrain occluder grid built in " << setupMs << "ms, "
+              << triangles / kViews << " occluder triangles per view on average" << "\n";
+    std::cerr << "[OcclusionCuller] Raster " << kDepthWidth << "x" << kDepthHeight << " per view: scalar "
+              << scalarMs / kViews << "ms, SIMD " << simdMs / kViews << "ms, SIMD + parallel tiles "
+              << parallelMs / kViews << "ms (x" << (parallelMs > 0.0f ? scalarMs / parallelMs : 0.0f) << "), "
+              << rasterMismatches << " view(s) with differing depth" << "\n";
+    std::cerr << "[OcclusionCuller] " << tested << " box queries (" << offscreen << " off screen): "
+              << culled - offscreen << " occluded by Hi-Z, " << culledExact << " by per-pixel test, "
+              << falseOcclusions << " culled by Hi-Z but visible per pixel, "
+              << (tested > 0 ? queryMs * 1e6f / static_cast<float>(tested) : 0.0f) << "ns per query" << "\n";
+    std::cerr << "[OcclusionCuller] Terrain raycasts on " << rayChecked << " occluded boxes: " << rayVisible
+              << " had a visible corner or centre" << "\n";
+}
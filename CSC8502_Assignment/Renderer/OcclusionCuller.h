@@ -0,0 +1,104 @@
+﻿/**
+ * @file OcclusionCuller.h
+ * @brief 声明基于 CPU 软件光栅化与层级深度（Hi-Z）的遮挡剔除器。
+ * @details
+ * 每个视图在提交绘制前，OcclusionCuller 把少量低多边形遮挡体光栅化到一张
+ * kDepthWidth × kDepthHeight 的浮点深度缓冲（NDC 深度，取最近值），再逐级取 2×2 最大值
+ * 建立 Hi-Z 金字塔。IsVisible 把节点的世界 AABB 投影为屏幕矩形与最近深度，
+ * 选取矩形最多覆盖 2×2 个纹素的层级，若这些纹素记录的最远深度都比包围盒更近，则节点被完全遮挡。
+ *
+ * 遮挡体:
+ * - 地形：SetTerrain 时把高度图降采样为 kTerrainCells² 的粗网格，每个顶点取相邻单元
+ *   高度范围的最小值，粗网格因此始终位于真实地表之下，不会遮住本应可见的物体。
+ *   网格按 8 × 8 单元分组，每组带包围盒，先做视锥剔除再参与光栅化。
+ * - 指定网格：场景通过 SceneNode::AddOccluderBox 标注位于模型实体内部的局部盒子，
+ *   Renderer 每帧以节点世界矩阵调用 AddOccluderBox 提交。
+ *
+ * 光栅化:
+ * 三角形先在裁剪空间对近平面做裁剪，再投影到屏幕。深度缓冲被划分为 64 × 32 的分块，
+ * 各分块由 std::execution::par 并行处理，彼此不写同一像素，无需同步。
+ * 分块内每行按 4 个像素一组用 SSE2 计算三条边函数与深度平面并取最小值（无 SSE2 时走标量路径）。
+ * 光栅化是保守的：只写入被三角形完全覆盖的像素，写入值取深度平面在整个像素上的最远值，
+ * 因此深度缓冲中的每个值都不比该像素内遮挡体的任何一点更近，测试只可能漏剔除、不会误剔除。
+ * 代价是相邻遮挡三角形的公共边所经过的像素不被任何一个写入。
+ *
+ * 静态函数 Benchmark():
+ * 在合成地形上记录光栅化耗时，比较标量/SIMD 与单线程/并行结果，
+ * 并以逐像素的精确测试为参照检查 Hi-Z 测试从不剔除精确测试判定为可见的包围盒。
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "nclgl/Matrix4.h"
+#include "nclgl/Vector3.h"
+#include "nclgl/Vector4.h"
+
+namespace Engine::IAL {
+    class I_Heightmap;
+}
+
+class OcclusionCuller {
+public:
+    static constexpr int kDepthWidth = 256;
+    static constexpr int kDepthHeight = 128;
+
+    OcclusionCuller();
+
+    void SetTerrain(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap);
+    void BeginFrame(const Matrix4& viewProj);
+    void AddOccluderBox(const Matrix4& model, const Vector3& localMin, const Vector3& localMax);
+    void Rasterize();
+
+    bool IsVisible(const Vector3& worldMin, const Vector3& worldMax) const;
+
+    std::size_t GetOccluderTriangleCount() const { return m_triangles.size(); }
+    float GetRasterMs() const { return m_rasterMs; }
+
+    static void Benchmark();
+
+private:
+    struct ScreenTriangle {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        float depthA;
+        float depthB;
+        float depthC;
+    };
+
+    struct TerrainChunk {
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+        int cellX0;
+        int cellZ0;
+        int cellX1;
+        int cellZ1;
+    };
+
+    void AddTriangle(const Vector4& a, const Vector4& b, const Vector4& c);
+    void AddClippedTriangle(const Vector4* vertices, int count);
+    void SetupTriangle(const Vector3& a, const Vector3& b, const Vector3& c);
+    void RasterizeTiles(bool parallel, bool useSimd);
+    void RasterizeTile(int tileX, int tileY, bool useSimd);
+    void BuildHierarchy();
+    bool ProjectBounds(const Vector3& worldMin, const Vector3& worldMax,
+                       int& x0, int& y0, int& x1, int& y1, float& nearestDepth, bool& straddlesNear) const;
+    bool IsVisibleExact(const Vector3& worldMin, const Vector3& worldMax) const;
+
+    Matrix4 m_viewProj;
+    std::vector<ScreenTriangle> m_triangles;
+    std::vector<std::vector<float>> m_levels;
+    std::vector<int> m_levelWidths;
+    std::vector<int> m_levelHeights;
+    int m_terrainGrid;
+    std::vector<Vector3> m_terrainVertices;
+    std::vector<TerrainChunk> m_terrainChunks;
+    float m_rasterMs;
+};
\ No newline at end of file
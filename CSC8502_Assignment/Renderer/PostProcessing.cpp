@@ -80,7 +80,10 @@ void PostProcessing::PresentToViewport(OutputMode mode,
         return;
     }
 
-    ProcessBloom();
+    // 原始场景输出不使用泛光，四分屏的调试视口因此省去提取与模糊
+    if (mode != OutputMode::RawScene) {
+        ProcessBloom();
+    }
     auto bloomTexture = m_cachedBloomTexture;
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
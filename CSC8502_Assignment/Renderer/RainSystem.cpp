@@ -141,7 +141,12 @@ void RainSystem::Update(float deltaTime,
     std::uniform_real_distribution<float> offsetDist(-m_horizontalExtent, m_horizontalExtent);
     std::uniform_real_distribution<float> speedDist(m_minSpeed, m_maxSpeed);
 
-    for (std::size_t i = 0; i < m_particles.size(); ++i) {
+    const std::size_t particleCount = m_particles.size();
+    m_queryX.resize(particleCount);
+    m_queryZ.resize(particleCount);
+    m_terrainHeights.assign(particleCount, 0.0f);
+
+    for (std::size_t i = 0; i < particleCount; ++i) {
         auto& particle = m_particles[i];
         particle.position.y -= particle.speed * deltaTime;
 
@@ -165,11 +170,18 @@ void RainSystem::Update(float deltaTime,
             dz += boxSize;
         }
 
-        float terrainHeight = 0.0f;
-        if (heightmap) {
-            terrainHeight = heightmap->SampleHeight(particle.position.x, particle.position.z);
-        }
-        const float lowerBound = std::max(terrainHeight, waterHeight);
+        m_queryX[i] = particle.position.x;
+        m_queryZ[i] = particle.position.z;
+    }
+
+    // 所有粒子的地形高度一次批量查询，而不是每个粒子一次虚调用。
+    if (heightmap) {
+        heightmap->SampleHeights(m_queryX, m_queryZ, m_terrainHeights);
+    }
+
+    for (std::size_t i = 0; i < particleCount; ++i) {
+        auto& particle = m_particles[i];
+        const float lowerBound = std::max(m_terrainHeights[i], waterHeight);
         if (particle.position.y <= lowerBound) {
             particle.position.x = cameraPosition.x + offsetDist(m_random);
             particle.position.z = cameraPosition.z + offsetDist(m_random);
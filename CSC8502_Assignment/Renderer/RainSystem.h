@@ -61,6 +61,9 @@ private:
     std::shared_ptr<Engine::IAL::I_Shader> m_shader;
     std::vector<Particle> m_particles;
     std::vector<Particle> m_gpuBuffer;
+    std::vector<float> m_queryX;
+    std::vector<float> m_queryZ;
+    std::vector<float> m_terrainHeights;
     std::mt19937 m_random;
     GLuint m_vao;
     GLuint m_vertexVbo;
@@ -13,6 +13,10 @@
 #include "Water.h"
 #include "GrassField.h"
 #include "RainSystem.h"
+#include "Frustum.h"
+#include "OcclusionCuller.h"
+#include "LightClusterer.h"
+#include "TerrainHorizon.h"
 #include "../Core/Camera.h"
 #include "../Core/TerrainConfig.h"
 #include "../Engine/IAL/I_FrameBuffer.h"
@@ -26,6 +30,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include "nclgl/Vector2.h"
@@ -47,12 +52,16 @@ Renderer::Renderer(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factor
     , m_waterShader(nullptr)
     , m_shadowShader(nullptr)
     , m_skinnedShader(nullptr)
+    , m_sceneInstancedShader(nullptr)
+    , m_terrainInstancedShader(nullptr)
+    , m_shadowInstancedShader(nullptr)
     , m_skyboxTexture(nullptr)
     , m_skyboxMesh(nullptr)
     , m_waterReflectionFBO(nullptr)
     , m_waterRefractionFBO(nullptr)
     , m_shadowMap(nullptr)
     , m_water(nullptr)
+    , m_lightClusterer(std::make_unique<LightClusterer>())
     , m_directionalLight{}
     , m_sceneColour(Vector3(0.0f, 0.0f, 0.0f))
     , m_specularPower(32.0f)
@@ -62,11 +71,50 @@ Renderer::Renderer(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factor
     , m_surfaceHeight(height)
     , m_transitionEnabled(false)
     , m_transitionProgress(0.0f)
-    , m_shadowMatrix()
+    , m_shadowCascadeStats()
     , m_reflectionViewProj()
+    , m_splitReflectionViewProj()
     , m_shadowStrength(0.65f)
     , m_bonePaletteBuffer(0)
     , m_boneCapacity(0)
+    , m_instanceBuffer(0)
+    , m_instanceCapacity(0)
+    , m_clusterLightBuffer(0)
+    , m_clusterLightCapacity(0)
+    , m_clusterRangeBuffer(0)
+    , m_clusterRangeCapacity(0)
+    , m_clusterIndexBuffer(0)
+    , m_clusterIndexCapacity(0)
+    , m_terrainTimer()
+    , m_terrainTimedThisFrame(false)
+    , m_reflectionTimer()
+    , m_refractionTimer()
+    , m_shadowPrefilterTimer()
+    , m_waterRefractionSource(WaterRefractionSource::SceneCopy)
+    , m_sceneCopyFBO()
+    , m_waterAbsorption(0.015f)
+    , m_waterReflectionScale(0.5f)
+    , m_waterRefractionScale(0.5f)
+    , m_reflectionRefreshInterval(2)
+    , m_waterVisibilityGate(true)
+    , m_reflectionReusable(false)
+    , m_reflectionAge(0)
+    , m_reflectionCameraPosition()
+    , m_reflectionCameraYaw(0.0f)
+    , m_reflectionCameraPitch(0.0f)
+    , m_reflectionRefreshedThisFrame(false)
+    , m_waterViewsSkipped(0)
+    , m_currentViewport(0)
+    , m_occlusionCuller(std::make_unique<OcclusionCuller>())
+    , m_occlusionCullingEnabled(true)
+    , m_occlusionActive(false)
+    , m_occlusionTested(0)
+    , m_occlusionCulled(0)
+    , m_terrainHorizon(std::make_unique<TerrainHorizon>())
+    , m_horizonCullingEnabled(true)
+    , m_horizonActive(false)
+    , m_horizonCulled(0)
+    , m_waterPlaneCulled(0)
     , m_environmentIntensity(1.0f)
     , m_environmentMaxLod(5.0f)
     , m_activeHeightmap(nullptr)
@@ -78,7 +126,15 @@ Renderer::Renderer(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factor
     , m_rainEnabled(false)
     , m_viewLayout(ViewLayoutMode::Single)
     , m_defaultViewMode(RenderDebugMode::Standard)
-    , m_splitCameras() {
+    , m_splitCameras()
+    , m_splitViewWaterMode(SplitViewWaterMode::SharePrimary)
+    , m_sceneSubmissions(0)
+    , m_viewportStats{}
+    , m_viewportCpuStart{}
+    , m_viewportCulledStart{}
+    , m_viewportTimerQueries{}
+    , m_viewportTimerPending{}
+    , m_viewportTimerFrame(0) {
     if (m_factory) {
         m_sceneShader = m_factory->CreateShader("Shared/basic.vert", "Shared/basic.frag");
         m_terrainShader = m_factory->CreateShader("Shared/terrain.vert", "Shared/terrain.frag");
@@ -86,9 +142,12 @@ Renderer::Renderer(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factor
         m_waterShader = m_factory->CreateShader("Shared/water.vert", "Shared/water.frag");
         m_shadowShader = m_factory->CreateShader("Shared/shadow.vert", "Shared/shadow.frag");
         m_skinnedShader = m_factory->CreateShader("Shared/skinning.vert", "Shared/skinning.frag");
+        m_sceneInstancedShader = m_factory->CreateShader("Shared/basic_instanced.vert", "Shared/basic.frag");
+        m_terrainInstancedShader = m_factory->CreateShader("Shared/terrain_instanced.vert", "Shared/terrain.frag");
+        m_shadowInstancedShader = m_factory->CreateShader("Shared/shadow_instanced.vert", "Shared/shadow.frag");
         m_skyboxMesh = m_factory->LoadMesh("../Meshes/cube.gltf");
         m_postProcessing = std::make_shared<PostProcessing>(m_factory, width, height);
-        m_shadowMap = std::make_shared<ShadowMap>(m_factory, 2048, 2048);
+        m_shadowMap = std::make_shared<ShadowMap>(m_factory, 2048);
     }
     if (m_factory) {
         m_rainSystem = std::make_unique<RainSystem>(m_factory, 2000, 240.0f, 160.0f);
@@ -102,8 +161,8 @@ Renderer::Renderer(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factor
 
     UpdateSplitViewCameras();
 
-    m_shadowMatrix.ToIdentity();
     m_reflectionViewProj.ToIdentity();
+    m_splitReflectionViewProj.ToIdentity();
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 }
 
@@ -113,6 +172,24 @@ Renderer::~Renderer() {
         m_bonePaletteBuffer = 0;
         m_boneCapacity = 0;
     }
+    if (m_instanceBuffer != 0) {
+        glDeleteBuffers(1, &m_instanceBuffer);
+        m_instanceBuffer = 0;
+        m_instanceCapacity = 0;
+    }
+    for (unsigned int* buffer : { &m_clusterLightBuffer, &m_clusterRangeBuffer, &m_clusterIndexBuffer }) {
+        if (*buffer != 0) {
+            glDeleteBuffers(1, buffer);
+            *buffer = 0;
+        }
+    }
+    ReleaseGpuTimer(m_terrainTimer);
+    ReleaseGpuTimer(m_reflectionTimer);
+    ReleaseGpuTimer(m_refractionTimer);
+    ReleaseGpuTimer(m_shadowPrefilterTimer);
+    if (m_viewportTimerQueries[0] != 0) {
+        glDeleteQueries(static_cast<GLsizei>(m_viewportTimerQueries.size()), m_viewportTimerQueries.data());
+    }
 }
 
 void Renderer::Render(float deltaTime) {
@@ -130,8 +207,27 @@ void Renderer::Render(float deltaTime) {
     const float cameraYaw = m_camera ? m_camera->GetYaw() : 0.0f;
     const float cameraPitch = m_camera ? m_camera->GetPitch() : 0.0f;
 
+    // 渲染队列与实例批次与视角无关，每帧只收集一次，阴影、水面与各视口的场景通道共用
+    PrepareFrameQueue();
     UpdateAnimatedMeshes(deltaTime);
     m_timeAccumulator += deltaTime;
+    m_terrainTimedThisFrame = false;
+    m_reflectionRefreshedThisFrame = false;
+    m_waterViewsSkipped = 0;
+    m_currentViewport = 0;
+    m_occlusionTested = 0;
+    m_occlusionCulled = 0;
+    m_horizonCulled = 0;
+    m_waterPlaneCulled = 0;
+    if (m_activeHeightmap) {
+        m_activeHeightmap->UpdateStreaming(cameraPosition);
+    }
+    if (m_grassField) {
+        m_grassField->ResetFrameStats();
+        if (m_grassEnabled) {
+            m_grassField->Update(cameraPosition);
+        }
+    }
 
     if (m_rainSystem && m_rainEnabled) {
         float waterLevel = m_water ? m_water->GetHeight() : 0.0f;
@@ -144,38 +240,10 @@ void Renderer::Render(float deltaTime) {
     }
 
 
-    Matrix4 lightMatrix;
-    lightMatrix.ToIdentity();
-    if (m_shadowMap && m_shadowShader) {
-        const Vector3 focusPoint = GetSceneFocusPoint();
-        const float shadowNear = 1.0f;
-        const float shadowFar = 1000.0f;
-        const float orthoSize = 512.0f;
-        m_shadowMap->UpdateLight(m_directionalLight.position,
-                                 focusPoint,
-                                 shadowNear,
-                                 shadowFar,
-                                 orthoSize);
-        m_shadowMap->BeginCapture();
-        GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
-        GLint previousCull = GL_BACK;
-        if (cullEnabled) {
-            glGetIntegerv(GL_CULL_FACE_MODE, &previousCull);
-        }
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_FRONT);
-        RenderSceneForShadowMap(m_shadowMap->GetLightViewProjection(), true);
-        if (cullEnabled) {
-            glCullFace(previousCull);
-        }
-        else {
-            glDisable(GL_CULL_FACE);
-        }
-        m_shadowMap->EndCapture();
-        glViewport(0, 0, m_surfaceWidth, m_surfaceHeight);
-        lightMatrix = m_shadowMap->GetLightViewProjection();
-    }
-    m_shadowMatrix = lightMatrix;
+    const Matrix4 cameraView = m_camera ? m_camera->BuildViewMatrix()
+                                        : Matrix4::BuildViewMatrix(defaultCameraPos,
+                                                                   defaultCameraPos + Vector3(0.0f, 0.0f, -1.0f));
+    RenderShadowCascades(cameraView);
 
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -188,6 +256,7 @@ void Renderer::Render(float deltaTime) {
     else {
         RenderQuadView(deltaTime);
     }
+    m_viewportTimerFrame = (m_viewportTimerFrame + 1) % kViewportTimerFrames;
     RenderDebugUI();
 }
 
@@ -202,15 +271,39 @@ void Renderer::SetWater(const std::shared_ptr<Water>& water) {
     if (!m_water) {
         m_waterReflectionFBO.reset();
         m_waterRefractionFBO.reset();
+        m_sceneCopyFBO.reset();
         SetTerrainHeightmap(m_activeHeightmap);
         return;
     }
-    m_waterReflectionFBO = m_factory->CreatePostProcessFBO(m_surfaceWidth, m_surfaceHeight);
-    m_waterRefractionFBO = m_factory->CreatePostProcessFBO(m_surfaceWidth, m_surfaceHeight);
+    RecreateWaterTargets();
     SetTerrainHeightmap(m_activeHeightmap);
     UpdateSplitViewCameras();
 }
 
+void Renderer::RecreateWaterTargets() {
+    m_reflectionReusable = false;
+    if (!m_factory || !m_water) {
+        return;
+    }
+    m_waterReflectionFBO = m_factory->CreatePostProcessFBO(
+        std::max(1, static_cast<int>(m_surfaceWidth * m_waterReflectionScale)),
+        std::max(1, static_cast<int>(m_surfaceHeight * m_waterReflectionScale)));
+    // 两种折射来源只分配各自需要的目标；拷贝目标必须与主 FBO 同尺寸才能 blit 深度
+    m_waterRefractionFBO.reset();
+    m_sceneCopyFBO.reset();
+    if (m_waterRefractionSource == WaterRefractionSource::SceneCopy) {
+        m_sceneCopyFBO = m_factory->CreatePostProcessFBO(m_surfaceWidth, m_surfaceHeight);
+    }
+    else {
+        m_waterRefractionFBO = m_factory->CreatePostProcessFBO(
+            std::max(1, static_cast<int>(m_surfaceWidth * m_waterRefractionScale)),
+            std::max(1, static_cast<int>(m_surfaceHeight * m_waterRefractionScale)));
+    }
+    // 调试视口的半分辨率水面纹理在首次需要时创建
+    m_splitWaterReflectionFBO.reset();
+    m_splitWaterRefractionFBO.reset();
+}
+
 void Renderer::SetSkyboxTexture(const std::shared_ptr<Engine::IAL::I_Texture>& texture) {
     m_skyboxTexture = texture;
 }
@@ -224,7 +317,7 @@ void Renderer::SetDirectionalLight(const Light& light) {
 }
 
 void Renderer::SetPointLights(const std::vector<Light>& lights) {
-    m_pointLights = lights;
+    m_lightClusterer->SetLights(lights);
 }
 
 void Renderer::SetTransitionState(bool enabled, float progress) {
@@ -234,20 +327,17 @@ void Renderer::SetTransitionState(bool enabled, float progress) {
 
 void Renderer::SetTerrainHeightmap(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap) {
     m_activeHeightmap = heightmap;
-    UpdateViewRangeFromTerrain();
-    if (!m_factory) {
-        m_grassField.reset();
-        return;
+    if (!m_activeHeightmap) {
+        // 地形被释放时不再为之前的高度图保留草地，缓存条目会一直持有它们
+        m_grassFieldCache.clear();
     }
-    if (!m_activeHeightmap || !m_grassEnabled) {
-        m_grassField.reset();
+    m_occlusionCuller->SetTerrain(heightmap);
+    m_terrainHorizon->SetTerrain(heightmap);
+    UpdateViewRangeFromTerrain();
+    RefreshGrassField();
+    if (!m_factory || !m_activeHeightmap || !m_grassEnabled) {
         return;
     }
-    const float waterHeight = m_water ? m_water->GetHeight() : 0.0f;
-    m_grassField = std::make_unique<GrassField>(m_factory, m_activeHeightmap, waterHeight);
-    if (m_grassField) {
-        m_grassField->SetBaseColorTexture(m_grassBaseTextureOverride);
-    }
     UpdateSplitViewCameras();
 }
 
@@ -256,17 +346,33 @@ void Renderer::SetGrassEnabled(bool enabled) {
         return;
     }
     m_grassEnabled = enabled;
-    if (!m_grassEnabled) {
+    RefreshGrassField();
+}
+
+void Renderer::RefreshGrassField() {
+    if (!m_factory || !m_activeHeightmap || !m_grassEnabled) {
         m_grassField.reset();
         return;
     }
-    if (m_factory && m_activeHeightmap) {
-        const float waterHeight = m_water ? m_water->GetHeight() : 0.0f;
-        m_grassField = std::make_unique<GrassField>(m_factory, m_activeHeightmap, waterHeight);
-        if (m_grassField) {
-            m_grassField->SetBaseColorTexture(m_grassBaseTextureOverride);
-        }
-    }
+    // 最近使用的 kGrassFieldCacheSize 张高度图各保留一个 GrassField（LRU）：在两个场景间切换或重新启用草地时
+    // 沿用已流入的草块，更早的高度图连同其草块一起释放。构造本身不生成任何草块，因此即使缓存未命中也不会卡顿。
+    const float waterHeight = m_water ? m_water->GetHeight() : 0.0f;
+    auto cached = std::find_if(m_grassFieldCache.begin(), m_grassFieldCache.end(),
+        [this](const std::shared_ptr<GrassField>& field) { return field->GetHeightmap() == m_activeHeightmap; });
+    std::shared_ptr<GrassField> field;
+    if (cached != m_grassFieldCache.end()) {
+        field = *cached;
+        m_grassFieldCache.erase(cached);
+    }
+    if (!field || field->GetWaterHeight() != waterHeight) {
+        field = std::make_shared<GrassField>(m_factory, m_activeHeightmap, waterHeight);
+    }
+    m_grassFieldCache.insert(m_grassFieldCache.begin(), field);
+    if (m_grassFieldCache.size() > kGrassFieldCacheSize) {
+        m_grassFieldCache.resize(kGrassFieldCacheSize);
+    }
+    m_grassField = field;
+    m_grassField->SetBaseColorTexture(m_grassBaseTextureOverride);
 }
 
 void Renderer::SetGrassBaseTexture(const std::shared_ptr<Engine::IAL::I_Texture>& texture) {
@@ -289,6 +395,22 @@ void Renderer::ToggleMultiViewLayout() {
     UpdateSplitViewCameras();
 }
 
+void Renderer::SetSplitViewWaterMode(SplitViewWaterMode mode) {
+    m_splitViewWaterMode = mode;
+    if (mode != SplitViewWaterMode::ReducedResolution) {
+        m_splitWaterReflectionFBO.reset();
+        m_splitWaterRefractionFBO.reset();
+    }
+}
+
+void Renderer::SetWaterRefractionSource(WaterRefractionSource source) {
+    if (source == m_waterRefractionSource) {
+        return;
+    }
+    m_waterRefractionSource = source;
+    RecreateWaterTargets();
+}
+
 void Renderer::OnSurfaceResized(int width, int height) {
     if (width <= 0 || height <= 0) {
         return;
@@ -310,9 +432,7 @@ void Renderer::UpdateAnimatedMeshes(float deltaTime) {
     if (!m_sceneGraph) {
         return;
     }
-    std::vector<std::shared_ptr<SceneNode>> nodes;
-    m_sceneGraph->CollectRenderableNodes(nodes);
-    for (const auto& node : nodes) {
+    for (const auto& node : m_frameNodes) {
         if (!node) {
             continue;
         }
@@ -327,13 +447,119 @@ void Renderer::UpdateAnimatedMeshes(float deltaTime) {
     }
 }
 
+void Renderer::RenderShadowCascades(const Matrix4& cameraView) {
+    for (auto& stats : m_shadowCascadeStats) {
+        stats = ShadowCascadeStats{};
+    }
+    if (!m_shadowMap || !m_shadowShader) {
+        return;
+    }
+    // 光线方向沿用光源位置指向场景中心，与旧的单张阴影贴图一致
+    const Vector3 lightDirection = GetSceneFocusPoint() - m_directionalLight.position;
+    const float aspect = static_cast<float>(std::max(1, m_surfaceWidth)) / static_cast<float>(std::max(1, m_surfaceHeight));
+    m_shadowMap->UpdateCascades(lightDirection, cameraView, kFieldOfView, aspect, m_nearPlane);
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    GLint previousCull = GL_BACK;
+    if (cullEnabled) {
+        glGetIntegerv(GL_CULL_FACE_MODE, &previousCull);
+    }
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+    const int cascadeCount = m_shadowMap->GetCascadeCount();
+    if (m_shadowMap->IsStaticCaching()) {
+        // 只重绘缓存失效的级联的静态投射体，随后在拷贝上叠加动态投射体
+        const std::uint64_t signature = ComputeStaticShadowSignature();
+        bool staticBound = false;
+        for (int i = 0; i < cascadeCount; ++i) {
+            if (!m_shadowMap->PrepareStaticCascade(i, signature)) {
+                continue;
+            }
+            if (!staticBound) {
+                m_shadowMap->BeginStaticCapture();
+                staticBound = true;
+            }
+            m_shadowMap->BeginStaticCascade(i);
+            RenderSceneForShadowMap(m_shadowMap->GetCascadeViewProjection(i), true,
+                                    m_shadowCascadeStats[static_cast<std::size_t>(i)], ShadowCasterSet::Static);
+        }
+        m_shadowMap->BeginCapture();
+        for (int i = 0; i < cascadeCount; ++i) {
+            m_shadowMap->BeginCascade(i);
+            RenderSceneForShadowMap(m_shadowMap->GetCascadeViewProjection(i), true,
+                                    m_shadowCascadeStats[static_cast<std::size_t>(i)], ShadowCasterSet::Dynamic);
+        }
+    }
+    else {
+        m_shadowMap->BeginCapture();
+        for (int i = 0; i < cascadeCount; ++i) {
+            m_shadowMap->BeginCascade(i);
+            RenderSceneForShadowMap(m_shadowMap->GetCascadeViewProjection(i), true,
+                                    m_shadowCascadeStats[static_cast<std::size_t>(i)]);
+        }
+    }
+    if (cullEnabled) {
+        glCullFace(previousCull);
+    }
+    else {
+        glDisable(GL_CULL_FACE);
+    }
+    m_shadowMap->EndCapture();
+    if (m_shadowMap->GetShaderFilterMode() != 0) {
+        const bool timePrefilter = BeginGpuTimer(m_shadowPrefilterTimer);
+        m_shadowMap->Prefilter();
+        if (timePrefilter) {
+            EndGpuTimer(m_shadowPrefilterTimer);
+        }
+    }
+    glViewport(0, 0, m_surfaceWidth, m_surfaceHeight);
+}
+
+std::uint64_t Renderer::ComputeStaticShadowSignature() const {
+    // FNV-1a：覆盖静态节点的增删、网格替换、变换以及流式地形的常驻瓦片变化
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, std::size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    const auto waterNode = m_water ? m_water->GetNode() : nullptr;
+    for (const auto& node : m_frameNodes) {
+        if (!node || node == waterNode) {
+            continue;
+        }
+        const auto& mesh = node->GetMesh();
+        if (!mesh || std::dynamic_pointer_cast<Engine::IAL::I_AnimatedMesh>(mesh)) {
+            continue;
+        }
+        const Engine::IAL::I_Mesh* meshPointer = mesh.get();
+        const std::size_t triangles = mesh->GetTriangleCount();
+        const Matrix4 transform = node->GetWorldTransform();
+        mix(&meshPointer, sizeof(meshPointer));
+        mix(&triangles, sizeof(triangles));
+        mix(transform.values, sizeof(transform.values));
+    }
+    return hash;
+}
+
+void Renderer::AccumulateDepthFetch(const Engine::IAL::I_Mesh& mesh,
+                                    std::size_t instances,
+                                    ShadowCascadeStats& stats) {
+    const std::size_t depthBytes = mesh.GetVertexFetchBytes(true) * instances;
+    const std::size_t fullBytes = mesh.GetVertexFetchBytes(false) * instances;
+    stats.vertexBytes += depthBytes;
+    stats.vertexBytesSaved += fullBytes > depthBytes ? fullBytes - depthBytes : 0;
+}
+
 void Renderer::RenderSceneForShadowMap(const Matrix4& lightViewProjection,
-                                       bool skipWaterNode) {
+                                       bool skipWaterNode,
+                                       ShadowCascadeStats& stats,
+                                       ShadowCasterSet casters) {
     if (!m_sceneGraph || !m_shadowShader) {
         return;
     }
-    m_renderQueue.clear();
-    m_sceneGraph->CollectRenderableNodes(m_renderQueue);
+    // 每个级联只提交与自己光源视锥相交的投射体
+    const Frustum lightFrustum = Frustum::FromViewProjection(lightViewProjection);
     m_shadowShader->Bind();
     m_shadowShader->SetUniform("uLightViewProj", lightViewProjection);
     for (const auto& node : m_renderQueue) {
@@ -348,6 +574,20 @@ void Renderer::RenderSceneForShadowMap(const Matrix4& lightViewProjection,
             continue;
         }
         auto animatedMesh = std::dynamic_pointer_cast<Engine::IAL::I_AnimatedMesh>(mesh);
+        if ((casters == ShadowCasterSet::Static && animatedMesh) ||
+            (casters == ShadowCasterSet::Dynamic && !animatedMesh)) {
+            continue;
+        }
+        Matrix4 modelMatrix = node->GetWorldTransform();
+        if (animatedMesh) {
+            modelMatrix = modelMatrix * animatedMesh->GetRootTransform();
+        }
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+        if (mesh->GetLocalBounds(boundsMin, boundsMax) && !lightFrustum.IntersectsBox(modelMatrix, boundsMin, boundsMax)) {
+            ++stats.culled;
+            continue;
+        }
         int boneCount = 0;
         if (animatedMesh) {
             const auto& bones = animatedMesh->GetBoneTransforms();
@@ -358,15 +598,55 @@ void Renderer::RenderSceneForShadowMap(const Matrix4& lightViewProjection,
             UnbindBonePalette();
         }
         m_shadowShader->SetUniform("uBoneCount", boneCount);
-        Matrix4 modelMatrix = node->GetWorldTransform();
-        if (animatedMesh) {
-            modelMatrix = modelMatrix * animatedMesh->GetRootTransform();
-        }
         m_shadowShader->SetUniform("uModel", modelMatrix);
-        mesh->Draw();
+        mesh->DrawDepth();
+        ++stats.draws;
+        stats.triangles += mesh->GetTriangleCount();
+        AccumulateDepthFetch(*mesh, 1, stats);
     }
     UnbindBonePalette();
+    // 实例化批次不含动画网格，全部属于静态投射体
+    if (casters == ShadowCasterSet::Dynamic) {
+        m_shadowShader->Unbind();
+        return;
+    }
+    // 没有实例化阴影着色器时，帧队列中的批次逐个实例回退到普通阴影着色器
+    if (!m_shadowInstancedShader) {
+        m_shadowShader->SetUniform("uBoneCount", 0);
+        for (const auto& batch : m_instanceBatches) {
+            for (const auto& transform : batch.transforms) {
+                if (batch.hasBounds && !lightFrustum.IntersectsBox(transform, batch.boundsMin, batch.boundsMax)) {
+                    ++stats.culled;
+                    continue;
+                }
+                m_shadowShader->SetUniform("uModel", transform);
+                batch.mesh->DrawDepth();
+                ++stats.draws;
+                stats.triangles += batch.mesh->GetTriangleCount();
+                AccumulateDepthFetch(*batch.mesh, 1, stats);
+            }
+        }
+    }
     m_shadowShader->Unbind();
+
+    if (m_instanceBatches.empty() || !m_shadowInstancedShader) {
+        return;
+    }
+    m_shadowInstancedShader->Bind();
+    m_shadowInstancedShader->SetUniform("uLightViewProj", lightViewProjection);
+    for (const auto& batch : m_instanceBatches) {
+        const std::size_t visible = CullInstances(batch, lightFrustum);
+        stats.culled += batch.transforms.size() - visible;
+        if (visible == 0) {
+            continue;
+        }
+        UploadInstanceMatrices(m_visibleInstances);
+        batch.mesh->DrawDepthInstanced(static_cast<int>(visible));
+        ++stats.draws;
+        stats.triangles += batch.mesh->GetTriangleCount() * visible;
+        AccumulateDepthFetch(*batch.mesh, visible, stats);
+    }
+    m_shadowInstancedShader->Unbind();
 }
 
 void Renderer::RenderSingleView(float /*deltaTime*/) {
@@ -377,7 +657,10 @@ void Renderer::RenderSingleView(float /*deltaTime*/) {
         cameraToUse->SetYaw(0.0f);
         cameraToUse->SetPitch(0.0f);
     }
-    RenderViewInternal(cameraToUse, m_defaultViewMode, 0, 0, m_surfaceWidth, m_surfaceHeight, true);
+    BeginViewportStats(0, SplitViewWaterMode::Full);
+    RenderViewInternal(cameraToUse, m_defaultViewMode, 0, 0, m_surfaceWidth, m_surfaceHeight, true,
+                       SplitViewWaterMode::Full);
+    EndViewportStats(0);
 }
 
 void Renderer::RenderQuadView(float /*deltaTime*/) {
@@ -395,12 +678,175 @@ void Renderer::RenderQuadView(float /*deltaTime*/) {
         primary->SetPitch(0.0f);
     }
 
-    RenderViewInternal(primary, m_defaultViewMode, 0, halfHeight, halfWidth, topHeight, true);
-    RenderViewInternal(m_splitCameras[0], RenderDebugMode::Wireframe, halfWidth, halfHeight, std::max(1, rightWidth),
-                       topHeight, false);
-    RenderViewInternal(m_splitCameras[1], RenderDebugMode::Normal, 0, 0, halfWidth, halfHeight, false);
-    RenderViewInternal(m_splitCameras[2], RenderDebugMode::Bloom, halfWidth, 0, std::max(1, rightWidth), halfHeight,
-                       false);
+    // 主视口先渲染，调试视口才能复用它的水面纹理与反射矩阵
+    BeginViewportStats(0, SplitViewWaterMode::Full);
+    RenderViewInternal(primary, m_defaultViewMode, 0, halfHeight, halfWidth, topHeight, true,
+                       SplitViewWaterMode::Full);
+    EndViewportStats(0);
+
+    struct SplitViewport {
+        RenderDebugMode mode;
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+    const std::array<SplitViewport, 3> splitViewports = { {
+        { RenderDebugMode::Wireframe, halfWidth, halfHeight, std::max(1, rightWidth), topHeight },
+        { RenderDebugMode::Normal, 0, 0, halfWidth, halfHeight },
+        { RenderDebugMode::Bloom, halfWidth, 0, std::max(1, rightWidth), halfHeight },
+    } };
+    for (std::size_t i = 0; i < splitViewports.size(); ++i) {
+        const SplitViewport& viewport = splitViewports[i];
+        BeginViewportStats(i + 1, m_splitViewWaterMode);
+        RenderViewInternal(m_splitCameras[i], viewport.mode, viewport.x, viewport.y, viewport.width, viewport.height,
+                           false, m_splitViewWaterMode);
+        EndViewportStats(i + 1);
+    }
+}
+
+Renderer::WaterTargets Renderer::ResolveWaterTargets(SplitViewWaterMode waterMode) {
+    WaterTargets targets;
+    targets.reflection = m_waterReflectionFBO;
+    targets.refraction = m_waterRefractionFBO;
+    targets.reflectionViewProj = &m_reflectionViewProj;
+    targets.reflectionWidth = std::max(1, static_cast<int>(m_surfaceWidth * m_waterReflectionScale));
+    targets.reflectionHeight = std::max(1, static_cast<int>(m_surfaceHeight * m_waterReflectionScale));
+    targets.refractionWidth = std::max(1, static_cast<int>(m_surfaceWidth * m_waterRefractionScale));
+    targets.refractionHeight = std::max(1, static_cast<int>(m_surfaceHeight * m_waterRefractionScale));
+    if (m_waterRefractionSource == WaterRefractionSource::SceneCopy) {
+        // 拷贝在每个视图的主通道内生成，调试视口的水面模式只影响反射
+        targets.refraction = m_sceneCopyFBO;
+        targets.refractionWidth = m_surfaceWidth;
+        targets.refractionHeight = m_surfaceHeight;
+        targets.refractionFromScene = true;
+    }
+    if (waterMode != SplitViewWaterMode::ReducedResolution || !m_water || !m_factory) {
+        return targets;
+    }
+    // 调试视口使用主视口目标一半的分辨率
+    const int reflectionWidth = std::max(1, targets.reflectionWidth / 2);
+    const int reflectionHeight = std::max(1, targets.reflectionHeight / 2);
+    const int refractionWidth = std::max(1, targets.refractionWidth / 2);
+    const int refractionHeight = std::max(1, targets.refractionHeight / 2);
+    if (!m_splitWaterReflectionFBO) {
+        m_splitWaterReflectionFBO = m_factory->CreatePostProcessFBO(reflectionWidth, reflectionHeight);
+    }
+    if (!targets.refractionFromScene && !m_splitWaterRefractionFBO) {
+        m_splitWaterRefractionFBO = m_factory->CreatePostProcessFBO(refractionWidth, refractionHeight);
+    }
+    if (m_splitWaterReflectionFBO) {
+        targets.reflection = m_splitWaterReflectionFBO;
+        targets.reflectionViewProj = &m_splitReflectionViewProj;
+        targets.reflectionWidth = reflectionWidth;
+        targets.reflectionHeight = reflectionHeight;
+    }
+    if (!targets.refractionFromScene && m_splitWaterRefractionFBO) {
+        targets.refraction = m_splitWaterRefractionFBO;
+        targets.refractionWidth = refractionWidth;
+        targets.refractionHeight = refractionHeight;
+    }
+    return targets;
+}
+
+void Renderer::CopySceneForRefraction(const WaterTargets& targets) {
+    if (!targets.refraction) {
+        return;
+    }
+    // 主 FBO 正处于绑定状态，不能同时作为纹理采样，因此把颜色与深度 blit 到同尺寸的拷贝目标
+    GLint sceneFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &sceneFramebuffer);
+    targets.refraction->Bind();
+    GLint copyFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &copyFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(sceneFramebuffer));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(copyFramebuffer));
+    glBlitFramebuffer(0, 0, targets.refractionWidth, targets.refractionHeight,
+                      0, 0, targets.refractionWidth, targets.refractionHeight,
+                      GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(sceneFramebuffer));
+}
+
+bool Renderer::IsWaterVisible(const Matrix4& viewProj, const Vector3& cameraPosition, bool occlusion) {
+    Vector3 boundsMin;
+    Vector3 boundsMax;
+    if (!m_waterVisibilityGate || !m_water->GetWorldBounds(boundsMin, boundsMax)) {
+        return true;
+    }
+    if (!Frustum::FromViewProjection(viewProj).IntersectsAABB(boundsMin, boundsMax)) {
+        return false;
+    }
+    if (BeginHorizonPass(cameraPosition, nullptr) && !m_terrainHorizon->IsVisible(boundsMin, boundsMax)) {
+        return false;
+    }
+    return !occlusion || m_occlusionCuller->IsVisible(boundsMin, boundsMax);
+}
+
+bool Renderer::ShouldRefreshReflection(const WaterTargets& targets,
+                                       const Vector3& cameraPosition,
+                                       float cameraYaw,
+                                       float cameraPitch) {
+    // 只有主视口独占的反射纹理可以跨帧复用；其他视口写入同一纹理后必须重绘
+    if (m_currentViewport != 0 || targets.reflection != m_waterReflectionFBO) {
+        if (targets.reflection == m_waterReflectionFBO) {
+            m_reflectionReusable = false;
+        }
+        return true;
+    }
+    constexpr float kReuseDistance = 25.0f;
+    constexpr float kReuseAngle = 15.0f;
+    const bool jumped = (cameraPosition - m_reflectionCameraPosition).Length() > kReuseDistance ||
+                        std::abs(cameraYaw - m_reflectionCameraYaw) > kReuseAngle ||
+                        std::abs(cameraPitch - m_reflectionCameraPitch) > kReuseAngle;
+    if (m_reflectionReusable && !jumped && m_reflectionAge + 1 < m_reflectionRefreshInterval) {
+        ++m_reflectionAge;
+        return false;
+    }
+    m_reflectionReusable = true;
+    m_reflectionAge = 0;
+    m_reflectionCameraPosition = cameraPosition;
+    m_reflectionCameraYaw = cameraYaw;
+    m_reflectionCameraPitch = cameraPitch;
+    return true;
+}
+
+void Renderer::BeginViewportStats(std::size_t viewport, SplitViewWaterMode waterMode) {
+    if (m_viewportTimerQueries[0] == 0) {
+        glGenQueries(static_cast<GLsizei>(m_viewportTimerQueries.size()), m_viewportTimerQueries.data());
+    }
+    // 时间戳查询按帧轮换，读取的是 kViewportTimerFrames 帧前同一视口的结果，不会让 CPU 等待 GPU
+    const std::size_t slot = viewport * kViewportTimerFrames + m_viewportTimerFrame;
+    const unsigned int beginQuery = m_viewportTimerQueries[slot * 2];
+    const unsigned int endQuery = m_viewportTimerQueries[slot * 2 + 1];
+    if (m_viewportTimerPending[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(beginQuery, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(endQuery, GL_QUERY_RESULT, &end);
+            m_viewportStats[viewport].gpuMs = static_cast<float>(end - begin) * 1e-6f;
+        }
+        m_viewportTimerPending[slot] = false;
+    }
+    glQueryCounter(beginQuery, GL_TIMESTAMP);
+    m_viewportStats[viewport].water = waterMode;
+    m_currentViewport = viewport;
+    m_viewportCpuStart[viewport] = std::chrono::high_resolution_clock::now();
+    m_viewportCulledStart[viewport] = m_occlusionCulled + m_horizonCulled + m_waterPlaneCulled;
+    m_sceneSubmissions = 0;
+}
+
+void Renderer::EndViewportStats(std::size_t viewport) {
+    const std::size_t slot = viewport * kViewportTimerFrames + m_viewportTimerFrame;
+    glQueryCounter(m_viewportTimerQueries[slot * 2 + 1], GL_TIMESTAMP);
+    m_viewportTimerPending[slot] = true;
+    ViewportStats& stats = m_viewportStats[viewport];
+    stats.cpuMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() -
+                                                           m_viewportCpuStart[viewport]).count();
+    stats.submissions = m_sceneSubmissions;
+    stats.culled = m_occlusionCulled + m_horizonCulled + m_waterPlaneCulled - m_viewportCulledStart[viewport];
 }
 
 void Renderer::RenderViewInternal(const std::shared_ptr<Camera>& camera,
@@ -409,7 +855,8 @@ void Renderer::RenderViewInternal(const std::shared_ptr<Camera>& camera,
                                   int viewportY,
                                   int viewportWidth,
                                   int viewportHeight,
-                                  bool allowTransition) {
+                                  bool allowTransition,
+                                  SplitViewWaterMode waterMode) {
     if (!camera || !m_postProcessing) {
         return;
     }
@@ -417,15 +864,41 @@ void Renderer::RenderViewInternal(const std::shared_ptr<Camera>& camera,
     const int height = std::max(1, viewportHeight);
     const float aspect = static_cast<float>(width) / static_cast<float>(height);
     Matrix4 view = camera->BuildViewMatrix();
-    Matrix4 projection = Matrix4::Perspective(m_nearPlane, m_farPlane, aspect, 35.0f);
+    Matrix4 projection = Matrix4::Perspective(m_nearPlane, m_farPlane, aspect, kFieldOfView);
     const Vector3 cameraPosition = camera->GetPosition();
     const float cameraYaw = camera->GetYaw();
     const float cameraPitch = camera->GetPitch();
 
-    if (m_water && m_waterReflectionFBO && m_waterRefractionFBO) {
-        RenderReflectionPass(projection, cameraPosition, cameraYaw, cameraPitch);
-        RenderRefractionPass(view, projection, cameraPosition);
+    // 遮挡缓冲按本视图相机构建，只对同一相机的折射与主通道生效
+    const bool occlusion = BuildOcclusionBuffer(projection * view);
+    // 复用主视口的水面纹理时跳过反射与折射通道，m_reflectionViewProj 也保持主视口的值
+    const WaterTargets waterTargets = ResolveWaterTargets(waterMode);
+    const bool waterVisible = m_water && IsWaterVisible(projection * view, cameraPosition, occlusion);
+    if (m_water && !waterVisible) {
+        ++m_waterViewsSkipped;
+    }
+    if (waterVisible && waterTargets.reflection && waterTargets.refraction &&
+        waterMode != SplitViewWaterMode::SharePrimary) {
+        // 只统计主视口的水面通道耗时
+        const bool timed = m_currentViewport == 0;
+        if (ShouldRefreshReflection(waterTargets, cameraPosition, cameraYaw, cameraPitch)) {
+            const bool timeReflection = timed && BeginGpuTimer(m_reflectionTimer);
+            RenderReflectionPass(projection, cameraPosition, cameraYaw, cameraPitch, waterTargets);
+            if (timeReflection) {
+                EndGpuTimer(m_reflectionTimer);
+            }
+            m_reflectionRefreshedThisFrame = m_reflectionRefreshedThisFrame || timed;
+        }
+        if (!waterTargets.refractionFromScene) {
+            m_occlusionActive = occlusion;
+            const bool timeRefraction = timed && BeginGpuTimer(m_refractionTimer);
+            RenderRefractionPass(view, projection, cameraPosition, waterTargets);
+            if (timeRefraction) {
+                EndGpuTimer(m_refractionTimer);
+            }
+        }
     }
+    m_occlusionActive = occlusion;
 
     if (m_postProcessing) {
         m_postProcessing->BeginCapture();
@@ -441,8 +914,19 @@ void Renderer::RenderViewInternal(const std::shared_ptr<Camera>& camera,
     }
 
     RenderScenePass(view, projection, cameraPosition, true, mode);
+    m_occlusionActive = false;
     RenderGrass(view, projection, cameraPosition, mode);
-    RenderWaterSurface(view, projection, cameraPosition, mode);
+    if (waterVisible) {
+        if (waterTargets.refractionFromScene) {
+            // 此时主 FBO 只含不透明几何体与草地，正是水面之下可见的内容
+            const bool timeRefraction = m_currentViewport == 0 && BeginGpuTimer(m_refractionTimer);
+            CopySceneForRefraction(waterTargets);
+            if (timeRefraction) {
+                EndGpuTimer(m_refractionTimer);
+            }
+        }
+        RenderWaterSurface(view, projection, cameraPosition, mode, waterTargets);
+    }
     RenderRain(view, projection, cameraPosition, cameraYaw, cameraPitch, mode);
 
     RestorePolygonMode(mode, prevFront, prevBack);
@@ -558,19 +1042,20 @@ void Renderer::RenderScenePass(const Matrix4& view,
                                const Vector3& cameraPosition,
                                bool skipWaterNode,
                                RenderDebugMode mode,
-                               const Vector4* clipPlane) {
+                               const Vector4* clipPlane,
+                               bool hardwareClip) {
     if (!m_sceneGraph) {
         return;
     }
-    m_renderQueue.clear();
-    m_sceneGraph->CollectRenderableNodes(m_renderQueue);
-
-    const float fogDensity = GetFogDensity();
-    Vector3 fogColor = GetFogColor();
+    m_horizonActive = BeginHorizonPass(cameraPosition, clipPlane);
 
     Matrix4 viewProj = projection * view;
+    Frustum frustum = Frustum::FromViewProjection(viewProj);
     Vector4 clip(0.0f, 0.0f, 0.0f, 0.0f);
     if (clipPlane) {
+        frustum.SetNearPlane(*clipPlane);
+    }
+    if (clipPlane && hardwareClip) {
         clip = *clipPlane;
         glEnable(GL_CLIP_DISTANCE0);
     }
@@ -578,6 +1063,10 @@ void Renderer::RenderScenePass(const Matrix4& view,
         glDisable(GL_CLIP_DISTANCE0);
     }
 
+    auto shadowTexture = m_shadowMap ? m_shadowMap->GetDepthTexture() : nullptr;
+    const bool hasShadow = static_cast<bool>(shadowTexture);
+    UpdateLightClusters(view, projection);
+
     for (const auto& node : m_renderQueue) {
         if (!node) {
             continue;
@@ -594,8 +1083,18 @@ void Renderer::RenderScenePass(const Matrix4& view,
         if (animatedMesh) {
             modelMatrix = modelMatrix * animatedMesh->GetRootTransform();
         }
-        auto shadowTexture = m_shadowMap ? m_shadowMap->GetDepthTexture() : nullptr;
-        const bool hasShadow = static_cast<bool>(shadowTexture);
+        // 地形本身就是遮挡体，不参与遮挡查询
+        auto heightmap = std::dynamic_pointer_cast<Engine::IAL::I_Heightmap>(mesh);
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+        const bool hasBounds = mesh->GetLocalBounds(boundsMin, boundsMax);
+        if (clipPlane && hasBounds && !frustum.IntersectsBox(modelMatrix, boundsMin, boundsMax)) {
+            ++m_waterPlaneCulled;
+            continue;
+        }
+        if (!heightmap && hasBounds && !PassesOcclusion(modelMatrix, boundsMin, boundsMax)) {
+            continue;
+        }
 
         std::shared_ptr<Engine::IAL::I_Shader> shader;
         if (animatedMesh) {
@@ -609,43 +1108,111 @@ void Renderer::RenderScenePass(const Matrix4& view,
         }
 
         shader->Bind();
-        shader->SetUniform("uViewProj", viewProj);
-        shader->SetUniform("uView", view);
+        ApplySceneUniforms(shader, view, viewProj, clip, cameraPosition, mode, hasShadow);
         shader->SetUniform("uModel", modelMatrix);
-        shader->SetUniform("uClipPlane", clip);
-        shader->SetUniform("uLightPosition", m_directionalLight.position);
-        shader->SetUniform("uLightColor", m_directionalLight.color);
-        shader->SetUniform("uAmbientColor", m_directionalLight.ambient);
-        shader->SetUniform("uCameraPos", cameraPosition);
-        shader->SetUniform("uFogColor", fogColor);
-        shader->SetUniform("uFogDensity", fogDensity);
-        shader->SetUniform("uShadowMatrix", m_shadowMatrix);
-        shader->SetUniform("uShadowStrength", hasShadow ? m_shadowStrength : 0.0f);
-        shader->SetUniform("uEnvironmentIntensity", m_environmentIntensity);
-        shader->SetUniform("uEnvironmentMaxLod", m_environmentMaxLod);
-        shader->SetUniform("uUseEnvironment", m_skyboxTexture ? 1 : 0);
-        shader->SetUniform("uDebugMode", ToShaderDebugMode(mode));
-        shader->SetUniform("uNearPlane", m_nearPlane);
-        shader->SetUniform("uFarPlane", m_farPlane);
-        constexpr int kMaxPointLights = 4;
-        const int pointCount = std::min(static_cast<int>(m_pointLights.size()), kMaxPointLights);
-        shader->SetUniform("uPointLightCount", pointCount);
-        for (int i = 0; i < kMaxPointLights; ++i) {
-            const std::string index = std::to_string(i);
-            Vector3 position{};
-            Vector3 color{};
-            Vector3 ambient{};
-            if (i < pointCount) {
-                position = m_pointLights[i].position;
-                color = m_pointLights[i].color;
-                ambient = m_pointLights[i].ambient;
-            }
-            shader->SetUniform("uPointLightPositions[" + index + "]", position);
-            shader->SetUniform("uPointLightColors[" + index + "]", color);
-            shader->SetUniform("uPointLightAmbient[" + index + "]", ambient);
+
+        auto terrainNormals = heightmap ? heightmap->GetNormalTexture() : nullptr;
+        if (terrainNormals) {
+            terrainNormals->Bind(7);
+            shader->SetUniform("uTerrainNormalMap", 7);
+            shader->SetUniform("uHasTerrainNormalMap", 1);
         }
 
-        Engine::IAL::PBRMaterial material = ResolveMaterial(node, mesh);
+        if (animatedMesh) {
+            const auto& bones = animatedMesh->GetBoneTransforms();
+            const int boneCount = static_cast<int>(bones.size());
+            shader->SetUniform("uBoneCount", boneCount);
+            BindBonePalette(bones, boneCount);
+        }
+        else {
+            UnbindBonePalette();
+        }
+
+        // 主视图（无裁剪平面）中地形的 GPU 耗时写入 Render Stats，用于比较网格简化前后的开销
+        const bool timeTerrain = heightmap && !clipPlane && !m_terrainTimedThisFrame && BeginGpuTimer(m_terrainTimer);
+        DrawWithMaterials(shader, node, mesh, shadowTexture, 0);
+        ++m_sceneSubmissions;
+        if (timeTerrain) {
+            EndGpuTimer(m_terrainTimer);
+            m_terrainTimedThisFrame = true;
+        }
+
+        shader->Unbind();
+    }
+    UnbindBonePalette();
+
+    // 共享网格与纹理的节点合并为一次实例化绘制，逐实例的视锥剔除在 CPU 上完成。
+    for (const auto& batch : m_instanceBatches) {
+        if (CullInstances(batch, frustum) == 0) {
+            continue;
+        }
+        auto shader = batch.node->GetTexture() ? m_terrainInstancedShader : m_sceneInstancedShader;
+        UploadInstanceMatrices(m_visibleInstances);
+        shader->Bind();
+        ApplySceneUniforms(shader, view, viewProj, clip, cameraPosition, mode, hasShadow);
+        DrawWithMaterials(shader, batch.node, batch.mesh, shadowTexture, static_cast<int>(m_visibleInstances.size()));
+        ++m_sceneSubmissions;
+        shader->Unbind();
+    }
+    m_horizonActive = false;
+    glDisable(GL_CLIP_DISTANCE0);
+}
+
+void Renderer::ApplySceneUniforms(const std::shared_ptr<Engine::IAL::I_Shader>& shader,
+                                  const Matrix4& view,
+                                  const Matrix4& viewProj,
+                                  const Vector4& clip,
+                                  const Vector3& cameraPosition,
+                                  RenderDebugMode mode,
+                                  bool hasShadow) {
+    shader->SetUniform("uViewProj", viewProj);
+    shader->SetUniform("uView", view);
+    shader->SetUniform("uClipPlane", clip);
+    shader->SetUniform("uLightPosition", m_directionalLight.position);
+    shader->SetUniform("uLightColor", m_directionalLight.color);
+    shader->SetUniform("uAmbientColor", m_directionalLight.ambient);
+    shader->SetUniform("uCameraPos", cameraPosition);
+    shader->SetUniform("uFogColor", GetFogColor());
+    shader->SetUniform("uFogDensity", GetFogDensity());
+    const int cascadeCount = hasShadow ? m_shadowMap->GetCascadeCount() : 0;
+    if (cascadeCount > 0) {
+        shader->SetUniformMatrix4Array("uShadowMatrices", m_shadowMap->GetCascadeViewProjections(),
+                                       static_cast<std::size_t>(cascadeCount));
+    }
+    shader->SetUniform("uShadowCascadeCount", cascadeCount);
+    shader->SetUniform("uShadowStrength", hasShadow ? m_shadowStrength : 0.0f);
+    // 矩图集使用材质纹理之外的第 8 个纹理单元，DrawWithMaterials 不会覆盖
+    auto momentTexture = hasShadow ? m_shadowMap->GetMomentTexture() : nullptr;
+    shader->SetUniform("uShadowFilter", momentTexture ? m_shadowMap->GetShaderFilterMode() : 0);
+    if (momentTexture) {
+        momentTexture->Bind(8);
+        shader->SetUniform("uShadowMoments", 8);
+        shader->SetUniform("uEvsmParams", m_shadowMap->GetEvsmParameters());
+    }
+    shader->SetUniform("uEnvironmentIntensity", m_environmentIntensity);
+    shader->SetUniform("uEnvironmentMaxLod", m_environmentMaxLod);
+    shader->SetUniform("uUseEnvironment", m_skyboxTexture ? 1 : 0);
+    shader->SetUniform("uDebugMode", ToShaderDebugMode(mode));
+    shader->SetUniform("uHasTerrainNormalMap", 0);
+    shader->SetUniform("uNearPlane", m_nearPlane);
+    shader->SetUniform("uFarPlane", m_farPlane);
+    // 簇列表由 UpdateLightClusters 绑定在 binding = 3/4/5，这里只设置簇参数
+    shader->SetUniform("uPointLightCount", static_cast<int>(m_lightClusterer->GetLightCount()));
+    shader->SetUniform("uPointAmbient", m_lightClusterer->GetAmbientSum());
+    shader->SetUniform("uClusterParams", m_lightClusterer->GetShaderParameters());
+}
+
+void Renderer::DrawWithMaterials(const std::shared_ptr<Engine::IAL::I_Shader>& shader,
+                                 const std::shared_ptr<SceneNode>& node,
+                                 const std::shared_ptr<Engine::IAL::I_Mesh>& mesh,
+                                 const std::shared_ptr<Engine::IAL::I_Texture>& shadowTexture,
+                                 int instanceCount) {
+    // 多图元网格逐子网格绘制，使每个图元使用自己的材质；顶点/索引缓冲在子网格间共享。
+    const int subMeshCount = mesh->GetSubMeshCount();
+    const bool drawSubMeshes = subMeshCount > 1;
+    const int drawCount = drawSubMeshes ? subMeshCount : 1;
+    for (int subMesh = 0; subMesh < drawCount; ++subMesh) {
+        Engine::IAL::PBRMaterial material = ResolveMaterial(node, mesh, drawSubMeshes ? subMesh : -1);
         shader->SetUniform("uBaseColorFactor", material.baseColorFactor);
         shader->SetUniform("uMetallicFactor", material.metallicFactor);
         shader->SetUniform("uRoughnessFactor", material.roughnessFactor);
@@ -689,7 +1256,7 @@ void Renderer::RenderScenePass(const Matrix4& view,
             m_skyboxTexture->Bind(5);
             shader->SetUniform("uEnvironmentMap", 5);
         }
-        if (hasShadow) {
+        if (shadowTexture) {
             shadowTexture->Bind(6);
             shader->SetUniform("uShadowMap", 6);
         }
@@ -718,18 +1285,21 @@ void Renderer::RenderScenePass(const Matrix4& view,
             glDepthMask(GL_TRUE);
         }
 
-        if (animatedMesh) {
-            const auto& bones = animatedMesh->GetBoneTransforms();
-            const int boneCount = static_cast<int>(bones.size());
-            shader->SetUniform("uBoneCount", boneCount);
-            BindBonePalette(bones, boneCount);
+        if (instanceCount > 0) {
+            if (drawSubMeshes) {
+                mesh->DrawSubMeshInstanced(subMesh, instanceCount);
+            }
+            else {
+                mesh->DrawInstanced(instanceCount);
+            }
+        }
+        else if (drawSubMeshes) {
+            mesh->DrawSubMesh(subMesh);
         }
         else {
-            UnbindBonePalette();
+            mesh->Draw();
         }
 
-        mesh->Draw();
-
         if (material.doubleSided && prevCull) {
             glEnable(GL_CULL_FACE);
         }
@@ -743,11 +1313,7 @@ void Renderer::RenderScenePass(const Matrix4& view,
             }
             glDepthMask(prevDepthMask);
         }
-
-        shader->Unbind();
     }
-    glDisable(GL_CLIP_DISTANCE0);
-    UnbindBonePalette();
 }
 
 void Renderer::RenderGrass(const Matrix4& view,
@@ -764,7 +1330,8 @@ void Renderer::RenderGrass(const Matrix4& view,
 void Renderer::RenderWaterSurface(const Matrix4& view,
                                   const Matrix4& projection,
                                   const Vector3& cameraPosition,
-                                  RenderDebugMode mode) {
+                                  RenderDebugMode mode,
+                                  const WaterTargets& targets) {
     if (!m_water || !m_waterShader) {
         return;
     }
@@ -772,9 +1339,10 @@ void Renderer::RenderWaterSurface(const Matrix4& view,
     if (!waterNode) {
         return;
     }
-    auto reflectionTexture = m_waterReflectionFBO ? m_waterReflectionFBO->GetColorTexture() : nullptr;
-    auto refractionTexture = m_waterRefractionFBO ? m_waterRefractionFBO->GetColorTexture() : nullptr;
-    if (!reflectionTexture || !refractionTexture) {
+    auto reflectionTexture = targets.reflection ? targets.reflection->GetColorTexture() : nullptr;
+    auto refractionTexture = targets.refraction ? targets.refraction->GetColorTexture() : nullptr;
+    auto refractionDepth = targets.refraction ? targets.refraction->GetDepthTexture() : nullptr;
+    if (!reflectionTexture || !refractionTexture || !refractionDepth) {
         return;
     }
     auto mesh = waterNode->GetMesh();
@@ -792,7 +1360,7 @@ void Renderer::RenderWaterSurface(const Matrix4& view,
 
     m_waterShader->Bind();
     m_waterShader->SetUniform("uModel", modelMatrix);
-    m_waterShader->SetUniform("uReflectionViewProj", m_reflectionViewProj);
+    m_waterShader->SetUniform("uReflectionViewProj", *targets.reflectionViewProj);
     m_waterShader->SetUniform("uViewProj", viewProj);
     m_waterShader->SetUniform("uCameraPos", cameraPosition);
     m_waterShader->SetUniform("uLightColor", m_directionalLight.color);
@@ -805,16 +1373,31 @@ void Renderer::RenderWaterSurface(const Matrix4& view,
 
     auto shadowTexture = m_shadowMap ? m_shadowMap->GetDepthTexture() : nullptr;
     const bool hasShadow = static_cast<bool>(shadowTexture);
-    m_waterShader->SetUniform("uShadowMatrix", m_shadowMatrix);
+    const int cascadeCount = hasShadow ? m_shadowMap->GetCascadeCount() : 0;
+    if (cascadeCount > 0) {
+        m_waterShader->SetUniformMatrix4Array("uShadowMatrices", m_shadowMap->GetCascadeViewProjections(),
+                                              static_cast<std::size_t>(cascadeCount));
+    }
+    m_waterShader->SetUniform("uShadowCascadeCount", cascadeCount);
     m_waterShader->SetUniform("uShadowStrength", hasShadow ? m_shadowStrength : 0.0f);
     if (hasShadow) {
         shadowTexture->Bind(2);
         m_waterShader->SetUniform("uShadowMap", 2);
     }
+    auto momentTexture = hasShadow ? m_shadowMap->GetMomentTexture() : nullptr;
+    m_waterShader->SetUniform("uShadowFilter", momentTexture ? m_shadowMap->GetShaderFilterMode() : 0);
+    if (momentTexture) {
+        momentTexture->Bind(4);
+        m_waterShader->SetUniform("uShadowMoments", 4);
+        m_waterShader->SetUniform("uEvsmParams", m_shadowMap->GetEvsmParameters());
+    }
     reflectionTexture->Bind(0);
     m_waterShader->SetUniform("uReflectionTex", 0);
     refractionTexture->Bind(1);
     m_waterShader->SetUniform("uRefractionTex", 1);
+    refractionDepth->Bind(3);
+    m_waterShader->SetUniform("uRefractionDepthTex", 3);
+    m_waterShader->SetUniform("uWaterAbsorption", m_waterAbsorption);
     mesh->Draw();
     m_waterShader->Unbind();
 
@@ -826,8 +1409,9 @@ void Renderer::RenderWaterSurface(const Matrix4& view,
 void Renderer::RenderReflectionPass(const Matrix4& projection,
                                     const Vector3& cameraPosition,
                                     float cameraYaw,
-                                    float cameraPitch) {
-    if (!m_water || !m_waterReflectionFBO) {
+                                    float cameraPitch,
+                                    const WaterTargets& targets) {
+    if (!m_water || !targets.reflection) {
         return;
     }
     float distance = cameraPosition.y - m_water->GetHeight();
@@ -839,20 +1423,59 @@ void Renderer::RenderReflectionPass(const Matrix4& projection,
     reflectionCamera.SetYaw(cameraYaw);
     reflectionCamera.SetPitch(-cameraPitch);
 
-    m_waterReflectionFBO->Bind();
-    glViewport(0, 0, m_surfaceWidth, m_surfaceHeight);
+    targets.reflection->Bind();
+    glViewport(0, 0, targets.reflectionWidth, targets.reflectionHeight);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     Matrix4 reflectionView = reflectionCamera.BuildViewMatrix();
-    m_reflectionViewProj = projection * reflectionView;
+    *targets.reflectionViewProj = projection * reflectionView;
     RenderSkybox(reflectionView, projection);
     const float waterHeight = m_water->GetHeight();
     constexpr float clipBias = 0.5f;
     Vector4 reflectionClip(0.0f, 1.0f, 0.0f, -(waterHeight - clipBias));
-    RenderScenePass(reflectionView, projection, reflectionCamera.GetPosition(), true, RenderDebugMode::Standard,
-                    &reflectionClip);
+    // 相机在水面以下时镜像相机位于水面之上，无法把近平面倾斜到水面，退回硬件裁剪平面
+    Matrix4 sceneProjection = projection;
+    const bool oblique = MakeObliqueProjection(projection, reflectionView, reflectionClip, sceneProjection);
+    RenderScenePass(reflectionView, sceneProjection, reflectionCamera.GetPosition(), true, RenderDebugMode::Standard,
+                    &reflectionClip, !oblique);
 
-    m_waterReflectionFBO->Unbind();
+    targets.reflection->Unbind();
+}
+
+bool Renderer::MakeObliqueProjection(const Matrix4& projection,
+                                     const Matrix4& view,
+                                     const Vector4& worldPlane,
+                                     Matrix4& outProjection) {
+    // 平面按逆转置矩阵变换到观察空间：C = P * inverse(view)
+    const Matrix4 inverseView = view.Inverse();
+    const float* inv = inverseView.values;
+    const Vector4 plane(
+        worldPlane.x * inv[0] + worldPlane.y * inv[1] + worldPlane.z * inv[2] + worldPlane.w * inv[3],
+        worldPlane.x * inv[4] + worldPlane.y * inv[5] + worldPlane.z * inv[6] + worldPlane.w * inv[7],
+        worldPlane.x * inv[8] + worldPlane.y * inv[9] + worldPlane.z * inv[10] + worldPlane.w * inv[11],
+        worldPlane.x * inv[12] + worldPlane.y * inv[13] + worldPlane.z * inv[14] + worldPlane.w * inv[15]);
+    // 相机必须位于平面保留一侧的反面，否则倾斜后的近平面会裁掉相机前方的全部几何体
+    if (plane.w >= 0.0f) {
+        return false;
+    }
+    const float* m = projection.values;
+    // q 为裁剪空间中与平面相对的视锥角点，经投影矩阵的逆变换回观察空间
+    const float qx = ((plane.x > 0.0f ? 1.0f : (plane.x < 0.0f ? -1.0f : 0.0f)) + m[8]) / m[0];
+    const float qy = ((plane.y > 0.0f ? 1.0f : (plane.y < 0.0f ? -1.0f : 0.0f)) + m[9]) / m[5];
+    const float qz = -1.0f;
+    const float qw = (1.0f + m[10]) / m[14];
+    const float dot = plane.x * qx + plane.y * qy + plane.z * qz + plane.w * qw;
+    if (std::abs(dot) <= 1e-12f) {
+        return false;
+    }
+    const float scale = 2.0f / dot;
+    outProjection = projection;
+    float* out = outProjection.values;
+    out[2] = plane.x * scale - m[3];
+    out[6] = plane.y * scale - m[7];
+    out[10] = plane.z * scale - m[11];
+    out[14] = plane.w * scale - m[15];
+    return true;
 }
 
 void Renderer::BindBonePalette(const std::vector<Matrix4>& bones, int boneCount) {
@@ -903,14 +1526,263 @@ void Renderer::EnsureBoneBufferCapacity(std::size_t requiredCount) {
     m_boneCapacity = newCapacity;
 }
 
+void Renderer::PrepareFrameQueue() {
+    m_frameNodes.clear();
+    m_sceneGraph->CollectRenderableNodes(m_frameNodes);
+    m_renderQueue = m_frameNodes;
+    BuildInstanceBatches(true);
+}
+
+void Renderer::BuildInstanceBatches(bool skipWaterNode) {
+    m_instanceBatches.clear();
+    if (!m_sceneInstancedShader || !m_terrainInstancedShader) {
+        return;
+    }
+
+    // 以 (网格, 纹理) 为键分组；只有一个成员的组保留在渲染队列中，按原路径绘制。
+    struct GroupKey {
+        const Engine::IAL::I_Mesh* mesh;
+        const Engine::IAL::I_Texture* texture;
+        bool operator==(const GroupKey& other) const {
+            return mesh == other.mesh && texture == other.texture;
+        }
+    };
+    struct GroupKeyHash {
+        std::size_t operator()(const GroupKey& key) const {
+            return std::hash<const void*>()(key.mesh) ^ (std::hash<const void*>()(key.texture) << 1);
+        }
+    };
+    std::unordered_map<GroupKey, std::vector<std::size_t>, GroupKeyHash> groups;
+    std::vector<GroupKey> order;
+
+    const auto waterNode = m_water ? m_water->GetNode() : nullptr;
+    for (std::size_t i = 0; i < m_renderQueue.size(); ++i) {
+        const auto& node = m_renderQueue[i];
+        if (!node || (skipWaterNode && node == waterNode)) {
+            continue;
+        }
+        const auto& mesh = node->GetMesh();
+        if (!mesh || !mesh->SupportsInstancing()) {
+            continue;
+        }
+        if (std::dynamic_pointer_cast<Engine::IAL::I_AnimatedMesh>(mesh)) {
+            continue;
+        }
+        const GroupKey key{ mesh.get(), node->GetTexture().get() };
+        auto& members = groups[key];
+        if (members.empty()) {
+            order.push_back(key);
+        }
+        members.push_back(i);
+    }
+
+    std::vector<bool> batched(m_renderQueue.size(), false);
+    for (const auto& key : order) {
+        const auto& members = groups[key];
+        if (members.size() < 2) {
+            continue;
+        }
+        InstanceBatch batch;
+        batch.node = m_renderQueue[members.front()];
+        batch.mesh = batch.node->GetMesh();
+        batch.hasBounds = batch.mesh->GetLocalBounds(batch.boundsMin, batch.boundsMax);
+        batch.transforms.reserve(members.size());
+        for (std::size_t index : members) {
+            batch.transforms.push_back(m_renderQueue[index]->GetWorldTransform());
+            batched[index] = true;
+        }
+        m_instanceBatches.push_back(std::move(batch));
+    }
+
+    if (m_instanceBatches.empty()) {
+        return;
+    }
+    std::size_t write = 0;
+    for (std::size_t i = 0; i < m_renderQueue.size(); ++i) {
+        if (!batched[i]) {
+            m_renderQueue[write++] = m_renderQueue[i];
+        }
+    }
+    m_renderQueue.resize(write);
+}
+
+std::size_t Renderer::CullInstances(const InstanceBatch& batch, const Frustum& frustum) {
+    m_visibleInstances.clear();
+    if (!batch.hasBounds) {
+        m_visibleInstances = batch.transforms;
+        return m_visibleInstances.size();
+    }
+    for (const auto& transform : batch.transforms) {
+        if (frustum.IntersectsBox(transform, batch.boundsMin, batch.boundsMax) &&
+            PassesOcclusion(transform, batch.boundsMin, batch.boundsMax)) {
+            m_visibleInstances.push_back(transform);
+        }
+    }
+    return m_visibleInstances.size();
+}
+
+bool Renderer::BuildOcclusionBuffer(const Matrix4& viewProj) {
+    if (!m_occlusionCullingEnabled || !m_sceneGraph) {
+        return false;
+    }
+    m_occlusionCuller->BeginFrame(viewProj);
+    for (const auto& node : m_frameNodes) {
+        if (!node) {
+            continue;
+        }
+        for (const auto& box : node->GetOccluderBoxes()) {
+            m_occlusionCuller->AddOccluderBox(node->GetWorldTransform(), box.localMin, box.localMax);
+        }
+    }
+    m_occlusionCuller->Rasterize();
+    return true;
+}
+
+bool Renderer::BeginHorizonPass(const Vector3& cameraPosition, const Vector4* clipPlane) {
+    if (!m_horizonCullingEnabled) {
+        return false;
+    }
+    // 水面通道的裁剪平面为 (0, ±1, 0, d)：法线朝上保留平面以上，朝下保留平面以下
+    TerrainHorizon::ClipMode clipMode = TerrainHorizon::ClipMode::None;
+    float clipHeight = 0.0f;
+    if (clipPlane) {
+        if (clipPlane->x != 0.0f || clipPlane->z != 0.0f || clipPlane->y == 0.0f) {
+            return false;
+        }
+        clipMode = clipPlane->y > 0.0f ? TerrainHorizon::ClipMode::KeepAbove : TerrainHorizon::ClipMode::KeepBelow;
+        clipHeight = -clipPlane->w / clipPlane->y;
+    }
+    return m_terrainHorizon->BeginView(cameraPosition, clipMode, clipHeight);
+}
+
+bool Renderer::PassesOcclusion(const Matrix4& model, const Vector3& localMin, const Vector3& localMax) {
+    if (!m_occlusionActive && !m_horizonActive) {
+        return true;
+    }
+    Vector3 worldMin;
+    Vector3 worldMax;
+    Frustum::TransformAABB(model, localMin, localMax, worldMin, worldMax);
+    ++m_occlusionTested;
+    if (m_horizonActive && !m_terrainHorizon->IsVisible(worldMin, worldMax)) {
+        ++m_horizonCulled;
+        return false;
+    }
+    if (!m_occlusionActive || m_occlusionCuller->IsVisible(worldMin, worldMax)) {
+        return true;
+    }
+    ++m_occlusionCulled;
+    return false;
+}
+
+bool Renderer::BeginGpuTimer(GpuPassTimer& timer) {
+    if (timer.queries[0] == 0) {
+        glGenQueries(static_cast<GLsizei>(timer.queries.size()), timer.queries.data());
+    }
+    // 查询按帧轮换，读取的是几帧前的结果，不会让 CPU 等待 GPU；GL_TIME_ELAPSED 不能嵌套
+    const GLuint query = timer.queries[timer.index];
+    if (timer.pending[timer.index]) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return false;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        timer.gpuMs = static_cast<float>(elapsed) * 1e-6f;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    return true;
+}
+
+void Renderer::EndGpuTimer(GpuPassTimer& timer) {
+    glEndQuery(GL_TIME_ELAPSED);
+    timer.pending[timer.index] = true;
+    timer.index = (timer.index + 1) % timer.queries.size();
+}
+
+void Renderer::ReleaseGpuTimer(GpuPassTimer& timer) {
+    if (timer.queries[0] != 0) {
+        glDeleteQueries(static_cast<GLsizei>(timer.queries.size()), timer.queries.data());
+        timer.queries.fill(0);
+    }
+}
+
+void Renderer::UploadInstanceMatrices(const std::vector<Matrix4>& transforms) {
+    if (transforms.empty()) {
+        return;
+    }
+    if (m_instanceBuffer == 0) {
+        glGenBuffers(1, &m_instanceBuffer);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+    if (transforms.size() > m_instanceCapacity) {
+        const std::size_t newCapacity = std::max<std::size_t>(transforms.size(), std::max<std::size_t>(m_instanceCapacity * 2, 64));
+        glBufferData(GL_SHADER_STORAGE_BUFFER,
+                     static_cast<GLsizeiptr>(newCapacity * sizeof(Matrix4)),
+                     nullptr,
+                     GL_DYNAMIC_DRAW);
+        m_instanceCapacity = newCapacity;
+    }
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                    0,
+                    static_cast<GLsizeiptr>(transforms.size() * sizeof(Matrix4)),
+                    transforms.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_instanceBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void Renderer::UpdateLightClusters(const Matrix4& view, const Matrix4& projection) {
+    // 斜投影只改写深度行，values[0] / values[5] 仍是常规透视投影的 x/y 缩放
+    if (m_lightClusterer->Build(view, projection.values[0], projection.values[5], m_nearPlane, m_farPlane)) {
+        const auto& lights = m_lightClusterer->GetGpuLights();
+        const auto& ranges = m_lightClusterer->GetClusterRanges();
+        const auto& indices = m_lightClusterer->GetLightIndices();
+        UploadClusterBuffer(m_clusterLightBuffer, m_clusterLightCapacity, lights.data(),
+                            lights.size() * sizeof(LightClusterer::GpuLight), 3);
+        UploadClusterBuffer(m_clusterRangeBuffer, m_clusterRangeCapacity, ranges.data(),
+                            ranges.size() * sizeof(std::uint32_t), 4);
+        UploadClusterBuffer(m_clusterIndexBuffer, m_clusterIndexCapacity, indices.data(),
+                            indices.size() * sizeof(std::uint32_t), 5);
+        return;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_clusterLightBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_clusterRangeBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, m_clusterIndexBuffer);
+}
+
+void Renderer::UploadClusterBuffer(unsigned int& buffer, std::size_t& capacity, const void* data, std::size_t bytes,
+                                   unsigned int binding) {
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    // 没有光源时也分配存储，着色器绑定的 SSBO 始终有效
+    if (capacity == 0 || bytes > capacity) {
+        const std::size_t newCapacity = std::max<std::size_t>(bytes, std::max<std::size_t>(capacity * 2, 1024));
+        glBufferData(GL_SHADER_STORAGE_BUFFER,
+                     static_cast<GLsizeiptr>(newCapacity),
+                     nullptr,
+                     GL_DYNAMIC_DRAW);
+        capacity = newCapacity;
+    }
+    if (bytes > 0) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(bytes), data);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
 void Renderer::RenderRefractionPass(const Matrix4& view,
                                     const Matrix4& projection,
-                                    const Vector3& cameraPosition) {
-    if (!m_water || !m_waterRefractionFBO) {
+                                    const Vector3& cameraPosition,
+                                    const WaterTargets& targets) {
+    if (!m_water || !targets.refraction) {
         return;
     }
-    m_waterRefractionFBO->Bind();
-    glViewport(0, 0, m_surfaceWidth, m_surfaceHeight);
+    targets.refraction->Bind();
+    glViewport(0, 0, targets.refractionWidth, targets.refractionHeight);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     RenderSkybox(view, projection);
@@ -919,7 +1791,7 @@ void Renderer::RenderRefractionPass(const Matrix4& view,
     Vector4 refractionClip(0.0f, -1.0f, 0.0f, waterHeight + clipBias);
     RenderScenePass(view, projection, cameraPosition, true, RenderDebugMode::Standard, &refractionClip);
 
-    m_waterRefractionFBO->Unbind();
+    targets.refraction->Unbind();
 }
 
 void Renderer::RenderRain(const Matrix4& view,
@@ -967,15 +1839,132 @@ void Renderer::RenderDebugUI() {
         if (m_debugUI->SliderFloat("Specular Power", &specular, 1.0f, 256.0f)) {
             m_specularPower = specular;
         }
+
+        if (m_shadowMap) {
+            float cascadeCount = static_cast<float>(m_shadowMap->GetCascadeCount());
+            if (m_debugUI->SliderFloat("Shadow Cascades", &cascadeCount, 1.0f, static_cast<float>(ShadowMap::kMaxCascades))) {
+                m_shadowMap->SetCascadeCount(static_cast<int>(std::lround(cascadeCount)));
+            }
+            float splitLambda = m_shadowMap->GetSplitLambda();
+            if (m_debugUI->SliderFloat("Cascade Split Lambda", &splitLambda, 0.0f, 1.0f)) {
+                m_shadowMap->SetSplitLambda(splitLambda);
+            }
+            float shadowDistance = m_shadowMap->GetShadowDistance();
+            if (m_debugUI->SliderFloat("Shadow Distance", &shadowDistance, 200.0f, m_farPlane)) {
+                m_shadowMap->SetShadowDistance(shadowDistance);
+            }
+            bool staticCaching = m_shadowMap->IsStaticCaching();
+            if (m_debugUI->Checkbox("Cache Static Shadows", &staticCaching)) {
+                m_shadowMap->SetStaticCaching(staticCaching);
+            }
+            m_debugUI->Text("Static shadow rebuilds: " + std::to_string(m_shadowMap->GetStaticRebuildCount()));
+            const ShadowMap::FilterPreset filterPreset = m_shadowMap->GetFilterPreset();
+            if (m_debugUI->Button(std::string("Shadow Filter: ") + ShadowMap::GetFilterPresetName(filterPreset))) {
+                m_shadowMap->SetFilterPreset(static_cast<ShadowMap::FilterPreset>((static_cast<int>(filterPreset) + 1) % 3));
+            }
+            if (m_shadowMap->GetShaderFilterMode() != 0) {
+                m_debugUI->Text("Shadow prefilter GPU: " + std::to_string(m_shadowPrefilterTimer.gpuMs) + " ms");
+            }
+            for (int i = 0; i < m_shadowMap->GetCascadeCount(); ++i) {
+                const ShadowCascadeStats& stats = m_shadowCascadeStats[static_cast<std::size_t>(i)];
+                m_debugUI->Text("Cascade " + std::to_string(i) + " (to " +
+                                std::to_string(static_cast<int>(m_shadowMap->GetSplitDistance(i))) + "): " +
+                                std::to_string(stats.draws) + " draws, " + std::to_string(stats.triangles) +
+                                " tris, " + std::to_string(stats.culled) + " culled");
+            }
+            std::size_t fetchBytes = 0;
+            std::size_t savedBytes = 0;
+            for (const ShadowCascadeStats& stats : m_shadowCascadeStats) {
+                fetchBytes += stats.vertexBytes;
+                savedBytes += stats.vertexBytesSaved;
+            }
+            // 按每个顶点读取一次估算，不计顶点缓存复用
+            m_debugUI->Text("Shadow vertex fetch: " + std::to_string(fetchBytes / 1024) + " KB, depth streams saved " +
+                            std::to_string(savedBytes / 1024) + " KB");
+        }
+        m_debugUI->Text("Point lights: " + std::to_string(m_lightClusterer->GetLightCount()) + ", " +
+                        std::to_string(m_lightClusterer->GetOccupiedClusterCount()) + "/" +
+                        std::to_string(LightClusterer::kClusterCount) + " clusters lit, max " +
+                        std::to_string(m_lightClusterer->GetMaxLightsPerCluster()) + " per cluster");
+        m_debugUI->Text("Light cluster build (last view): " + std::to_string(m_lightClusterer->GetBuildMs()) + " ms");
+    }
+    m_debugUI->EndWindow();
+
+    if (m_debugUI->BeginWindow("Render Stats")) {
+        if (m_terrainTimer.queries[0] != 0) {
+            m_debugUI->Text("Terrain GPU (main view): " + std::to_string(m_terrainTimer.gpuMs) + " ms");
+        }
+        if (m_water) {
+            bool scaleChanged = m_debugUI->SliderFloat("Reflection Scale", &m_waterReflectionScale, 0.25f, 1.0f);
+            if (m_waterRefractionSource == WaterRefractionSource::ClipPlanePass) {
+                scaleChanged = m_debugUI->SliderFloat("Refraction Scale", &m_waterRefractionScale, 0.25f, 1.0f) ||
+                               scaleChanged;
+            }
+            if (scaleChanged) {
+                RecreateWaterTargets();
+            }
+            float refreshInterval = static_cast<float>(m_reflectionRefreshInterval);
+            if (m_debugUI->SliderFloat("Reflection Refresh Interval", &refreshInterval, 1.0f, 4.0f)) {
+                m_reflectionRefreshInterval = std::max(1, static_cast<int>(std::lround(refreshInterval)));
+            }
+            m_debugUI->Checkbox("Water Visibility Gate", &m_waterVisibilityGate);
+            const bool sceneCopy = m_waterRefractionSource == WaterRefractionSource::SceneCopy;
+            if (m_debugUI->Button(std::string("Water Refraction: ") + (sceneCopy ? "scene copy" : "clip-plane pass"))) {
+                SetWaterRefractionSource(sceneCopy ? WaterRefractionSource::ClipPlanePass
+                                                   : WaterRefractionSource::SceneCopy);
+            }
+            m_debugUI->SliderFloat("Water Absorption", &m_waterAbsorption, 0.0f, 0.1f);
+            m_debugUI->Text("Water GPU (main view): reflection " + std::to_string(m_reflectionTimer.gpuMs) +
+                            " ms" + (m_reflectionRefreshedThisFrame ? "" : " (reused this frame)") +
+                            ", refraction " + std::to_string(m_refractionTimer.gpuMs) + " ms, " +
+                            std::to_string(m_waterViewsSkipped) + " view(s) skipped water");
+        }
+        m_debugUI->Checkbox("Occlusion Culling", &m_occlusionCullingEnabled);
+        m_debugUI->Checkbox("Terrain Horizon Culling", &m_horizonCullingEnabled);
+        if (m_occlusionCullingEnabled) {
+            m_debugUI->Text("Occlusion: " + std::to_string(m_occlusionCulled) + " of " +
+                            std::to_string(m_occlusionTested) + " tests culled, raster " +
+                            std::to_string(m_occlusionCuller->GetRasterMs()) + " ms (" +
+                            std::to_string(m_occlusionCuller->GetOccluderTriangleCount()) + " triangles)");
+        }
+        if (m_horizonCullingEnabled && m_terrainHorizon->GetTileCount() > 0) {
+            m_debugUI->Text("Water Plane Culled: " + std::to_string(m_waterPlaneCulled) + " nodes");
+            m_debugUI->Text("Terrain Horizon: " + std::to_string(m_horizonCulled) + " behind terrain, build " +
+                            std::to_string(m_terrainHorizon->GetBuildMs()) + " ms (" +
+                            std::to_string(m_terrainHorizon->GetTileCount()) + " tiles)");
+        }
+        if (m_viewLayout == ViewLayoutMode::Quad) {
+            const char* waterModes[] = { "share primary", "half resolution", "full" };
+            if (m_debugUI->Button(std::string("Split View Water: ") +
+                                  waterModes[static_cast<int>(m_splitViewWaterMode)])) {
+                SetSplitViewWaterMode(static_cast<SplitViewWaterMode>((static_cast<int>(m_splitViewWaterMode) + 1) % 3));
+            }
+        }
+        const std::size_t viewportCount = m_viewLayout == ViewLayoutMode::Quad ? kViewportCount : 1;
+        for (std::size_t i = 0; i < viewportCount; ++i) {
+            const ViewportStats& stats = m_viewportStats[i];
+            const char* water = stats.water == SplitViewWaterMode::SharePrimary
+                ? "shared"
+                : (stats.water == SplitViewWaterMode::ReducedResolution ? "half-res" : "full");
+            m_debugUI->Text("Viewport " + std::to_string(i) + ": CPU " + std::to_string(stats.cpuMs) + " ms, GPU " +
+                            std::to_string(stats.gpuMs) + " ms, " + std::to_string(stats.submissions) +
+                            " submissions, " + std::to_string(stats.culled) + " culled, water " + water);
+        }
+        if (m_grassField) {
+            m_debugUI->Text("Grass Blades / Frame: " + std::to_string(m_grassField->GetBladesSubmitted()) +
+                            " of " + std::to_string(m_grassField->GetInstanceCount()));
+        }
     }
     m_debugUI->EndWindow();
 }
 
 Engine::IAL::PBRMaterial Renderer::ResolveMaterial(const std::shared_ptr<SceneNode>& node,
-                                                   const std::shared_ptr<Engine::IAL::I_Mesh>& mesh) const {
+                                                   const std::shared_ptr<Engine::IAL::I_Mesh>& mesh,
+                                                   int subMesh) const {
     Engine::IAL::PBRMaterial material;
     if (mesh) {
-        if (const auto* existing = mesh->GetPBRMaterial()) {
+        const auto* existing = subMesh >= 0 ? mesh->GetSubMeshMaterial(subMesh) : mesh->GetPBRMaterial();
+        if (existing) {
             material = *existing;
         }
     }
@@ -8,13 +8,64 @@
  * Day12 进一步扩展了渲染流程，引入水体节点的递归渲染：在主场景绘制前先渲染反射与折射帧缓冲，
  * 随后使用专用水面着色器将两个纹理组合成最终的水体效果。Day15 则在后期处理中加入过渡着色器，
  * Renderer 可通过 SetTransitionState 将计时进度传递给 PostProcessing，驱动全屏过渡动画。
+ *
+ * 实例化绘制：每个场景通道开始时，BuildInstanceBatches 会把共享同一网格与纹理的静态节点
+ * （两个及以上）从渲染队列中取出，合并为 InstanceBatch。批次在 CPU 上逐实例做视锥剔除，
+ * 可见实例的世界矩阵写入 binding = 1 的 SSBO，再以一次 DrawInstanced 提交；
+ * 其余节点仍按原有的逐节点路径绘制。
+ *
+ * 遮挡剔除：每个视图开始时 BuildOcclusionBuffer 把地形粗网格与场景标注的遮挡盒光栅化到
+ * OcclusionCuller 的 CPU 深度缓冲并建立 Hi-Z。折射通道与主通道使用同一相机，
+ * 逐节点与逐实例绘制前都以包围盒查询 Hi-Z，完全被遮挡的节点不再提交；反射与阴影通道不受影响。
+ * 此外每个 RenderScenePass 以本通道的相机与水平裁剪平面构建 TerrainHorizon 地平线，
+ * 主通道、反射与折射通道都会剔除包围盒完全位于山脊之后的节点，该测试先于 Hi-Z 执行。
+ *
+ * 多视口：与视角无关的工作每帧只做一次——动画、阴影贴图、雨滴与草地更新，
+ * 以及 PrepareFrameQueue 收集的渲染队列与实例批次，所有视口与水面通道共用。
+ * 四分屏的调试视口按 SplitViewWaterMode 复用主视口的水面反射/折射纹理（默认）、
+ * 渲染到半分辨率的独立纹理，或完整重绘。每个视口记录 CPU 耗时、GPU 耗时（时间戳查询，
+ * 结果延迟数帧读取）、场景提交次数与剔除数，显示在 Render Stats 中。
+ *
+ * 水面通道：反射与折射纹理按 m_waterReflectionScale / m_waterRefractionScale 缩放分辨率。
+ * 水面包围盒未通过视锥、地形地平线或 Hi-Z 测试时，本视图跳过两个水面通道与水面绘制。
+ * 反射可按 m_reflectionRefreshInterval 帧刷新一次：反射纹理与渲染它的反射矩阵成对保存，
+ * 水面着色器用该矩阵把当前帧的世界坐标投影回旧纹理，相机移动时即得到重投影的结果；
+ * 相机跳变或其他视口写入同一纹理时立即刷新。主视口两个通道的 GPU 耗时显示在 Render Stats 中。
+ *
+ * 折射来源（WaterRefractionSource）：ClipPlanePass 以裁剪平面把水下场景重绘到折射纹理；
+ * SceneCopy（默认）在主通道的不透明几何体与草地之后，把主 FBO 的颜色与深度整体 blit 到 m_sceneCopyFBO，
+ * 水面直接采样这份拷贝，每个视图省去一次完整的场景遍历。水面之后的像素必然位于水面以下，因此无需裁剪。
+ * 两种来源都提供深度，water.frag 据此求水体厚度并按 m_waterAbsorption 做吸收。
+ *
+ * 反射通道不再启用 GL_CLIP_DISTANCE0，而是由 MakeObliqueProjection 把镜像相机投影的近平面
+ * 倾斜到水面（Lengyel 斜投影），硬件近平面裁剪即完成水面裁剪；该投影只改写深度行，
+ * 反射纹理坐标不受影响。裁剪平面通道在 CPU 上把视锥近平面替换为水面，
+ * 包围盒整体位于水面错误一侧的节点与实例不会提交。折射的裁剪平面通道仍使用硬件裁剪，
+ * 因为其深度要给 water.frag 计算水体厚度，斜投影的深度无法按常规方式线性化。
+ *
+ * 阴影：ShadowMap 按主相机视锥拟合级联阴影（数量、分割比例与阴影距离可在 Lighting Controls 中调整），
+ * 每帧渲染一次并被所有视口共用。每个级联以自己的光源视锥在 CPU 上剔除投射体，
+ * 逐级联的绘制次数、三角形数与剔除数记录在 m_shadowCascadeStats 中。
+ * 阴影投射体通过 I_Mesh::DrawDepth 使用只含位置（与蒙皮数据）的顶点流，统计中同时记录
+ * 顶点读取量以及相对完整顶点布局节省的字节数。
+ * 投射体分为静态（地形、建筑、实例化道具）与动态（骨骼动画网格）两组：静态深度缓存在
+ * ShadowMap 中，仅在级联矩阵（光源方向或级联位置）或 ComputeStaticShadowSignature 变化时重绘，
+ * 动态投射体每帧叠加到静态深度的拷贝上。
+ *
+ * 点光源：采用分簇前向着色。每个场景通道开始时 UpdateLightClusters 以本通道的视图矩阵
+ * 与投影的 x/y 缩放调用 LightClusterer::Build（斜投影只改写深度行，不影响簇划分），
+ * 视图或光源变化时才重建并上传光源（binding = 3）、每簇范围（binding = 4）与光源索引（binding = 5）三个 SSBO。
+ * basic.frag 与 skinning.frag 由片元的视图空间坐标求出所在簇，只遍历该簇的光源；
+ * 点光源的环境光分量与距离无关，汇总为 uPointAmbient。
  */
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <array>
+#include <chrono>
 
 #include "../Core/SceneGraph.h"
 #include "../Core/Light.h"
@@ -38,6 +89,10 @@ namespace Engine::IAL {
 }
 
 class GrassField;
+class Frustum;
+class OcclusionCuller;
+class TerrainHorizon;
+class LightClusterer;
 
 class PostProcessing;
 class Camera;
@@ -59,6 +114,17 @@ public:
         Single,
         Quad
     };
+
+    enum class SplitViewWaterMode {
+        SharePrimary,
+        ReducedResolution,
+        Full
+    };
+
+    enum class WaterRefractionSource {
+        ClipPlanePass,
+        SceneCopy
+    };
     Renderer(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factory,
              const std::shared_ptr<SceneGraph>& sceneGraph,
              const std::shared_ptr<Camera>& camera,
@@ -87,28 +153,97 @@ public:
     void ToggleMultiViewLayout();
     void OnSurfaceResized(int width, int height);
     ViewLayoutMode GetViewLayout() const { return m_viewLayout; }
+    void SetSplitViewWaterMode(SplitViewWaterMode mode);
+    SplitViewWaterMode GetSplitViewWaterMode() const { return m_splitViewWaterMode; }
+    void SetWaterRefractionSource(WaterRefractionSource source);
+    WaterRefractionSource GetWaterRefractionSource() const { return m_waterRefractionSource; }
 
 private:
+    struct InstanceBatch {
+        std::shared_ptr<SceneNode> node;
+        std::shared_ptr<Engine::IAL::I_Mesh> mesh;
+        std::vector<Matrix4> transforms;
+        bool hasBounds = false;
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+    };
+
+    struct WaterTargets {
+        std::shared_ptr<Engine::IAL::I_FrameBuffer> reflection;
+        std::shared_ptr<Engine::IAL::I_FrameBuffer> refraction;
+        Matrix4* reflectionViewProj = nullptr;
+        int reflectionWidth = 0;
+        int reflectionHeight = 0;
+        int refractionWidth = 0;
+        int refractionHeight = 0;
+        bool refractionFromScene = false;
+    };
+
+    struct GpuPassTimer {
+        std::array<unsigned int, 3> queries{};
+        std::array<bool, 3> pending{};
+        std::size_t index = 0;
+        float gpuMs = 0.0f;
+    };
+
+    struct ViewportStats {
+        float cpuMs = 0.0f;
+        float gpuMs = 0.0f;
+        std::size_t submissions = 0;
+        std::size_t culled = 0;
+        SplitViewWaterMode water = SplitViewWaterMode::Full;
+    };
+
+    enum class ShadowCasterSet {
+        All,
+        Static,
+        Dynamic
+    };
+
+    struct ShadowCascadeStats {
+        std::size_t draws = 0;
+        std::size_t triangles = 0;
+        std::size_t culled = 0;
+        std::size_t vertexBytes = 0;
+        std::size_t vertexBytesSaved = 0;
+    };
+
+    static constexpr std::size_t kViewportCount = 4;
+    static constexpr std::size_t kViewportTimerFrames = 3;
+    static constexpr float kFieldOfView = 35.0f;
+    static constexpr std::size_t kGrassFieldCacheSize = 2;
+
+    void RenderShadowCascades(const Matrix4& cameraView);
     void RenderSceneForShadowMap(const Matrix4& lightViewProjection,
-                                 bool skipWaterNode);
+                                 bool skipWaterNode,
+                                 ShadowCascadeStats& stats,
+                                 ShadowCasterSet casters = ShadowCasterSet::All);
+    std::uint64_t ComputeStaticShadowSignature() const;
+    static void AccumulateDepthFetch(const Engine::IAL::I_Mesh& mesh,
+                                     std::size_t instances,
+                                     ShadowCascadeStats& stats);
     void RenderSkybox(const Matrix4& view, const Matrix4& projection);
     void RenderScenePass(const Matrix4& view,
                          const Matrix4& projection,
                          const Vector3& cameraPosition,
                          bool skipWaterNode,
                          RenderDebugMode mode,
-                         const Vector4* clipPlane = nullptr);
+                         const Vector4* clipPlane = nullptr,
+                         bool hardwareClip = true);
     void RenderWaterSurface(const Matrix4& view,
                             const Matrix4& projection,
                             const Vector3& cameraPosition,
-                            RenderDebugMode mode);
+                            RenderDebugMode mode,
+                            const WaterTargets& targets);
     void RenderReflectionPass(const Matrix4& projection,
                                const Vector3& cameraPosition,
                                float cameraYaw,
-                               float cameraPitch);
+                               float cameraPitch,
+                               const WaterTargets& targets);
     void RenderRefractionPass(const Matrix4& view,
                                const Matrix4& projection,
-                               const Vector3& cameraPosition);
+                               const Vector3& cameraPosition,
+                               const WaterTargets& targets);
     void RenderRain(const Matrix4& view,
                     const Matrix4& projection,
                     const Vector3& cameraPosition,
@@ -125,11 +260,47 @@ private:
     Vector3 GetFogColor() const;
     float GetFogDensity() const;
     void UpdateViewRangeFromTerrain();
+    void RefreshGrassField();
     void BindBonePalette(const std::vector<Matrix4>& bones, int boneCount);
     void UnbindBonePalette();
     void EnsureBoneBufferCapacity(std::size_t requiredCount);
+    void PrepareFrameQueue();
+    void BuildInstanceBatches(bool skipWaterNode);
+    std::size_t CullInstances(const InstanceBatch& batch, const Frustum& frustum);
+    bool BuildOcclusionBuffer(const Matrix4& viewProj);
+    bool BeginHorizonPass(const Vector3& cameraPosition, const Vector4* clipPlane);
+    bool PassesOcclusion(const Matrix4& model, const Vector3& localMin, const Vector3& localMax);
+    void UploadInstanceMatrices(const std::vector<Matrix4>& transforms);
+    void UpdateLightClusters(const Matrix4& view, const Matrix4& projection);
+    static void UploadClusterBuffer(unsigned int& buffer, std::size_t& capacity, const void* data, std::size_t bytes,
+                                    unsigned int binding);
+    bool BeginGpuTimer(GpuPassTimer& timer);
+    void EndGpuTimer(GpuPassTimer& timer);
+    static void ReleaseGpuTimer(GpuPassTimer& timer);
+    void RecreateWaterTargets();
+    static bool MakeObliqueProjection(const Matrix4& projection,
+                                      const Matrix4& view,
+                                      const Vector4& worldPlane,
+                                      Matrix4& outProjection);
+    void CopySceneForRefraction(const WaterTargets& targets);
+    bool IsWaterVisible(const Matrix4& viewProj, const Vector3& cameraPosition, bool occlusion);
+    bool ShouldRefreshReflection(const WaterTargets& targets, const Vector3& cameraPosition, float cameraYaw,
+                                 float cameraPitch);
+    void ApplySceneUniforms(const std::shared_ptr<Engine::IAL::I_Shader>& shader,
+                            const Matrix4& view,
+                            const Matrix4& viewProj,
+                            const Vector4& clip,
+                            const Vector3& cameraPosition,
+                            RenderDebugMode mode,
+                            bool hasShadow);
+    void DrawWithMaterials(const std::shared_ptr<Engine::IAL::I_Shader>& shader,
+                           const std::shared_ptr<SceneNode>& node,
+                           const std::shared_ptr<Engine::IAL::I_Mesh>& mesh,
+                           const std::shared_ptr<Engine::IAL::I_Texture>& shadowTexture,
+                           int instanceCount);
     Engine::IAL::PBRMaterial ResolveMaterial(const std::shared_ptr<SceneNode>& node,
-                                             const std::shared_ptr<Engine::IAL::I_Mesh>& mesh) const;
+                                             const std::shared_ptr<Engine::IAL::I_Mesh>& mesh,
+                                             int subMesh = -1) const;
     static int ToAlphaModeValue(Engine::IAL::AlphaMode mode);
     void RenderSingleView(float deltaTime);
     void RenderQuadView(float deltaTime);
@@ -139,7 +310,11 @@ private:
                             int viewportY,
                             int viewportWidth,
                             int viewportHeight,
-                            bool allowTransition);
+                            bool allowTransition,
+                            SplitViewWaterMode waterMode);
+    WaterTargets ResolveWaterTargets(SplitViewWaterMode waterMode);
+    void BeginViewportStats(std::size_t viewport, SplitViewWaterMode waterMode);
+    void EndViewportStats(std::size_t viewport);
     int ToShaderDebugMode(RenderDebugMode mode) const;
     void ApplyPolygonMode(RenderDebugMode mode, int& previousFront, int& previousBack) const;
     void RestorePolygonMode(RenderDebugMode mode, int previousFront, int previousBack) const;
@@ -150,6 +325,7 @@ private:
     std::shared_ptr<SceneGraph> m_sceneGraph;
     std::shared_ptr<Camera> m_camera;
     std::shared_ptr<Engine::IAL::I_DebugUI> m_debugUI;
+    std::vector<std::shared_ptr<SceneNode>> m_frameNodes;
     std::vector<std::shared_ptr<SceneNode>> m_renderQueue;
     std::shared_ptr<PostProcessing> m_postProcessing;
     std::shared_ptr<Engine::IAL::I_Shader> m_sceneShader;
@@ -159,13 +335,18 @@ private:
     std::shared_ptr<Engine::IAL::I_Shader> m_waterShader;
     std::shared_ptr<Engine::IAL::I_Shader> m_shadowShader;
     std::shared_ptr<Engine::IAL::I_Shader> m_skinnedShader;
+    std::shared_ptr<Engine::IAL::I_Shader> m_sceneInstancedShader;
+    std::shared_ptr<Engine::IAL::I_Shader> m_terrainInstancedShader;
+    std::shared_ptr<Engine::IAL::I_Shader> m_shadowInstancedShader;
     std::shared_ptr<Engine::IAL::I_Texture> m_skyboxTexture;
     std::shared_ptr<Engine::IAL::I_Mesh> m_skyboxMesh;
     std::shared_ptr<Engine::IAL::I_FrameBuffer> m_waterReflectionFBO;
     std::shared_ptr<Engine::IAL::I_FrameBuffer> m_waterRefractionFBO;
+    std::shared_ptr<Engine::IAL::I_FrameBuffer> m_splitWaterReflectionFBO;
+    std::shared_ptr<Engine::IAL::I_FrameBuffer> m_splitWaterRefractionFBO;
     std::shared_ptr<ShadowMap> m_shadowMap;
     std::shared_ptr<Water> m_water;
-    std::vector<Light> m_pointLights;
+    std::unique_ptr<LightClusterer> m_lightClusterer;
     Light m_directionalLight;
     Vector3 m_sceneColour;
     float m_specularPower;
@@ -175,15 +356,58 @@ private:
     int m_surfaceHeight;
     bool m_transitionEnabled;
     float m_transitionProgress;
-    Matrix4 m_shadowMatrix;
+    std::array<ShadowCascadeStats, ShadowMap::kMaxCascades> m_shadowCascadeStats;
     Matrix4 m_reflectionViewProj;
+    Matrix4 m_splitReflectionViewProj;
     float m_shadowStrength;
     unsigned int m_bonePaletteBuffer;
     std::size_t m_boneCapacity;
+    std::vector<InstanceBatch> m_instanceBatches;
+    std::vector<Matrix4> m_visibleInstances;
+    unsigned int m_instanceBuffer;
+    std::size_t m_instanceCapacity;
+    unsigned int m_clusterLightBuffer;
+    std::size_t m_clusterLightCapacity;
+    unsigned int m_clusterRangeBuffer;
+    std::size_t m_clusterRangeCapacity;
+    unsigned int m_clusterIndexBuffer;
+    std::size_t m_clusterIndexCapacity;
+    GpuPassTimer m_terrainTimer;
+    bool m_terrainTimedThisFrame;
+    GpuPassTimer m_reflectionTimer;
+    GpuPassTimer m_refractionTimer;
+    GpuPassTimer m_shadowPrefilterTimer;
+    WaterRefractionSource m_waterRefractionSource;
+    std::shared_ptr<Engine::IAL::I_FrameBuffer> m_sceneCopyFBO;
+    float m_waterAbsorption;
+    float m_waterReflectionScale;
+    float m_waterRefractionScale;
+    int m_reflectionRefreshInterval;
+    bool m_waterVisibilityGate;
+    bool m_reflectionReusable;
+    int m_reflectionAge;
+    Vector3 m_reflectionCameraPosition;
+    float m_reflectionCameraYaw;
+    float m_reflectionCameraPitch;
+    bool m_reflectionRefreshedThisFrame;
+    std::size_t m_waterViewsSkipped;
+    std::size_t m_currentViewport;
+    std::unique_ptr<OcclusionCuller> m_occlusionCuller;
+    bool m_occlusionCullingEnabled;
+    bool m_occlusionActive;
+    std::size_t m_occlusionTested;
+    std::size_t m_occlusionCulled;
+    std::unique_ptr<TerrainHorizon> m_terrainHorizon;
+    bool m_horizonCullingEnabled;
+    bool m_horizonActive;
+    std::size_t m_horizonCulled;
+    std::size_t m_waterPlaneCulled;
     float m_environmentIntensity;
     float m_environmentMaxLod;
     std::shared_ptr<Engine::IAL::I_Heightmap> m_activeHeightmap;
-    std::unique_ptr<GrassField> m_grassField;
+    std::shared_ptr<GrassField> m_grassField;
+    // 最近使用的在前；条目持有高度图的强引用，地址不会被复用，最多额外保留 kGrassFieldCacheSize - 1 张高度图
+    std::vector<std::shared_ptr<GrassField>> m_grassFieldCache;
     std::unique_ptr<RainSystem> m_rainSystem;
     float m_timeAccumulator;
     std::shared_ptr<Engine::IAL::I_Texture> m_grassBaseTextureOverride;
@@ -192,4 +416,12 @@ private:
     ViewLayoutMode m_viewLayout;
     RenderDebugMode m_defaultViewMode;
     std::array<std::shared_ptr<Camera>, 3> m_splitCameras;
+    SplitViewWaterMode m_splitViewWaterMode;
+    std::size_t m_sceneSubmissions;
+    std::array<ViewportStats, kViewportCount> m_viewportStats;
+    std::array<std::chrono::high_resolution_clock::time_point, kViewportCount> m_viewportCpuStart;
+    std::array<std::size_t, kViewportCount> m_viewportCulledStart;
+    std::array<unsigned int, kViewportCount * kViewportTimerFrames * 2> m_viewportTimerQueries;
+    std::array<bool, kViewportCount * kViewportTimerFrames> m_viewportTimerPending;
+    std::size_t m_viewportTimerFrame;
 };
\ No newline at end of file
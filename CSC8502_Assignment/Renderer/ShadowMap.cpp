@@ -1,29 +1,223 @@
 ﻿/**
  * @file ShadowMap.cpp
- * @brief 实现用于生成方向光阴影贴图的 ShadowMap 封装类。
+ * @brief 实现方向光级联阴影贴图（CSM）的 ShadowMap 封装类。
  */
 #include "ShadowMap.h"
 
+#include "../Engine/IAL/I_Mesh.h"
+#include "../Engine/IAL/I_Shader.h"
+
+#include "nclgl/Vector4.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include <glad/glad.h>
 
 ShadowMap::ShadowMap(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factory,
-                     int width,
-                     int height)
+                     int cascadeResolution)
     : m_factory(factory)
     , m_fbo(nullptr)
     , m_depthTexture(nullptr)
-    , m_lightViewProjection()
-    , m_width(width)
-    , m_height(height) {
-    m_lightViewProjection.ToIdentity();
-    RecreateResources(width, height);
+    , m_staticFbo(nullptr)
+    , m_momentFbo(nullptr)
+    , m_blurFbo(nullptr)
+    , m_momentShader(nullptr)
+    , m_fullscreenQuad(nullptr)
+    , m_filterPreset(FilterPreset::Hardware)
+    , m_cascadeViewProjections()
+    , m_staticViewProjections()
+    , m_staticValid{}
+    , m_staticSignature(0)
+    , m_staticRebuilds(0)
+    , m_staticCaching(true)
+    , m_splitDistances{}
+    , m_cascadeResolution(cascadeResolution)
+    , m_cascadeCount(kMaxCascades)
+    , m_splitLambda(0.75f)
+    , m_shadowDistance(3000.0f) {
+    for (auto& matrix : m_cascadeViewProjections) {
+        matrix.ToIdentity();
+    }
+    if (m_factory) {
+        m_momentShader = m_factory->CreateShader("Shared/postprocess.vert", "Shared/shadow_moments.frag");
+        m_fullscreenQuad = m_factory->CreateQuad();
+    }
+    RecreateResources(cascadeResolution);
 }
 
-void ShadowMap::Resize(int width, int height) {
-    if (width == m_width && height == m_height) {
+void ShadowMap::SetCascadeCount(int count) {
+    m_cascadeCount = std::clamp(count, 1, kMaxCascades);
+}
+
+void ShadowMap::SetStaticCaching(bool enabled) {
+    m_staticCaching = enabled;
+    m_staticValid.fill(false);
+    if (!enabled) {
+        m_staticFbo.reset();
+    }
+    else if (!m_staticFbo && m_factory) {
+        m_staticFbo = m_factory->CreateShadowFBO(m_cascadeResolution * 2, m_cascadeResolution * 2);
+    }
+}
+
+void ShadowMap::SetFilterPreset(FilterPreset preset) {
+    if (preset == m_filterPreset) {
         return;
     }
-    RecreateResources(width, height);
+    m_filterPreset = preset;
+    ConfigureDepthTexture();
+    RecreateMomentResources();
+}
+
+const char* ShadowMap::GetFilterPresetName(FilterPreset preset) {
+    switch (preset) {
+    case FilterPreset::Hardware:
+        return "Hardware";
+    case FilterPreset::EvsmFast:
+        return "EVSM Fast";
+    case FilterPreset::EvsmQuality:
+        return "EVSM Quality";
+    }
+    return "Unknown";
+}
+
+ShadowMap::FilterSettings ShadowMap::GetFilterSettings(FilterPreset preset) {
+    // 32 位浮点下 exp(2c) 不溢出的上限约为 c = 44；负指数只需抑制正指数无法消除的漏光
+    switch (preset) {
+    case FilterPreset::EvsmFast:
+        return {2, 1, 40.0f, 0.0f, 0.3f, 1.0f};
+    case FilterPreset::EvsmQuality:
+        return {4, 2, 40.0f, 10.0f, 0.2f, 8.0f};
+    case FilterPreset::Hardware:
+    default:
+        return {0, 0, 0.0f, 0.0f, 0.0f, 1.0f};
+    }
+}
+
+int ShadowMap::GetShaderFilterMode() const {
+    // 与着色器中的 uShadowFilter 对应：0 深度比较，1 EVSM2，2 EVSM4
+    if (!m_momentFbo) {
+        return 0;
+    }
+    return GetFilterSettings(m_filterPreset).momentComponents == 4 ? 2 : 1;
+}
+
+Vector3 ShadowMap::GetEvsmParameters() const {
+    const FilterSettings settings = GetFilterSettings(m_filterPreset);
+    return Vector3(settings.positiveExponent, settings.negativeExponent, settings.lightBleedReduction);
+}
+
+void ShadowMap::SetSplitLambda(float lambda) {
+    m_splitLambda = std::clamp(lambda, 0.0f, 1.0f);
+}
+
+void ShadowMap::SetShadowDistance(float distance) {
+    m_shadowDistance = std::max(distance, 1.0f);
+}
+
+void ShadowMap::UpdateCascades(const Vector3& lightDirection,
+                               const Matrix4& cameraView,
+                               float fieldOfView,
+                               float aspect,
+                               float nearPlane) {
+    const float nearDistance = std::max(nearPlane, 0.01f);
+    const float farDistance = std::max(m_shadowDistance, nearDistance + 1.0f);
+    for (int i = 0; i < m_cascadeCount; ++i) {
+        const float t = static_cast<float>(i + 1) / static_cast<float>(m_cascadeCount);
+        const float logSplit = nearDistance * std::pow(farDistance / nearDistance, t);
+        const float uniformSplit = nearDistance + (farDistance - nearDistance) * t;
+        m_splitDistances[i] = m_splitLambda * logSplit + (1.0f - m_splitLambda) * uniformSplit;
+    }
+
+    // 光源空间只含旋转，级联的平移全部放进正交投影的边界，便于按纹素取整
+    Vector3 direction = lightDirection;
+    direction.Normalise();
+    const Vector3 up = std::abs(direction.y) > 0.99f ? Vector3(0.0f, 0.0f, 1.0f) : Vector3(0.0f, 1.0f, 0.0f);
+    const Matrix4 lightView = Matrix4::BuildViewMatrix(Vector3(0.0f, 0.0f, 0.0f), direction, up);
+    const Matrix4 inverseCameraView = cameraView.Inverse();
+    const float tanHalfFov = std::tan(fieldOfView * 0.5f * 3.14159265f / 180.0f);
+
+    float sliceNear = nearDistance;
+    for (int i = 0; i < m_cascadeCount; ++i) {
+        const float sliceFar = m_splitDistances[i];
+        // 切片角点在观察空间中关于视线轴对称，包围球中心落在视线轴上，半径与相机朝向无关
+        const float nearHalfHeight = sliceNear * tanHalfFov;
+        const float farHalfHeight = sliceFar * tanHalfFov;
+        const float nearCornerSq = nearHalfHeight * nearHalfHeight * (1.0f + aspect * aspect);
+        const float farCornerSq = farHalfHeight * farHalfHeight * (1.0f + aspect * aspect);
+        // 球心 z 取使近、远角点等距的位置，并限制在切片范围内
+        float centreDepth = 0.5f * (sliceNear + sliceFar) + (farCornerSq - nearCornerSq) / (2.0f * (sliceFar - sliceNear));
+        centreDepth = std::clamp(centreDepth, sliceNear, sliceFar);
+        const float nearOffset = centreDepth - sliceNear;
+        const float farOffset = sliceFar - centreDepth;
+        float radius = std::sqrt(std::max(nearOffset * nearOffset + nearCornerSq, farOffset * farOffset + farCornerSq));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        if (m_staticCaching) {
+            // 取整偏移最多为步长的 √3/2 倍（三个轴都取整）
+            radius /= 1.0f - 0.8660254f * 2.0f / static_cast<float>(kCacheSnapDivisions);
+        }
+
+        const Vector3 worldCentre = inverseCameraView * Vector3(0.0f, 0.0f, -centreDepth);
+        Vector3 lightCentre = lightView * worldCentre;
+        const float texelSize = 2.0f * radius / static_cast<float>(m_cascadeResolution);
+        const float snapSize = m_staticCaching
+            ? texelSize * static_cast<float>(m_cascadeResolution / kCacheSnapDivisions)
+            : texelSize;
+        lightCentre.x = std::floor(lightCentre.x / snapSize) * snapSize;
+        lightCentre.y = std::floor(lightCentre.y / snapSize) * snapSize;
+        if (m_staticCaching) {
+            lightCentre.z = std::floor(lightCentre.z / snapSize) * snapSize;
+        }
+
+        const float depth = -lightCentre.z;
+        const Matrix4 projection = Matrix4::Orthographic(depth - radius - kCasterMargin,
+                                                         depth + radius,
+                                                         lightCentre.x + radius,
+                                                         lightCentre.x - radius,
+                                                         lightCentre.y + radius,
+                                                         lightCentre.y - radius);
+        m_cascadeViewProjections[i] = projection * lightView;
+        sliceNear = sliceFar;
+    }
+}
+
+bool ShadowMap::PrepareStaticCascade(int cascade, std::uint64_t staticSignature) {
+    if (!m_staticCaching || !m_staticFbo) {
+        return false;
+    }
+    if (staticSignature != m_staticSignature) {
+        m_staticValid.fill(false);
+        m_staticSignature = staticSignature;
+    }
+    const std::size_t index = static_cast<std::size_t>(cascade);
+    const Matrix4& current = m_cascadeViewProjections[index];
+    if (m_staticValid[index] &&
+        std::equal(current.values, current.values + 16, m_staticViewProjections[index].values)) {
+        return false;
+    }
+    m_staticViewProjections[index] = current;
+    m_staticValid[index] = true;
+    ++m_staticRebuilds;
+    return true;
+}
+
+void ShadowMap::BeginStaticCapture() {
+    if (m_staticFbo) {
+        m_staticFbo->Bind();
+    }
+}
+
+void ShadowMap::BeginStaticCascade(int cascade) {
+    SetCascadeViewport(cascade);
+    // 只清除需要重建的图集块，其余级联的缓存保持不变
+    glEnable(GL_SCISSOR_TEST);
+    glScissor((cascade % 2) * m_cascadeResolution,
+              (cascade / 2) * m_cascadeResolution,
+              m_cascadeResolution,
+              m_cascadeResolution);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
 }
 
 void ShadowMap::BeginCapture() {
@@ -31,8 +225,29 @@ void ShadowMap::BeginCapture() {
         return;
     }
     m_fbo->Bind();
-    glViewport(0, 0, m_width, m_height);
-    glClear(GL_DEPTH_BUFFER_BIT);
+    glViewport(0, 0, m_cascadeResolution * 2, m_cascadeResolution * 2);
+    auto staticDepth = m_staticCaching && m_staticFbo ? m_staticFbo->GetDepthTexture() : nullptr;
+    if (staticDepth && m_depthTexture) {
+        // 以静态深度为底，调用方只需再绘制动态投射体
+        glCopyImageSubData(staticDepth->GetID(), GL_TEXTURE_2D, 0, 0, 0, 0,
+                           m_depthTexture->GetID(), GL_TEXTURE_2D, 0, 0, 0, 0,
+                           m_cascadeResolution * 2, m_cascadeResolution * 2, 1);
+    }
+    else {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+}
+
+void ShadowMap::BeginCascade(int cascade) {
+    SetCascadeViewport(cascade);
+}
+
+void ShadowMap::SetCascadeViewport(int cascade) const {
+    // 图集块顺序与着色器中的 vec2(i % 2, i / 2) 一致
+    glViewport((cascade % 2) * m_cascadeResolution,
+               (cascade / 2) * m_cascadeResolution,
+               m_cascadeResolution,
+               m_cascadeResolution);
 }
 
 void ShadowMap::EndCapture() {
@@ -42,40 +257,118 @@ void ShadowMap::EndCapture() {
     m_fbo->Unbind();
 }
 
+void ShadowMap::Prefilter() {
+    if (!m_momentFbo || !m_blurFbo || !m_momentShader || !m_fullscreenQuad || !m_depthTexture) {
+        return;
+    }
+    auto blurTexture = m_blurFbo->GetColorTexture();
+    auto momentTexture = m_momentFbo->GetColorTexture();
+    if (!blurTexture || !momentTexture) {
+        return;
+    }
+    const FilterSettings settings = GetFilterSettings(m_filterPreset);
+    const float last = static_cast<float>(m_cascadeResolution - 1);
+
+    GLboolean depthWasEnabled = GL_FALSE;
+    glGetBooleanv(GL_DEPTH_TEST, &depthWasEnabled);
+    glDisable(GL_DEPTH_TEST);
+    m_momentShader->Bind();
+    m_momentShader->SetUniform("uSource", 0);
+    m_momentShader->SetUniform("uRadius", settings.blurRadius);
+    m_momentShader->SetUniform("uPositiveExponent", settings.positiveExponent);
+    m_momentShader->SetUniform("uNegativeExponent", settings.negativeExponent);
+    for (int i = 0; i < m_cascadeCount; ++i) {
+        const float tileX = static_cast<float>((i % 2) * m_cascadeResolution);
+        const float tileY = static_cast<float>((i / 2) * m_cascadeResolution);
+
+        // 横向：深度图集块 -> 临时目标，逐样本做指数变换后再平均
+        m_blurFbo->Bind();
+        glViewport(0, 0, m_cascadeResolution, m_cascadeResolution);
+        m_depthTexture->Bind(0);
+        m_momentShader->SetUniform("uFromDepth", 1);
+        m_momentShader->SetUniform("uSourceRect", Vector4(tileX, tileY, tileX + last, tileY + last));
+        m_momentShader->SetUniform("uOffsetAndStep", Vector4(tileX, tileY, 1.0f, 0.0f));
+        m_fullscreenQuad->Draw();
+
+        // 纵向：临时目标 -> 矩图集块
+        m_momentFbo->Bind();
+        SetCascadeViewport(i);
+        blurTexture->Bind(0);
+        m_momentShader->SetUniform("uFromDepth", 0);
+        m_momentShader->SetUniform("uSourceRect", Vector4(0.0f, 0.0f, last, last));
+        m_momentShader->SetUniform("uOffsetAndStep", Vector4(-tileX, -tileY, 0.0f, 1.0f));
+        m_fullscreenQuad->Draw();
+    }
+    m_momentShader->Unbind();
+    m_momentFbo->Unbind();
+    if (depthWasEnabled == GL_TRUE) {
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    // 图集块边长是 2 的幂，kMomentMaxLevel 级以内的 mip 纹素不会跨越两个级联
+    glBindTexture(GL_TEXTURE_2D, momentTexture->GetID());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 std::shared_ptr<Engine::IAL::I_Texture> ShadowMap::GetDepthTexture() const {
     return m_depthTexture;
 }
 
-const Matrix4& ShadowMap::GetLightViewProjection() const {
-    return m_lightViewProjection;
+std::shared_ptr<Engine::IAL::I_Texture> ShadowMap::GetMomentTexture() const {
+    return m_momentFbo ? m_momentFbo->GetColorTexture() : nullptr;
 }
 
-void ShadowMap::UpdateLight(const Vector3& lightPosition,
-                            const Vector3& focusPoint,
-                            float nearPlane,
-                            float farPlane,
-                            float orthoSize) {
-    Matrix4 view = Matrix4::BuildViewMatrix(lightPosition, focusPoint, Vector3(0.0f, 1.0f, 0.0f));
-    Matrix4 projection = Matrix4::Orthographic(nearPlane,
-                                               farPlane,
-                                               orthoSize,
-                                               -orthoSize,
-                                               orthoSize,
-                                               -orthoSize);
-    m_lightViewProjection = projection * view;
+const Matrix4& ShadowMap::GetCascadeViewProjection(int cascade) const {
+    return m_cascadeViewProjections[static_cast<std::size_t>(std::clamp(cascade, 0, kMaxCascades - 1))];
 }
 
-void ShadowMap::RecreateResources(int width, int height) {
-    m_width = width;
-    m_height = height;
+float ShadowMap::GetSplitDistance(int cascade) const {
+    return m_splitDistances[static_cast<std::size_t>(std::clamp(cascade, 0, kMaxCascades - 1))];
+}
+
+void ShadowMap::RecreateResources(int cascadeResolution) {
+    m_cascadeResolution = cascadeResolution;
+    m_staticValid.fill(false);
     if (!m_factory) {
         m_fbo.reset();
         m_depthTexture.reset();
+        m_staticFbo.reset();
+        m_momentFbo.reset();
+        m_blurFbo.reset();
         return;
     }
-    m_fbo = m_factory->CreateShadowFBO(width, height);
+    m_fbo = m_factory->CreateShadowFBO(cascadeResolution * 2, cascadeResolution * 2);
     m_depthTexture = m_fbo ? m_fbo->GetDepthTexture() : nullptr;
     ConfigureDepthTexture();
+    // 静态图集只作为拷贝源，不需要比较采样状态
+    m_staticFbo = m_staticCaching ? m_factory->CreateShadowFBO(cascadeResolution * 2, cascadeResolution * 2) : nullptr;
+    RecreateMomentResources();
+}
+
+void ShadowMap::RecreateMomentResources() {
+    m_momentFbo.reset();
+    m_blurFbo.reset();
+    const FilterSettings settings = GetFilterSettings(m_filterPreset);
+    if (!m_factory || settings.momentComponents == 0) {
+        return;
+    }
+    const int atlasSize = m_cascadeResolution * 2;
+    m_momentFbo = m_factory->CreateShadowMomentFBO(atlasSize, atlasSize, settings.momentComponents);
+    // 临时目标只容纳一个级联，横向结果逐级联复用
+    m_blurFbo = m_factory->CreateShadowMomentFBO(m_cascadeResolution, m_cascadeResolution, settings.momentComponents);
+    auto momentTexture = m_momentFbo ? m_momentFbo->GetColorTexture() : nullptr;
+    if (!momentTexture || !m_blurFbo) {
+        m_momentFbo.reset();
+        m_blurFbo.reset();
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, momentTexture->GetID());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, kMomentMaxLevel);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, settings.anisotropy);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void ShadowMap::ConfigureDepthTexture() {
@@ -83,7 +376,9 @@ void ShadowMap::ConfigureDepthTexture() {
         return;
     }
     glBindTexture(GL_TEXTURE_2D, m_depthTexture->GetID());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    // 预过滤模式下由矩生成着色器读取原始深度，不能开启比较模式
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE,
+                    m_filterPreset == FilterPreset::Hardware ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
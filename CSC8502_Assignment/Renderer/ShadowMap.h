@@ -1,15 +1,45 @@
-﻿
-/**
+﻿/**
  * @file ShadowMap.h
- * @brief 声明用于生成方向光阴影贴图的 ShadowMap 封装类。
+ * @brief 声明方向光级联阴影贴图（CSM）的 ShadowMap 封装类。
  * @details
  * ShadowMap 负责通过资源工厂创建阴影专用的帧缓冲对象，
- * 维护光源视图投影矩阵，并提供捕获深度图的生命周期函数。
- * 渲染器在 Day16 阶段使用该类完成阴影预渲染，并在主场景着色
- * 时复用深度纹理与光源矩阵以计算阴影遮蔽。
+ * 维护各级联的光源视图投影矩阵，并提供捕获深度图的生命周期函数。
+ * 渲染器每帧先调用 UpdateCascades 按主相机视锥拟合级联，再逐级联渲染阴影投射体，
+ * 主场景着色时复用深度纹理与各级联矩阵计算阴影遮蔽。
+ *
+ * 图集布局:
+ * 最多 kMaxCascades 个级联共用一张 2 × 2 的深度图集，每块为 cascadeResolution²，
+ * 因此仍是普通的二维深度纹理，采样器与帧缓冲接口都无需改动。
+ * 着色器按 uShadowMatrices 依次投影，选取第一个包含该点的级联，再换算到对应的图集块。
+ *
+ * 分割与拟合:
+ * 分割距离按实用分割法计算：对数分割与均匀分割以 splitLambda 线性混合，覆盖相机近平面到 shadowDistance。
+ * 每个级联取视锥切片 8 个角点的包围球，半径只取决于切片形状，相机旋转时保持不变；
+ * 包围球中心在光源空间按纹素大小取整，相机平移时阴影边缘不会闪烁。
+ * 正交投影的近平面向光源方向额外延伸 kCasterMargin，以纳入切片之外的遮挡物。
+ *
+ * 静态缓存:
+ * 启用 SetStaticCaching 后，静态投射体的深度保存在独立的图集 m_staticFbo 中。
+ * PrepareStaticCascade 比较级联矩阵与调用方给出的静态几何签名，二者都未变化时沿用缓存，
+ * 否则由调用方重绘该级联并计入 GetStaticRebuildCount。BeginCapture 把静态图集整体拷贝到
+ * 每帧使用的图集上，调用方随后只需叠加动态投射体。
+ * 缓存模式下级联中心按 1/kCacheSnapDivisions 的级联宽度取整（而不是单个纹素），
+ * 相机小幅移动或转动时级联保持不动；半径相应放大以覆盖取整偏移，代价是约 12% 的纹素密度。
+ *
+ * 预过滤（EVSM）:
+ * FilterPreset::Hardware 保持深度比较采样（每个片元一次双线性比较）。
+ * EvsmFast / EvsmQuality 在 Prefilter 中把深度图集转换为指数方差阴影的矩图集：
+ * 每个级联先横向读取深度、做指数变换并模糊到一块 cascadeResolution² 的临时目标，
+ * 再纵向模糊写回矩图集对应的图集块，两遍都把采样限制在本级联块内；最后生成 kMomentMaxLevel 级 mipmap。
+ * 接收者只需一次三线性（可各向异性）采样，再用切比雪夫上界求可见度。
+ * 预设的矩数量、指数、模糊半径与漏光抑制见 GetFilterSettings；切换预设时重建矩图集并
+ * 改变深度纹理的比较模式（矩生成需要读原始深度）。
  */
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 #include "../Engine/IAL/I_FrameBuffer.h"
@@ -20,32 +50,91 @@
 
 class ShadowMap {
 public:
+    static constexpr int kMaxCascades = 4;
+    static constexpr float kCasterMargin = 1500.0f;
+    static constexpr int kCacheSnapDivisions = 16;
+    static constexpr int kMomentMaxLevel = 3;
+
+    enum class FilterPreset {
+        Hardware,
+        EvsmFast,
+        EvsmQuality
+    };
+
     ShadowMap(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factory,
-              int width,
-              int height);
+              int cascadeResolution);
+
+    void SetCascadeCount(int count);
+    int GetCascadeCount() const { return m_cascadeCount; }
+    void SetSplitLambda(float lambda);
+    float GetSplitLambda() const { return m_splitLambda; }
+    void SetShadowDistance(float distance);
+    float GetShadowDistance() const { return m_shadowDistance; }
+    int GetCascadeResolution() const { return m_cascadeResolution; }
+    void SetStaticCaching(bool enabled);
+    bool IsStaticCaching() const { return m_staticCaching; }
+    std::size_t GetStaticRebuildCount() const { return m_staticRebuilds; }
+    void SetFilterPreset(FilterPreset preset);
+    FilterPreset GetFilterPreset() const { return m_filterPreset; }
+    static const char* GetFilterPresetName(FilterPreset preset);
+    int GetShaderFilterMode() const;
+    Vector3 GetEvsmParameters() const;
 
-    void Resize(int width, int height);
+    void UpdateCascades(const Vector3& lightDirection,
+                        const Matrix4& cameraView,
+                        float fieldOfView,
+                        float aspect,
+                        float nearPlane);
+
+    bool PrepareStaticCascade(int cascade, std::uint64_t staticSignature);
+    void BeginStaticCapture();
+    void BeginStaticCascade(int cascade);
 
     void BeginCapture();
+    void BeginCascade(int cascade);
     void EndCapture();
+    void Prefilter();
 
     std::shared_ptr<Engine::IAL::I_Texture> GetDepthTexture() const;
-    const Matrix4& GetLightViewProjection() const;
-
-    void UpdateLight(const Vector3& lightPosition,
-                     const Vector3& focusPoint,
-                     float nearPlane,
-                     float farPlane,
-                     float orthoSize);
+    std::shared_ptr<Engine::IAL::I_Texture> GetMomentTexture() const;
+    const Matrix4& GetCascadeViewProjection(int cascade) const;
+    const Matrix4* GetCascadeViewProjections() const { return m_cascadeViewProjections.data(); }
+    float GetSplitDistance(int cascade) const;
 
 private:
-    void RecreateResources(int width, int height);
+    struct FilterSettings {
+        int momentComponents;
+        int blurRadius;
+        float positiveExponent;
+        float negativeExponent;
+        float lightBleedReduction;
+        float anisotropy;
+    };
+
+    static FilterSettings GetFilterSettings(FilterPreset preset);
+    void RecreateResources(int cascadeResolution);
+    void RecreateMomentResources();
     void ConfigureDepthTexture();
+    void SetCascadeViewport(int cascade) const;
 
     std::shared_ptr<Engine::IAL::I_ResourceFactory> m_factory;
     std::shared_ptr<Engine::IAL::I_FrameBuffer> m_fbo;
     std::shared_ptr<Engine::IAL::I_Texture> m_depthTexture;
-    Matrix4 m_lightViewProjection;
-    int m_width;
-    int m_height;
+    std::shared_ptr<Engine::IAL::I_FrameBuffer> m_staticFbo;
+    std::shared_ptr<Engine::IAL::I_FrameBuffer> m_momentFbo;
+    std::shared_ptr<Engine::IAL::I_FrameBuffer> m_blurFbo;
+    std::shared_ptr<Engine::IAL::I_Shader> m_momentShader;
+    std::shared_ptr<Engine::IAL::I_Mesh> m_fullscreenQuad;
+    FilterPreset m_filterPreset;
+    std::array<Matrix4, kMaxCascades> m_cascadeViewProjections;
+    std::array<Matrix4, kMaxCascades> m_staticViewProjections;
+    std::array<bool, kMaxCascades> m_staticValid;
+    std::uint64_t m_staticSignature;
+    std::size_t m_staticRebuilds;
+    bool m_staticCaching;
+    std::array<float, kMaxCascades> m_splitDistances;
+    int m_cascadeResolution;
+    int m_cascadeCount;
+    float m_splitLambda;
+    float m_shadowDistance;
 };
\ No newline at end of file
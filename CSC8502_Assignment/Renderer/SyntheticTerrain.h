@@ -0,0 +1,106 @@
+﻿/**
+ * @file SyntheticTerrain.h
+ * @brief 声明遮挡剔除与地平线剔除基准共用的合成地形 SyntheticTerrain。
+ * @details
+ * 高度为 0.4 × (128 + 100 sin(0.0065x) cos(0.0085z) + 6 sin(0.105x + 0.085z))：
+ * 低频项给出山丘与山谷，高频项提供表面细节。分辨率 1024²，网格间距 2。
+ *
+ * GetHeightRange 是解析实现：把查询矩形扩展到与之相交的网格单元，
+ * 分别求出各正弦/余弦项在对应参数区间上的取值范围，再按区间乘法与加法合成。
+ * 结果包含连续曲面在该区域内的全部取值，因而也包含所有角点采样，是保守的包围范围；
+ * 耗时与区域面积无关，HasFastHeightRange 据此返回 true。
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "../Engine/IAL/I_Heightmap.h"
+
+class SyntheticTerrain : public Engine::IAL::I_Heightmap {
+public:
+    static constexpr float kFrequencyX = 0.0065f;
+    static constexpr float kFrequencyZ = 0.0085f;
+    static constexpr float kDetailX = 0.105f;
+    static constexpr float kDetailZ = 0.085f;
+
+    void Draw() override {
+    }
+
+    float SampleHeight(float x, float z) const override {
+        return 0.4f * (128.0f + 100.0f * std::sin(x * kFrequencyX) * std::cos(z * kFrequencyZ) +
+                       6.0f * std::sin(x * kDetailX + z * kDetailZ));
+    }
+
+    Vector3 GetWorldScale() const override {
+        return Vector3(2.0f, 0.4f, 2.0f);
+    }
+
+    Vector2 GetResolution() const override {
+        return Vector2(1024.0f, 1024.0f);
+    }
+
+    bool GetHeightRange(float minX, float minZ, float maxX, float maxZ, float& outMin, float& outMax) const override {
+        const Vector2 resolution = GetResolution();
+        const Vector3 scale = GetWorldScale();
+        if (minX > maxX || minZ > maxZ || maxX < 0.0f || maxZ < 0.0f ||
+            minX > (resolution.x - 1.0f) * scale.x || minZ > (resolution.y - 1.0f) * scale.z) {
+            return false;
+        }
+        // 与默认实现相同的单元范围，角点从 x0 到 x1 + 1
+        const int cellsX = static_cast<int>(resolution.x) - 1;
+        const int cellsZ = static_cast<int>(resolution.y) - 1;
+        const int x0 = std::clamp(static_cast<int>(std::floor(minX / scale.x)), 0, cellsX - 1);
+        const int x1 = std::clamp(static_cast<int>(std::floor(maxX / scale.x)), 0, cellsX - 1);
+        const int z0 = std::clamp(static_cast<int>(std::floor(minZ / scale.z)), 0, cellsZ - 1);
+        const int z1 = std::clamp(static_cast<int>(std::floor(maxZ / scale.z)), 0, cellsZ - 1);
+        const float worldX0 = x0 * scale.x;
+        const float worldX1 = (x1 + 1) * scale.x;
+        const float worldZ0 = z0 * scale.z;
+        const float worldZ1 = (z1 + 1) * scale.z;
+
+        float sinLo = 0.0f;
+        float sinHi = 0.0f;
+        float cosLo = 0.0f;
+        float cosHi = 0.0f;
+        float detailLo = 0.0f;
+        float detailHi = 0.0f;
+        SineRange(worldX0 * kFrequencyX, worldX1 * kFrequencyX, sinLo, sinHi);
+        SineRange(worldZ0 * kFrequencyZ + kHalfPi, worldZ1 * kFrequencyZ + kHalfPi, cosLo, cosHi);
+        SineRange(worldX0 * kDetailX + worldZ0 * kDetailZ, worldX1 * kDetailX + worldZ1 * kDetailZ, detailLo, detailHi);
+
+        const float products[4] = { sinLo * cosLo, sinLo * cosHi, sinHi * cosLo, sinHi * cosHi };
+        const float productLo = std::min({ products[0], products[1], products[2], products[3] });
+        const float productHi = std::max({ products[0], products[1], products[2], products[3] });
+        // 放宽少许，吸收 SampleHeight 中 float 运算的舍入误差
+        constexpr float kRoundingMargin = 1e-3f;
+        outMin = 0.4f * (128.0f + 100.0f * productLo + 6.0f * detailLo) - kRoundingMargin;
+        outMax = 0.4f * (128.0f + 100.0f * productHi + 6.0f * detailHi) + kRoundingMargin;
+        return true;
+    }
+
+    bool HasFastHeightRange() const override {
+        return true;
+    }
+
+private:
+    static constexpr float kHalfPi = 1.57079632679f;
+    static constexpr float kTwoPi = 6.28318530718f;
+
+    // sin 在 [from, to] 上的取值范围：端点值，加上区间内出现的波峰 (π/2 + 2kπ) 与波谷 (-π/2 + 2kπ)
+    static void SineRange(float from, float to, float& outLo, float& outHi) {
+        if (to - from >= kTwoPi) {
+            outLo = -1.0f;
+            outHi = 1.0f;
+            return;
+        }
+        outLo = std::min(std::sin(from), std::sin(to));
+        outHi = std::max(std::sin(from), std::sin(to));
+        if (std::ceil((from - kHalfPi) / kTwoPi) <= std::floor((to - kHalfPi) / kTwoPi)) {
+            outHi = 1.0f;
+        }
+        if (std::ceil((from + kHalfPi) / kTwoPi) <= std::floor((to + kHalfPi) / kTwoPi)) {
+            outLo = -1.0f;
+        }
+    }
+};
@@ -0,0 +1,392 @@
+﻿/**
+ * @file TerrainHorizon.cpp
+ * @brief 实现地形地平线遮挡剔除。
+ */
+#include "TerrainHorizon.h"
+#include "SyntheticTerrain.h"
+
+#include "../Engine/IAL/I_Heightmap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include "nclgl/Vector2.h"
+
+namespace {
+    constexpr float kRingGrowth = 1.2f;
+    constexpr float kTwoPi = 6.28318530718f;
+    constexpr float kBinsPerRadian = TerrainHorizon::kAzimuthBins / kTwoPi;
+    constexpr float kNoHorizon = -std::numeric_limits<float>::max();
+
+    static_assert((TerrainHorizon::kAzimuthBins & (TerrainHorizon::kAzimuthBins - 1)) == 0,
+                  "azimuth bin count must be a power of two");
+
+    // 以多项式近似 atan2，最大误差约 1e-5 弧度；构建与查询各按 kAngleMargin 收缩/放大方位区间以保持保守
+    constexpr float kAngleMargin = 1e-4f * kBinsPerRadian;
+
+    float FastAtan2(float y, float x) {
+        const float absX = std::abs(x);
+        const float absY = std::abs(y);
+        const bool steep = absY > absX;
+        const float ratio = steep ? absX / absY : absY / std::max(absX, std::numeric_limits<float>::min());
+        const float r2 = ratio * ratio;
+        float angle = ratio * (0.99997726f + r2 * (-0.33262347f + r2 * (0.19354346f + r2 * (-0.11643287f +
+                      r2 * (0.05265332f + r2 * -0.01172120f)))));
+        if (steep) {
+            angle = 1.57079632679f - angle;
+        }
+        if (x < 0.0f) {
+            angle = 3.14159265359f - angle;
+        }
+        return y < 0.0f ? -angle : angle;
+    }
+
+    int WrapBin(int bin) {
+        return bin & (TerrainHorizon::kAzimuthBins - 1);
+    }
+
+    // 把 [first, last] 内的扇区（可跨越 0 号扇区回绕）抬高到 value，连续区段便于编译器向量化
+    void RaiseBins(float* row, int first, int last, float value) {
+        if (last < first) {
+            return;
+        }
+        const int begin = WrapBin(first);
+        const int count = std::min(last - first + 1, TerrainHorizon::kAzimuthBins);
+        const int head = std::min(count, TerrainHorizon::kAzimuthBins - begin);
+        for (int i = begin; i < begin + head; ++i) {
+            row[i] = std::max(row[i], value);
+        }
+        for (int i = 0; i < count - head; ++i) {
+            row[i] = std::max(row[i], value);
+        }
+    }
+}
+
+TerrainHorizon::TerrainHorizon() :
+    m_tilesX(0)
+    , m_tilesZ(0)
+    , m_tileWidth(0.0f)
+    , m_tileDepth(0.0f)
+    , m_extentX(0.0f)
+    , m_extentZ(0.0f)
+    , m_eye()
+    , m_built(false)
+    , m_clipMode(ClipMode::None)
+    , m_clipHeight(0.0f)
+    , m_buildMs(0.0f) {
+}
+
+void TerrainHorizon::SetTerrain(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap) {
+    m_heightmap.reset();
+    m_tileMin.clear();
+    m_ringRadii.clear();
+    m_tilesX = 0;
+    m_tilesZ = 0;
+    m_built = false;
+    if (!heightmap) {
+        return;
+    }
+    const Vector2 resolution = heightmap->GetResolution();
+    const Vector3 scale = heightmap->GetWorldScale();
+    if (resolution.x < 2.0f || resolution.y < 2.0f) {
+        return;
+    }
+    // 逐采样扫描的区间查询在大地形上过慢，只有加速实现才生成地块
+    if (!heightmap->HasFastHeightRange()) {
+        std::cerr << "[TerrainHorizon] Terrain " << resolution.x << "x" << resolution.y
+                  << " has no fast height range query, horizon culling disabled" << "\n";
+        return;
+    }
+
+    const int cellsX = static_cast<int>(resolution.x) - 1;
+    const int cellsZ = static_cast<int>(resolution.y) - 1;
+    const int tileCells = std::max(1, (std::max(cellsX, cellsZ) + kMaxTilesPerAxis - 1) / kMaxTilesPerAxis);
+    m_tilesX = (cellsX + tileCells - 1) / tileCells;
+    m_tilesZ = (cellsZ + tileCells - 1) / tileCells;
+    m_tileWidth = tileCells * scale.x;
+    m_tileDepth = tileCells * scale.z;
+    m_extentX = cellsX * scale.x;
+    m_extentZ = cellsZ * scale.z;
+    m_tileMin.assign(static_cast<std::size_t>(m_tilesX) * m_tilesZ, kNoHorizon);
+    for (int z = 0; z < m_tilesZ; ++z) {
+        for (int x = 0; x < m_tilesX; ++x) {
+            float lo = 0.0f;
+            float hi = 0.0f;
+            if (heightmap->GetHeightRange(x * m_tileWidth, z * m_tileDepth,
+                                          std::min((x + 1) * m_tileWidth, m_extentX),
+                                          std::min((z + 1) * m_tileDepth, m_extentZ), lo, hi)) {
+                m_tileMin[z * m_tilesX + x] = lo;
+            }
+        }
+    }
+
+    // 最内环约为两个地块对角线，之后按 kRingGrowth 增长到覆盖整个地形，最后一环收纳其余距离
+    const float extentDiagonal = std::sqrt(m_extentX * m_extentX + m_extentZ * m_extentZ);
+    float radius = 2.0f * std::sqrt(m_tileWidth * m_tileWidth + m_tileDepth * m_tileDepth);
+    while (radius < extentDiagonal) {
+        m_ringRadii.push_back(radius);
+        radius *= kRingGrowth;
+    }
+    m_ringRadii.push_back(std::numeric_limits<float>::max());
+    m_rings.resize(m_ringRadii.size() * kAzimuthBins);
+    m_cumulative.resize(m_rings.size());
+    m_heightmap = heightmap;
+}
+
+bool TerrainHorizon::BeginView(const Vector3& eye, ClipMode clipMode, float clipHeight) {
+    m_clipMode = clipMode;
+    m_clipHeight = clipHeight;
+    if (!m_heightmap) {
+        return false;
+    }
+    if (clipMode == ClipMode::None && eye.y < m_heightmap->SampleHeight(eye.x, eye.z)) {
+        return false;
+    }
+    if (!m_built || eye != m_eye) {
+        Build(eye);
+    }
+    return true;
+}
+
+void TerrainHorizon::Build(const Vector3& eye) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    std::fill(m_rings.begin(), m_rings.end(), kNoHorizon);
+
+    for (int tz = 0; tz < m_tilesZ; ++tz) {
+        for (int tx = 0; tx < m_tilesX; ++tx) {
+            const float tileMin = m_tileMin[tz * m_tilesX + tx];
+            if (tileMin == kNoHorizon) {
+                continue;
+            }
+            const float x0 = tx * m_tileWidth;
+            const float z0 = tz * m_tileDepth;
+            const float halfX = 0.5f * (std::min(x0 + m_tileWidth, m_extentX) - x0);
+            const float halfZ = 0.5f * (std::min(z0 + m_tileDepth, m_extentZ) - z0);
+            const float dx = x0 + halfX - eye.x;
+            const float dz = z0 + halfZ - eye.z;
+            const float centreDistance = std::sqrt(dx * dx + dz * dz);
+            // 相机在地块外接圆内时方位区间可能超过半圈，跳过
+            if (centreDistance <= std::sqrt(halfX * halfX + halfZ * halfZ)) {
+                continue;
+            }
+            const float gapX = std::max(std::abs(dx) - halfX, 0.0f);
+            const float gapZ = std::max(std::abs(dz) - halfZ, 0.0f);
+            const float farX = std::abs(dx) + halfX;
+            const float farZ = std::abs(dz) + halfZ;
+            const float nearest = std::sqrt(gapX * gapX + gapZ * gapZ);
+            const float farthest = std::sqrt(farX * farX + farZ * farZ);
+            const float rise = tileMin - eye.y;
+            const float horizon = rise / (rise >= 0.0f ? farthest : nearest);
+
+            // 内切圆张角 asin(r / d) >= r / d，用 r / d 得到的扇区一定被地块完整覆盖
+            const float centre = FastAtan2(dz, dx) * kBinsPerRadian;
+            const float half = std::min(halfX, halfZ) / centreDistance * kBinsPerRadian - kAngleMargin;
+            const int first = static_cast<int>(std::ceil(centre - half));
+            const int last = static_cast<int>(std::floor(centre + half)) - 1;
+            const std::size_t ring = static_cast<std::size_t>(
+                std::lower_bound(m_ringRadii.begin(), m_ringRadii.end(), farthest) - m_ringRadii.begin());
+            RaiseBins(&m_rings[ring * kAzimuthBins], first, last, horizon);
+        }
+    }
+
+    std::copy(m_rings.begin(), m_rings.begin() + kAzimuthBins, m_cumulative.begin());
+    for (std::size_t i = kAzimuthBins; i < m_rings.size(); ++i) {
+        m_cumulative[i] = std::max(m_cumulative[i - kAzimuthBins], m_rings[i]);
+    }
+    m_eye = eye;
+    m_built = true;
+    m_buildMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int TerrainHorizon::FirstRingBeyond(float distance) const {
+    // 第 k 环的地块最远距离大于 r(k-1)，最近距离因此大于 r(k-1) 减去地块对角线
+    const float diagonal = std::sqrt(m_tileWidth * m_tileWidth + m_tileDepth * m_tileDepth);
+    return static_cast<int>(std::lower_bound(m_ringRadii.begin(), m_ringRadii.end(), distance + diagonal) -
+                            m_ringRadii.begin()) + 1;
+}
+
+bool TerrainHorizon::IsVisible(const Vector3& worldMin, const Vector3& worldMax) const {
+    if (!m_built) {
+        return true;
+    }
+    const float halfX = 0.5f * (worldMax.x - worldMin.x);
+    const float halfZ = 0.5f * (worldMax.z - worldMin.z);
+    const float dx = worldMin.x + halfX - m_eye.x;
+    const float dz = worldMin.z + halfZ - m_eye.z;
+    const float radius = std::sqrt(halfX * halfX + halfZ * halfZ);
+    const float centreDistance = std::sqrt(dx * dx + dz * dz);
+    if (centreDistance <= radius) {
+        return true;
+    }
+    const float gapX = std::max(std::abs(dx) - halfX, 0.0f);
+    const float gapZ = std::max(std::abs(dz) - halfZ, 0.0f);
+    const float farX = std::abs(dx) + halfX;
+    const float farZ = std::abs(dz) + halfZ;
+    const float nearest = std::sqrt(gapX * gapX + gapZ * gapZ);
+    const float farthest = std::sqrt(farX * farX + farZ * farZ);
+
+    // 视线与裁剪平面交点的水平距离与 |裁剪高度 - 相机高度| / |点高度 - 相机高度| 成正比，
+    // 取包围盒可见部分中离裁剪平面最近的高度与最远水平距离得到上界
+    float top = worldMax.y;
+    int lowRing = 0;
+    if (m_clipMode == ClipMode::KeepAbove) {
+        const float bottom = std::max(worldMin.y, m_clipHeight);
+        if (m_eye.y >= m_clipHeight || top < bottom) {
+            return true;
+        }
+        lowRing = FirstRingBeyond(farthest * (m_clipHeight - m_eye.y) / (bottom - m_eye.y));
+    }
+    else if (m_clipMode == ClipMode::KeepBelow) {
+        top = std::min(top, m_clipHeight);
+        if (m_eye.y <= m_clipHeight || top < worldMin.y) {
+            return true;
+        }
+        lowRing = FirstRingBeyond(farthest * (m_eye.y - m_clipHeight) / (m_eye.y - top));
+    }
+    const int highRing = static_cast<int>(std::upper_bound(m_ringRadii.begin(), m_ringRadii.end(), nearest) -
+                                          m_ringRadii.begin()) - 1;
+    if (highRing < lowRing) {
+        return true;
+    }
+
+    const float rise = top - m_eye.y;
+    const float slope = rise / (rise >= 0.0f ? nearest : farthest);
+    const float centre = FastAtan2(dz, dx) * kBinsPerRadian;
+    const float half = std::asin(std::min(1.0f, radius / centreDistance)) * kBinsPerRadian + kAngleMargin;
+    const int first = static_cast<int>(std::floor(centre - half));
+    const int last = static_cast<int>(std::floor(centre + half));
+    if (last - first >= kAzimuthBins) {
+        return true;
+    }
+    for (int bin = first; bin <= last; ++bin) {
+        const int wrapped = WrapBin(bin);
+        float horizon = kNoHorizon;
+        if (lowRing == 0) {
+            horizon = m_cumulative[static_cast<std::size_t>(highRing) * kAzimuthBins + wrapped];
+        }
+        else {
+            for (int ring = lowRing; ring <= highRing; ++ring) {
+                horizon = std::max(horizon, m_rings[static_cast<std::size_t>(ring) * kAzimuthBins + wrapped]);
+            }
+        }
+        if (horizon <= slope) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TerrainHorizon::Benchmark() {
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int kViews = 16;
+    constexpr int kBoxesPerView = 4096;
+    constexpr std::size_t kRayChecksPerView = 256;
+    constexpr float kWaterHeight = 45.0f;
+
+    auto terrain = std::make_shared<SyntheticTerrain>();
+    TerrainHorizon horizon;
+    auto start = Clock::now();
+    horizon.SetTerrain(terrain);
+    const float setupMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+    std::mt19937 rng(1337u);
+    std::uniform_real_distribution<float> position(100.0f, 1946.0f);
+    std::uniform_real_distribution<float> boxSize(2.0f, 24.0f);
+    std::uniform_real_distribution<float> lift(0.0f, 12.0f);
+
+    const char* names[] = { "main", "reflection", "refraction" };
+    const ClipMode modes[] = { ClipMode::None, ClipMode::KeepAbove, ClipMode::KeepBelow };
+    float buildMs[3] = {};
+    float queryMs[3] = {};
+    std::size_t views[3] = {};
+    std::size_t tested[3] = {};
+    std::size_t culled[3] = {};
+    std::size_t rayChecked[3] = {};
+    std::size_t rayVisible[3] = {};
+
+    for (int view = 0; view < kViews; ++view) {
+        const float eyeX = position(rng);
+        const float eyeZ = position(rng);
+        const Vector3 from(eyeX, std::max(terrain->SampleHeight(eyeX, eyeZ), kWaterHeight) + 6.0f, eyeZ);
+        std::vector<std::pair<Vector3, Vector3>> boxes(kBoxesPerView);
+        for (auto& [boxMin, boxMax] : boxes) {
+            const float x = position(rng);
+            const float z = position(rng);
+            const float size = boxSize(rng);
+            boxMin = Vector3(x, terrain->SampleHeight(x, z) + lift(rng), z);
+            boxMax = boxMin + Vector3(size, size, size);
+        }
+
+        for (int mode = 0; mode < 3; ++mode) {
+            // 反射通道使用以水面为镜像的相机
+            const Vector3 eye = modes[mode] == ClipMode::KeepAbove
+                ? Vector3(from.x, 2.0f * kWaterHeight - from.y, from.z)
+                : from;
+            horizon.m_built = false;
+            if (!horizon.BeginView(eye, modes[mode], kWaterHeight)) {
+                continue;
+            }
+            ++views[mode];
+            buildMs[mode] += horizon.GetBuildMs();
+
+            start = Clock::now();
+            std::size_t visible = 0;
+            for (const auto& [boxMin, boxMax] : boxes) {
+                visible += horizon.IsVisible(boxMin, boxMax) ? 1 : 0;
+            }
+            queryMs[mode] += std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+            tested[mode] += boxes.size();
+            culled[mode] += boxes.size() - visible;
+
+            // 以地形射线检测为真值：被剔除的盒子的角点与中心都应被地形挡住，
+            // 有裁剪平面时射线从视线穿过裁剪平面的位置出发，被裁掉一侧的点不检查
+            std::size_t rayChecks = 0;
+            for (const auto& [boxMin, boxMax] : boxes) {
+                if (rayChecks >= kRayChecksPerView) {
+                    break;
+                }
+                if (horizon.IsVisible(boxMin, boxMax)) {
+                    continue;
+                }
+                ++rayChecks;
+                ++rayChecked[mode];
+                for (int i = 0; i < 9; ++i) {
+                    const Vector3 point = i == 8 ? (boxMin + boxMax) * 0.5f
+                                                 : Vector3((i & 1) ? boxMax.x : boxMin.x,
+                                                           (i & 2) ? boxMax.y : boxMin.y,
+                                                           (i & 4) ? boxMax.z : boxMin.z);
+                    if (point.y < terrain->SampleHeight(point.x, point.z) ||
+                        (modes[mode] == ClipMode::KeepAbove && point.y < kWaterHeight) ||
+                        (modes[mode] == ClipMode::KeepBelow && point.y > kWaterHeight)) {
+                        continue;
+                    }
+                    Vector3 origin = eye;
+                    if (modes[mode] != ClipMode::None) {
+                        origin = eye + (point - eye) * ((kWaterHeight - eye.y) / (point.y - eye.y));
+                    }
+                    const Vector3 toPoint = point - origin;
+                    float hitDistance = 0.0f;
+                    if (!terrain->Raycast(origin, toPoint, toPoint.Length() - 0.5f, hitDistance)) {
+                        ++rayVisible[mode];
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    std::cerr << "[TerrainHorizon] " << horizon.m_tilesX << "x" << horizon.m_tilesZ << " tiles in " << setupMs
+              << "ms, " << horizon.m_ringRadii.size() << " distance rings x " << kAzimuthBins << " azimuth bins" << "\n";
+    for (int mode = 0; mode < 3; ++mode) {
+        const std::size_t count = std::max<std::size_t>(views[mode], 1);
+        std::cerr << "[TerrainHorizon] " << names[mode] << ": " << views[mode] << " views, build "
+                  << buildMs[mode] / count << "ms per view, " << culled[mode] << " of " << tested[mode]
+                  << " boxes behind terrain, "
+                  << (tested[mode] > 0 ? queryMs[mode] * 1e6f / static_cast<float>(tested[mode]) : 0.0f)
+                  << "ns per query; raycasts on " << rayChecked[mode] << " culled boxes: " << rayVisible[mode]
+                  << " had a visible corner or centre" << "\n";
+    }
+}
@@ -0,0 +1,84 @@
+﻿/**
+ * @file TerrainHorizon.h
+ * @brief 声明基于地形地平线的物体遮挡剔除。
+ * @details
+ * SetTerrain 把高度图划分为每轴至多 kMaxTilesPerAxis 个地块，用 GetHeightRange 记录每个地块的最小高度。
+ * 该值是地块内地表的保守下界：穿过地块时低于它的视线一定位于地表之下。
+ *
+ * 每个视图 BeginView 以相机位置构建方位地平线：kAzimuthBins 个方位扇区 × 若干半径按几何级数增长的距离环。
+ * 地块只写入被其内切圆完全覆盖的扇区，值为仰角正切的下界 (最小高度 - 相机高度) / 距离，
+ * 分子为正时除以地块的最远距离、为负时除以最近距离；地块按最远距离归入第一个能容纳它的环，
+ * 同环取最大值，再沿环做前缀最大值。
+ * IsVisible 把包围盒投影为方位区间与最大仰角正切，只使用完全位于相机与包围盒之间的环；
+ * 若区间内每个扇区的地平线都更高，指向包围盒的任何视线都会先穿过地表。
+ * 地形不做背面剔除，从地下出来的视线同样会被地表挡住，因此相机之外的唯一前提是
+ * 被查询的点位于地表之上（埋入地下的部分本来就不可见）。主视图相机位于地表之下时不做剔除。
+ *
+ * 裁剪平面:
+ * 水面反射与折射通道用水平裁剪平面去掉一侧的几何体（包括地形），视线越过裁剪平面之后
+ * 才可能被地形挡住。ClipMode 指明保留的一侧，查询时只使用完全位于视线与裁剪平面交点之后的环；
+ * 反射通道传入镜像相机的位置。折射与主通道共用同一相机，位置不变时不重新构建地平线。
+ *
+ * 地块最小高度取自高度图采样，没有计入网格简化（kTerrainMaxError）带来的垂直误差；
+ * 高度图没有加速的区间查询（HasFastHeightRange 为 false，如流式高度图）时不生成地块。
+ *
+ * 静态函数 Benchmark():
+ * 在合成地形上记录地块预计算与每视图构建的耗时、三种裁剪模式下的剔除比例与单次查询耗时，
+ * 并以地形射线检测为真值检查被剔除包围盒的角点与中心确实被地表挡住。
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "nclgl/Vector3.h"
+
+namespace Engine::IAL {
+    class I_Heightmap;
+}
+
+class TerrainHorizon {
+public:
+    static constexpr int kAzimuthBins = 2048;
+    static constexpr int kMaxTilesPerAxis = 64;
+
+    enum class ClipMode {
+        None,
+        KeepAbove,
+        KeepBelow
+    };
+
+    TerrainHorizon();
+
+    void SetTerrain(const std::shared_ptr<Engine::IAL::I_Heightmap>& heightmap);
+    bool BeginView(const Vector3& eye, ClipMode clipMode, float clipHeight);
+
+    bool IsVisible(const Vector3& worldMin, const Vector3& worldMax) const;
+
+    std::size_t GetTileCount() const { return m_tileMin.size(); }
+    float GetBuildMs() const { return m_buildMs; }
+
+    static void Benchmark();
+
+private:
+    void Build(const Vector3& eye);
+    int FirstRingBeyond(float distance) const;
+
+    std::shared_ptr<Engine::IAL::I_Heightmap> m_heightmap;
+    std::vector<float> m_tileMin;
+    int m_tilesX;
+    int m_tilesZ;
+    float m_tileWidth;
+    float m_tileDepth;
+    float m_extentX;
+    float m_extentZ;
+    std::vector<float> m_ringRadii;
+    std::vector<float> m_rings;
+    std::vector<float> m_cumulative;
+    Vector3 m_eye;
+    bool m_built;
+    ClipMode m_clipMode;
+    float m_clipHeight;
+    float m_buildMs;
+};
\ No newline at end of file
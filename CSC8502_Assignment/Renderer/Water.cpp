@@ -3,6 +3,7 @@
  * @brief 实现封装水体节点与尺寸信息的 Water 类。
  */
 #include "Water.h"
+#include "Frustum.h"
 
 Water::Water(const std::shared_ptr<Engine::IAL::I_ResourceFactory>& factory,
              float height,
@@ -36,6 +37,16 @@ Vector2 Water::GetSize() const {
     return m_size;
 }
 
+bool Water::GetWorldBounds(Vector3& outMin, Vector3& outMax) const {
+    if (!m_node) {
+        return false;
+    }
+    // CreateQuad 生成 xy 平面上 [-1, 1] 的四边形
+    Frustum::TransformAABB(m_node->GetWorldTransform(), Vector3(-1.0f, -1.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f),
+                           outMin, outMax);
+    return true;
+}
+
 void Water::ConfigureNode(const Vector2& size) {
     if (!m_node)
         return;
@@ -5,6 +5,7 @@
  * Water 类负责通过资源工厂创建全屏四边形网格，将其旋转和平移到场景中的水面高度，
  * 同时保留水面尺寸与高度信息，供渲染器在多次渲染传递中复用。该类仅负责场景节点
  * 的构建与维护，具体的反射与折射帧缓冲由 Renderer 在 Day12 阶段进行管理。
+ * GetWorldBounds 返回水面四边形的世界包围盒，Renderer 据此在水面不可见时跳过反射与折射通道。
  */
 #pragma once
 
@@ -26,6 +27,7 @@ public:
     std::shared_ptr<SceneNode> GetNode() const;
     float GetHeight() const;
     Vector2 GetSize() const;
+    bool GetWorldBounds(Vector3& outMin, Vector3& outMax) const;
 
 private:
     void ConfigureNode(const Vector2& size);
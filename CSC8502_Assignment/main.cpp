@@ -7,7 +7,9 @@
  * `I_ResourceFactory` 和 `I_DebugUI` 作为纯接口注入 `Application`。当轨道 B 处于启用状态时，
  * `B_DebugUI_Null` 会以 Null Object 身份出现，仅保持接口契约而不执行任何 UI 绘制逻辑，
  * 其存在用于占位，使业务在无调试 UI 的情况下仍符合依赖关系。轨道 C 的宏开关预留给自研
- * 实现，保持同样的接口注入流程，从而维持上下文无关的应用主循环。
+ * 实现，保持同样的接口注入流程，从而维持上下文无关的应用主循环。定义 `NCL_RUN_BENCHMARKS`
+ * 时 main 不进入主循环，而是依次运行 CPU 侧基准并把耗时写入日志；最后创建窗口，
+ * 在 GL 上下文中比较 glTF 首次加载（解析 + 烘焙）与烘焙缓存加载的耗时。
  */
 
 #include <memory>
@@ -27,7 +29,44 @@
     #include "Implementations/NCLGL_Impl/B_DebugUI_Null.h"
 #endif
 
+#ifdef NCL_RUN_BENCHMARKS
+    #include "nclgl/Extra/GLTFLoader.h"
+    #include "Implementations/NCLGL_Impl/B_WindowSystem.h"
+    #include "Implementations/NCLGL_Impl/B_Heightmap.h"
+    #include "Implementations/NCLGL_Impl/B_ProceduralTerrain.h"
+    #include "Implementations/NCLGL_Impl/B_TerrainSimplifier.h"
+    #include "Renderer/OcclusionCuller.h"
+    #include "Renderer/LightClusterer.h"
+    #include "Renderer/TerrainHorizon.h"
+#endif
+
 int main() {
+#ifdef NCL_RUN_BENCHMARKS
+    // 基准模式：输出各 CPU 热点的耗时日志，不进入主循环。
+    GLTFLoader::BenchmarkAnimationBake();
+    for (const char* mesh : { "../Meshes/building.gltf", "../Meshes/light.gltf", "../Meshes/ruins.gltf",
+                              "../Meshes/moving.gltf", "../Meshes/cube.gltf", "../Meshes/verybigtest.gltf",
+                              "../Meshes/CesiumMan/CesiumMan.gltf" }) {
+        GLTFLoader::BenchmarkFormats(mesh);
+    }
+    NCLGL_Impl::B_Heightmap::BenchmarkSampling();
+    NCLGL_Impl::B_Heightmap::BenchmarkQueries();
+    NCLGL_Impl::B_Heightmap::BenchmarkNormalBake();
+    NCLGL_Impl::B_TerrainSimplifier::Benchmark("../Heightmaps/terrain.png", 0.4f);
+    NCLGL_Impl::B_ProceduralTerrain::Benchmark();
+    OcclusionCuller::Benchmark();
+    LightClusterer::Benchmark();
+    TerrainHorizon::Benchmark();
+    // 缓存基准会上传网格与纹理，需要 GL 上下文，因此放在最后并为它创建窗口
+    auto benchmarkWindow = std::make_shared<NCLGL_Impl::B_WindowSystem>();
+    if (benchmarkWindow->Init("CSC8502 Benchmarks", 320, 240, false)) {
+        GLTFLoader::BenchmarkCache("../Meshes/verybigtest.gltf");
+        GLTFLoader::BenchmarkCache("../Meshes/CesiumMan/CesiumMan.gltf");
+        benchmarkWindow->Shutdown();
+    }
+    return 0;
+#endif
+
     std::shared_ptr<Engine::IAL::I_WindowSystem> windowSystem;
 
 #ifdef NCL_USE_CUSTOM_IMPL
@@ -1,4 +1,5 @@
 #include "GLTFLoader.h"
+#include "MeshCache.h"
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_USE_CPP14
 #define TINYGLTF_NO_INCLUDE_STB_IMAGE
@@ -9,10 +10,24 @@
 #include "tiny_gltf.h"
 
 #include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cmath>
+#include <execution>
+#include <limits>
+#include <numeric>
 #include <stack>
+#include <type_traits>
 
 #include "../Matrix3.h"
+#include "MappedFile.h"
+#include "./stb/stb_image.h"
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define GLTF_LOADER_SSE2
+#include <emmintrin.h>
+#endif
 
 using namespace tinygltf;
 
@@ -49,6 +64,78 @@ const std::string GLTFAttributeTags[] = {
 	"JOINTS_0",
 };
 
+//Fast paths for the common cases of tightly packed accessors. glTF requires every
+//element to be 4 byte aligned, but nothing says the buffer itself is, so all loads are unaligned
+void ConvertNormalised(float* destination, const unsigned char* source, size_t count) {
+	size_t i = 0;
+#ifdef GLTF_LOADER_SSE2
+	const __m128	scale	= _mm_set1_ps(1.0f / 255.0f);
+	const __m128i	zero	= _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16) {
+		__m128i bytes	= _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i lo		= _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi		= _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_ps(destination + i,		_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+		_mm_storeu_ps(destination + i + 4,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+		_mm_storeu_ps(destination + i + 8,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+		_mm_storeu_ps(destination + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+	}
+#endif
+	for (; i < count; ++i) {
+		destination[i] = source[i] * (1.0f / 255.0f);
+	}
+}
+
+void ConvertNormalised(float* destination, const unsigned short* source, size_t count) {
+	size_t i = 0;
+#ifdef GLTF_LOADER_SSE2
+	const __m128	scale	= _mm_set1_ps(1.0f / 65535.0f);
+	const __m128i	zero	= _mm_setzero_si128();
+	for (; i + 8 <= count; i += 8) {
+		__m128i shorts = _mm_loadu_si128((const __m128i*)(source + i));
+		_mm_storeu_ps(destination + i,		_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(shorts, zero)), scale));
+		_mm_storeu_ps(destination + i + 4,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(shorts, zero)), scale));
+	}
+#endif
+	for (; i < count; ++i) {
+		destination[i] = source[i] * (1.0f / 65535.0f);
+	}
+}
+
+void WidenIntegers(unsigned int* destination, const unsigned char* source, size_t count) {
+	size_t i = 0;
+#ifdef GLTF_LOADER_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16) {
+		__m128i bytes	= _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i lo		= _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi		= _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_si128((__m128i*)(destination + i),		_mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128((__m128i*)(destination + i + 4),	_mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128((__m128i*)(destination + i + 8),	_mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128((__m128i*)(destination + i + 12),	_mm_unpackhi_epi16(hi, zero));
+	}
+#endif
+	for (; i < count; ++i) {
+		destination[i] = source[i];
+	}
+}
+
+void WidenIntegers(unsigned int* destination, const unsigned short* source, size_t count) {
+	size_t i = 0;
+#ifdef GLTF_LOADER_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= count; i += 8) {
+		__m128i shorts = _mm_loadu_si128((const __m128i*)(source + i));
+		_mm_storeu_si128((__m128i*)(destination + i),		_mm_unpacklo_epi16(shorts, zero));
+		_mm_storeu_si128((__m128i*)(destination + i + 4),	_mm_unpackhi_epi16(shorts, zero));
+	}
+#endif
+	for (; i < count; ++i) {
+		destination[i] = source[i];
+	}
+}
+
 template <class toType, class fromType>
 void ReadDataInternal(toType* destination, const Accessor& accessor, const Model& model, int firstElement, int elementCount) {
 	const BufferView& v	= model.bufferViews[accessor.bufferView];
@@ -68,12 +155,53 @@ void ReadDataInternal(toType* destination, const Accessor& accessor, const Model
 		inAxisCount = 4;
 	}
 
-	size_t realCount = std::min((size_t)elementCount, accessor.count);
+	if (firstElement < 0 || (size_t)firstElement >= accessor.count) {
+		return;
+	}
+	size_t realCount = std::min((size_t)elementCount, accessor.count - firstElement);
 
-	for (int i = firstElement; i < (firstElement + realCount); ++i) {
-		fromType* aData = (fromType*)(data + (stride * i));
+	constexpr bool smallUnsigned	= std::is_same_v<fromType, unsigned char> || std::is_same_v<fromType, unsigned short>;
+	constexpr bool floatOut			= std::is_same_v<toType, float>;
+	constexpr bool uintOut			= std::is_integral_v<toType> && sizeof(toType) == sizeof(unsigned int);
+
+	const unsigned char* start	= data + (size_t)stride * firstElement;
+	const size_t componentCount = realCount * inAxisCount;
+	const bool packed			= stride == (int)sizeof(fromType) * inAxisCount;
+
+	if (packed) {
+		if constexpr (std::is_same_v<toType, fromType>) {
+			memcpy(destination, start, componentCount * sizeof(fromType));
+			return;
+		}
+		else if constexpr (smallUnsigned && floatOut) {
+			if (accessor.normalized) {
+				ConvertNormalised(destination, (const fromType*)start, componentCount);
+				return;
+			}
+		}
+		else if constexpr (smallUnsigned && uintOut) {
+			WidenIntegers((unsigned int*)destination, (const fromType*)start, componentCount);
+			return;
+		}
+	}
+
+	//Normalised integer attributes (weights, colours etc) map onto 0.0 - 1.0
+	float scale = 1.0f;
+	if constexpr (smallUnsigned && floatOut) {
+		if (accessor.normalized) {
+			scale = 1.0f / (float)std::numeric_limits<fromType>::max();
+		}
+	}
+
+	for (size_t i = 0; i < realCount; ++i) {
+		const fromType* aData = (const fromType*)(start + ((size_t)stride * i));
 		for (int j = 0; j < inAxisCount; ++j) {
-			*destination = (toType)*aData;
+			if constexpr (smallUnsigned && floatOut) {
+				*destination = (toType)(*aData * scale);
+			}
+			else {
+				*destination = (toType)*aData;
+			}
 			destination++;
 			aData++;
 		}
@@ -105,81 +233,184 @@ void CopyVectorData(std::vector<vecType>& vec, size_t destStart, const Accessor&
 	ReadData<elemType>(accessor, model, &vec[destStart]);
 }
 
-void GetInterpolationData(float forTime, int& indexA, int& indexB, float& t, const Accessor& accessor, const Model& model) {
-	const auto& inBufferView = model.bufferViews[accessor.bufferView];
-	const auto& inBuffer	 = model.buffers[inBufferView.buffer];
+//Animation channels are decoded once up front, rather than re-reading the accessors
+//for every key of every channel on every baked frame
+struct BakeChannel {
+	int joint	= -1;
+	int pathBit = 0;
+	std::vector<float>		times;
+	std::vector<Vector3>	vectors;
+	std::vector<Quaternion> rotations;
+};
 
-	const unsigned char* inData = inBuffer.data.data() + inBufferView.byteOffset + accessor.byteOffset;
-	int stride = accessor.ByteStride(inBufferView);
+struct BakeJoint {
+	Matrix4 defaultMatrix;
+	int		parent = -1; //local joint to concatenate with, or -1
+};
 
-	float a = 0.0f;
-	float b = 0.0f;
+const int TRANSLATION_BIT	= 1;
+const int ROTATION_BIT		= 2;
+const int SCALE_BIT			= 4;
 
-	if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_DOUBLE) {
-		double* ddata = (double*)inData;
-		for (int i = 0; i < accessor.count; ++i) {
-			if (ddata[i] > forTime) {
-				indexA = i > 1 ? (i - 1) : 0;
-				indexB = i;
-				b = (float)*((double*)(inData + (stride * indexB)));
-				a = (float)*((double*)(inData + (stride * indexA)));
-				break;
-			}
-		}
-	}
-	else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
-		float* fdata = (float*)inData;
-		for (int i = 0; i < accessor.count; ++i) {
-			if (fdata[i] > forTime || i == accessor.count - 1) {
-				indexA = i > 0 ? (i - 1) : 0;
-				indexB = i;
-				b = *(float*)(inData + (stride * indexB));
-				a = *(float*)(inData + (stride * indexA));
-				break;
-			}
-		}
+//Binary search for the pair of keys around forTime - same rules as the old linear scan,
+//so times past the end of the channel clamp to the last key
+void GetInterpolationData(float forTime, int& indexA, int& indexB, float& t, const std::vector<float>& times) {
+	if (times.empty()) {
+		indexA = indexB = 0;
+		t = 0.0f;
+		return;
 	}
+	int i = (int)(std::upper_bound(times.begin(), times.end(), forTime) - times.begin());
+	i = std::min(i, (int)times.size() - 1);
+
+	indexA = i > 0 ? (i - 1) : 0;
+	indexB = i;
+
 	if (indexA == indexB) {
 		t = 0.0f;
 	}
 	else {
-		t = std::clamp((forTime - a) / (b - a), 0.0f, 1.0f);
+		t = std::clamp((forTime - times[indexA]) / (times[indexB] - times[indexA]), 0.0f, 1.0f);
 	}
 }
 
-Quaternion GetSlerpQuaterion(float t, int indexA, int indexB, const Accessor& accessor, Model& model) {
-	Quaternion qa;
-	Quaternion qb;
+//Bakes every joint's model space matrix at each sampled frame. Frames are independent of
+//each other, so they're spread across cores; joints within a frame are still done in
+//order, as a joint reads its parent's matrix for the same frame
+std::vector<Matrix4> BakeAnimationFrames(const std::vector<BakeChannel>& channels, const std::vector<BakeJoint>& joints, const std::vector<float>& frameTimes, const Matrix4& globalTransformInverse) {
+	size_t jointCount = joints.size();
+	std::vector<Matrix4> worldMatrices(jointCount * frameTimes.size());
 
-	ReadData<float>(accessor, model, (float*)&qa, indexA, 1);
-	ReadData<float>(accessor, model, (float*)&qb, indexB, 1);
+	std::vector<size_t> frames(frameTimes.size());
+	std::iota(frames.begin(), frames.end(), 0);
 
-	if (indexA == indexB) {
-		return qa;
+	std::for_each(std::execution::par, frames.begin(), frames.end(), [&](size_t frame) {
+		std::vector<Vector3>	translations(jointCount);
+		std::vector<Vector3>	scales(jointCount, Vector3(1, 1, 1));
+		std::vector<Quaternion> rotations(jointCount);
+		std::vector<int>		inAnim(jointCount, 0);
+
+		float time = frameTimes[frame];
+
+		for (const BakeChannel& channel : channels) {
+			if (channel.joint < 0 || (inAnim[channel.joint] & channel.pathBit)) {
+				continue; //First channel to target a joint's property wins
+			}
+			int indexA	= 0;
+			int indexB	= 0;
+			float t		= 0.0f;
+			GetInterpolationData(time, indexA, indexB, t, channel.times);
+
+			if (channel.pathBit == ROTATION_BIT) {
+				rotations[channel.joint] = (indexA == indexB) ? channel.rotations[indexA] : Quaternion::Slerp(channel.rotations[indexA], channel.rotations[indexB], t);
+			}
+			else {
+				Vector3 v = (indexA == indexB) ? channel.vectors[indexA] : (channel.vectors[indexA] * (1.0f - t)) + (channel.vectors[indexB] * t);
+				(channel.pathBit == TRANSLATION_BIT ? translations : scales)[channel.joint] = v;
+			}
+			inAnim[channel.joint] |= channel.pathBit;
+		}
+
+		Matrix4* world = &worldMatrices[frame * jointCount];
+
+		//We'll assume that nodes aren't animated by default
+		for (size_t i = 0; i < jointCount; ++i) {
+			world[i] = joints[i].defaultMatrix;
+		}
+
+		for (size_t i = 0; i < jointCount; ++i) {
+			if (inAnim[i] == 0) {
+				continue;
+			}
+			Matrix4 transform = Matrix4::Translation(translations[i]) *
+				Matrix4(rotations[i]) *
+				Matrix4::Scale(scales[i]);
+
+			if (joints[i].parent >= 0) {//It's a local transform!
+				transform = world[joints[i].parent] * transform;
+			}
+			world[i] = transform;
+		}
+
+		for (size_t i = 0; i < jointCount; ++i) {
+			world[i] = globalTransformInverse * world[i];
+		}
+	});
+	return worldMatrices;
+}
+
+std::vector<float> GetFrameTimes(float animLength, float frameRate) {
+	std::vector<float> frameTimes;
+	float frameTime = 1.0f / frameRate;
+	for (float time = 0.0f; time <= animLength; time += frameTime) {
+		frameTimes.push_back(time);
 	}
-	return Quaternion::Slerp(qa, qb, t);
+	return frameTimes;
 }
 
-template <class vecType>
-vecType GetInterpolatedVector(float t, int indexA, int indexB, const Accessor& accessor, Model& model) {
-	vecType a;
-	vecType b;
-	ReadData<float>(accessor, model, (float*)&a, indexA, 1);
-	ReadData<float>(accessor, model, (float*)&b, indexB, 1);
+//Images embedded in a .glb (or as data URIs) come through here - external files are left to LoadImages
+bool LoadEmbeddedImage(Image* image, const int imageIndex, std::string* err, std::string* warn, int reqWidth, int reqHeight, const unsigned char* bytes, int size, void* userData) {
+	int width		= 0;
+	int height		= 0;
+	int channels	= 0;
+	stbi_uc* pixels = stbi_load_from_memory(bytes, size, &width, &height, &channels, 4); //Same forced RGBA as OGLTexture::LoadTexture
 
-	if (indexA == indexB) {
-		return a;
+	if (!pixels) {
+		if (err) {
+			(*err) += "Failed to decode embedded image " + std::to_string(imageIndex) + "\n";
+		}
+		return false;
 	}
+	image->width		= width;
+	image->height		= height;
+	image->component	= 4;
+	image->bits			= 8;
+	image->pixel_type	= TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+	image->image.assign(pixels, pixels + (size_t)width * height * 4);
+
+	stbi_image_free(pixels);
+	return true;
+}
+
+bool IsBinaryGLTF(const std::string& filename) {
+	std::string extension = std::filesystem::path(filename).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return extension == ".glb";
+}
 
-	return (a * (1.0f - t)) + (b * t);
+bool ParseGLTFFile(TinyGLTF& gltf, Model& model, std::string& errors, const std::string& filename) {
+	if (IsBinaryGLTF(filename)) {
+		//Map the .glb rather than reading it into a temporary vector - tinygltf parses the JSON chunk
+		//in place, and the BIN chunk is copied into its Buffer once, straight from the mapping
+		MappedFile glbFile(filename);
+		if (!glbFile.Data()) {
+			errors = "Can't open file";
+			return false;
+		}
+		std::string baseDir = std::filesystem::path(filename).parent_path().string();
+		return gltf.LoadBinaryFromMemory(&model, &errors, nullptr, (const unsigned char*)glbFile.Data(), (unsigned int)glbFile.Size(), baseDir);
+	}
+	return gltf.LoadASCIIFromFile(&model, &errors, nullptr, filename);
 }
 
 bool GLTFLoader::Load(const std::string& filename, GLTFScene& intoScene) {
+	//The cooked cache only describes a single file, so it can't be used when appending to an existing scene
+	bool cacheable = intoScene.meshes.empty() && intoScene.textures.empty() && intoScene.materialLayers.empty()
+		&& intoScene.sceneNodes.empty() && intoScene.animations.empty();
+
+	if (cacheable && MeshCache::Load(filename, intoScene)) {
+		return true;
+	}
+
 	TinyGLTF gltf;
 	Model	 model;
 
+	gltf.SetImageLoader(LoadEmbeddedImage, nullptr);
+
+	std::string errors;
 
-	if (!gltf.LoadASCIIFromFile(&model, nullptr, nullptr, filename)) {
+	if (!ParseGLTFFile(gltf, model, errors, filename)) {
+		std::cout << "GLTFLoader: Failed to load " << filename << ": " << errors << std::endl;
 		return false;
 	}
 
@@ -198,6 +429,17 @@ bool GLTFLoader::Load(const std::string& filename, GLTFScene& intoScene) {
 	LoadVertexData(model, intoScene, state);
 	AssignNodeMeshes(model, intoScene, state);
 
+	if (cacheable) {
+		//External .bin buffers aren't recorded in the scene, so pass them on for the cache key
+		std::vector<std::string> dependencies;
+		std::filesystem::path baseDir = std::filesystem::path(filename).parent_path();
+		for (const auto& b : model.buffers) {
+			if (!b.uri.empty() && !IsDataURI(b.uri)) {
+				dependencies.push_back((baseDir / dlib::urldecode(b.uri)).string());
+			}
+		}
+		MeshCache::Cook(filename, intoScene, dependencies);
+	}
 	return true;
 }
 
@@ -208,6 +450,12 @@ void GLTFLoader::LoadImages(tinygltf::Model& m, GLTFScene& scene, BaseState stat
 	std::filesystem::path subPath	= p.parent_path();
 
 	for (const auto& i : m.images) {
+		if (!i.image.empty()) { //Already decoded by LoadEmbeddedImage
+			SharedTexture tex = OGLTexture::TextureFromData((char*)i.image.data(), i.width, i.height, i.component);
+			scene.textures.push_back(tex);
+			scene.texturePaths.push_back(std::string());
+			continue;
+		}
 		std::filesystem::path imagePath;// = std::filesystem::path(NCL::Assets::GLTFDIR);
 		imagePath += std::filesystem::path(p.parent_path());
 		imagePath.append(i.uri);
@@ -218,6 +466,7 @@ void GLTFLoader::LoadImages(tinygltf::Model& m, GLTFScene& scene, BaseState stat
 		SharedTexture tex = OGLTexture::TextureFromFile(pathString);
 
 		scene.textures.push_back(tex);
+		scene.texturePaths.push_back(pathString);
 		loadedTexturesMap.insert({ i.uri,tex });
 	}
 }
@@ -277,19 +526,31 @@ void GLTFLoader::LoadVertexData(tinygltf::Model& model, GLTFScene& scene, BaseSt
 		material.allLayers.reserve(m.primitives.size());
 
 		size_t totalVertexCount = 0;
+		size_t totalIndexCount	= 0;
 
 		bool hasAttribute[VertexAttribute::MAX_ATTRIBUTES] = { false };
 
+		//Work out where each primitive lands in the shared arrays up front, so they can be decoded independently
+		std::vector<::Mesh::SubMesh> submeshes;
+		submeshes.reserve(m.primitives.size());
+
 		for (const auto& p : m.primitives) {
 			for (int i = 0; i < VertexAttribute::MAX_ATTRIBUTES; ++i) {
 				hasAttribute[i] |= p.attributes.find(GLTFAttributeTags[i]) != p.attributes.end();
 			}
 
+			size_t baseVertex = totalVertexCount;
+			size_t firstIndex = totalIndexCount;
+
 			auto hasVerts = p.attributes.find(GLTFAttributeTags[VertexAttribute::Positions]);
 
 			if (hasVerts != p.attributes.end()) {
 				totalVertexCount += model.accessors[hasVerts->second].count;
 			}
+			if (p.indices >= 0) {
+				totalIndexCount += model.accessors[p.indices].count;
+			}
+			submeshes.emplace_back((int)firstIndex, (int)(totalIndexCount - firstIndex), (int)baseVertex);
 		}
 		std::vector<Vector3> vPositions(totalVertexCount);
 		std::vector<Vector3> vNormals(hasAttribute[VertexAttribute::Normals] ? totalVertexCount : 0);
@@ -299,69 +560,65 @@ void GLTFLoader::LoadVertexData(tinygltf::Model& model, GLTFScene& scene, BaseSt
 		std::vector<Vector4>  vJointWeights(hasAttribute[VertexAttribute::JointWeights] ? totalVertexCount : 0);
 		std::vector<Vector4i>  vJointIndices(hasAttribute[VertexAttribute::JointIndices] ? totalVertexCount : 0);
 
-		std::vector<unsigned int>		vIndices;
+		std::vector<unsigned int>		vIndices(totalIndexCount);
 
-		std::vector<::Mesh::SubMesh> submeshes;
+		//now load up the actual vertex data - each primitive writes to its own range of the arrays
+		std::vector<size_t> primitiveIDs(m.primitives.size());
+		std::iota(primitiveIDs.begin(), primitiveIDs.end(), 0);
 
-		size_t vArrayPos = 0;
-
-		//now load up the actual vertex data
-		for (const auto& p : m.primitives) {
+		std::for_each(std::execution::par, primitiveIDs.begin(), primitiveIDs.end(), [&](size_t primID) {
+			const auto& p = m.primitives[primID];
 			std::map<std::string, int>::const_iterator vPrims[VertexAttribute::MAX_ATTRIBUTES];
 
 			for (int i = 0; i < VertexAttribute::MAX_ATTRIBUTES; ++i) {
 				vPrims[i] = p.attributes.find(GLTFAttributeTags[i]);
 			}
 
-			size_t baseVertex = vArrayPos;
-			size_t firstIndex = vIndices.size();
+			size_t vArrayPos = submeshes[primID].base;
 
 			if (vPrims[VertexAttribute::JointWeights] != p.attributes.end()) {
-				Accessor& a = model.accessors[vPrims[VertexAttribute::JointWeights]->second];
+				const Accessor& a = model.accessors[vPrims[VertexAttribute::JointWeights]->second];
 				CopyVectorData<Vector4, float>(vJointWeights, vArrayPos, a, model);
 			}
 			if (vPrims[VertexAttribute::JointIndices] != p.attributes.end()) {
-				Accessor& a = model.accessors[vPrims[VertexAttribute::JointIndices]->second];
+				const Accessor& a = model.accessors[vPrims[VertexAttribute::JointIndices]->second];
 				CopyVectorData<Vector4i, unsigned int>(vJointIndices, vArrayPos, a, model);
 			}
 			if (vPrims[VertexAttribute::Normals] != p.attributes.end()) {
-				Accessor& a = model.accessors[vPrims[VertexAttribute::Normals]->second];
+				const Accessor& a = model.accessors[vPrims[VertexAttribute::Normals]->second];
 				CopyVectorData<Vector3, float>(vNormals, vArrayPos, a, model);
 			}
 			if (vPrims[VertexAttribute::Tangents] != p.attributes.end()) {
-				Accessor& a = model.accessors[vPrims[VertexAttribute::Tangents]->second];
+				const Accessor& a = model.accessors[vPrims[VertexAttribute::Tangents]->second];
 				CopyVectorData<Vector4, float>(vTangents, vArrayPos, a, model);
 			}
 			if (vPrims[VertexAttribute::TextureCoords] != p.attributes.end()) {
-				Accessor& a = model.accessors[vPrims[VertexAttribute::TextureCoords]->second];
+				const Accessor& a = model.accessors[vPrims[VertexAttribute::TextureCoords]->second];
 				CopyVectorData<Vector2, float>(vTexCoords, vArrayPos, a, model);
 			}
 			if (vPrims[VertexAttribute::Positions] != p.attributes.end()) {
-				Accessor& a = model.accessors[vPrims[VertexAttribute::Positions]->second];
+				const Accessor& a = model.accessors[vPrims[VertexAttribute::Positions]->second];
 				CopyVectorData<Vector3, float>(vPositions, vArrayPos, a, model);
-				vArrayPos += a.count;
 			}
 
-			if (p.indices >= 0) {
-				Accessor& a = model.accessors[p.indices];
-
-				size_t start = vIndices.size();
-				vIndices.resize(start + a.count);
-
-				CopyVectorData<unsigned int, unsigned int>(vIndices, start, a, model);
+			if (p.indices >= 0 && submeshes[primID].count > 0) {
+				const Accessor& a = model.accessors[p.indices];
+				CopyVectorData<unsigned int, unsigned int>(vIndices, submeshes[primID].start, a, model);
 			}
+		});
 
+		for (const auto& p : m.primitives) {
 			GLTFMaterialLayer matLayer;
 
 			if (p.material >= 0) { //can ever be false?
 				matLayer = scene.materialLayers[state.firstMatLayer + p.material];
 			}
 			material.allLayers.push_back(matLayer);
-
-			submeshes.emplace_back((int)firstIndex, (int)(vIndices.size() - firstIndex), (int)baseVertex);
+			material.layerIndices.push_back(p.material >= 0 ? (int32_t)(state.firstMatLayer + p.material) : -1);
 		}
 
-		OGLMesh* outMesh = ::Mesh::MeshFromVectors(
+		//MeshFromVectors hands back a new Mesh - adopt it directly rather than copying it into the shared_ptr
+		SharedMesh mesh = SharedMesh(::Mesh::MeshFromVectors(
 			vPositions,
 			{},
 			vTexCoords,
@@ -371,11 +628,9 @@ void GLTFLoader::LoadVertexData(tinygltf::Model& model, GLTFScene& scene, BaseSt
 			vJointIndices,
 			vIndices,
 			submeshes
-		);
+		));
 
-		SharedMesh m = std::make_shared<OGLMesh>(*outMesh);
-
-		scene.meshes.push_back(m);
+		scene.meshes.push_back(mesh);
 		scene.materials.push_back(material);
 	}
 }
@@ -535,124 +790,236 @@ void GLTFLoader::LoadSkinningData(tinygltf::Model& model, GLTFScene& scene, int3
 void GLTFLoader::LoadAnimationData(tinygltf::Model& model, GLTFScene& scene, BaseState state, OGLMesh& mesh, GLTFSkin& skinData) {
 	size_t jointCount = mesh.GetJointCount();
 
+	std::vector<BakeJoint> joints(jointCount);
+	for (size_t i = 0; i < jointCount; ++i) {
+		GLTFNode& node = scene.sceneNodes[state.firstNode + skinData.localToSceneLookup.at((int)i)];
+		joints[i].defaultMatrix = node.worldMatrix;
+
+		if (node.parent > 0) {
+			//Parents outside of the skin have always been treated as joint 0 - kept so clips bake the same as before
+			auto result = skinData.sceneToLocalLookup.find(scene.sceneNodes[node.parent].nodeID);
+			joints[i].parent = (result == skinData.sceneToLocalLookup.end()) ? 0 : result->second;
+		}
+	}
+
 	for (const auto& anim : model.animations) {
 		float animLength = 0.0f;
 		for (int i = 0; i < anim.samplers.size(); ++i) {
 			int timeSrc = anim.samplers[i].input;
 			animLength = std::max(animLength, (float)(model.accessors[timeSrc].maxValues[0]));
 		}
-		float time = 0.0f;
 		float frameRate = 30.0f;
-		float frameTime = 1.0f / frameRate;
-		unsigned int frameCount = 0;
-
-		std::vector<Matrix4> localMatrices;
-		localMatrices.reserve(jointCount * int(animLength * frameRate));
 
-		std::vector<Matrix4> worldMatrices;
-		worldMatrices.reserve(jointCount * int(animLength * frameRate));
+		std::vector<BakeChannel> channels(anim.channels.size());
+		for (size_t c = 0; c < anim.channels.size(); ++c) {
+			const auto& channel = anim.channels[c];
+			const auto& sampler = anim.samplers[channel.sampler];
+			const auto& input	= model.accessors[sampler.input];
+			const auto& output	= model.accessors[sampler.output];
 
-		std::vector<int> inAnim(jointCount, 0); //TODO: reduce to only nodes that matter
+			BakeChannel& bake = channels[c];
 
-		static int TRANSLATION_BIT	= 1;
-		static int ROTATION_BIT		= 2;
-		static int SCALE_BIT		= 4;
+			auto result = skinData.sceneToLocalLookup.find(channel.target_node);
+			if (result == skinData.sceneToLocalLookup.end()) {
+				continue; //Not one of this skin's joints
+			}
+			if (channel.target_path == "translation") {
+				bake.pathBit = TRANSLATION_BIT;
+			}
+			else if (channel.target_path == "rotation") {
+				bake.pathBit = ROTATION_BIT;
+			}
+			else if (channel.target_path == "scale") {
+				bake.pathBit = SCALE_BIT;
+			}
+			else {
+				continue;
+			}
+			bake.joint = result->second;
 
-		while (time <= animLength) {
-			localMatrices.reserve((frameCount+1) * jointCount);
-			worldMatrices.reserve((frameCount + 1) * jointCount);
+			bake.times.resize(input.count);
+			ReadData<float>(input, model, bake.times.data());
 
-			std::map<int, Vector3> frameJointTranslations;
-			std::map<int, Vector3> frameJointScales;
-			std::map<int, Quaternion> frameJointRotations;
+			size_t outputCount = std::max(input.count, output.count);
+			if (bake.pathBit == ROTATION_BIT) {
+				bake.rotations.resize(outputCount);
+				ReadData<float>(output, model, (float*)bake.rotations.data());
+			}
+			else {
+				bake.vectors.resize(outputCount);
+				ReadData<float>(output, model, (float*)bake.vectors.data());
+			}
+		}
 
-			std::fill(inAnim.begin(), inAnim.end(), 0);
+		std::vector<float> frameTimes = GetFrameTimes(animLength, frameRate);
+		std::vector<Matrix4> worldMatrices = BakeAnimationFrames(channels, joints, frameTimes, skinData.globalTransformInverse);
 
-			for (const auto& channel : anim.channels) {
-				const auto& sampler = anim.samplers[channel.sampler];
-				const auto& input	= model.accessors[sampler.input];
-				const auto& output	= model.accessors[sampler.output];
+		scene.animations.push_back(std::make_unique<MeshAnimation>((unsigned int)jointCount, (unsigned int)frameTimes.size(), frameRate, worldMatrices));
+	}
+}
 
-				int indexA	= 0;
-				int indexB	= 0;
-				float t		= 0.0f;
-				GetInterpolationData(time, indexA, indexB, t, input, model);
+//Bakes a long synthetic clip - a chain of jointCount joints, each with translation, rotation
+//and scale channels of keyCount keys - and logs how long it took
+void GLTFLoader::BenchmarkAnimationBake(int keyCount, int jointCount) {
+	float frameRate = 30.0f;
+	float keyTime	= 1.0f / frameRate;
 
-				int localNodeID = skinData.sceneToLocalLookup[channel.target_node];
+	std::vector<BakeJoint> joints(jointCount);
+	for (int i = 0; i < jointCount; ++i) {
+		joints[i].parent = i - 1;
+	}
 
-				if (channel.target_path == "translation") {
-					frameJointTranslations.insert({ localNodeID, GetInterpolatedVector<Vector3>(t, indexA, indexB, output, model) });
-					inAnim[localNodeID] |= TRANSLATION_BIT;
+	std::vector<BakeChannel> channels;
+	for (int i = 0; i < jointCount; ++i) {
+		for (int bit : { TRANSLATION_BIT, ROTATION_BIT, SCALE_BIT }) {
+			BakeChannel channel;
+			channel.joint	= i;
+			channel.pathBit = bit;
+			channel.times.resize(keyCount);
+			if (bit == ROTATION_BIT) {
+				channel.rotations.resize(keyCount);
+			}
+			else {
+				channel.vectors.resize(keyCount);
+			}
+			for (int k = 0; k < keyCount; ++k) {
+				float s = sinf(k * 0.1f + i);
+				channel.times[k] = k * keyTime * 0.75f; //Keys deliberately don't land on frames
+				if (bit == ROTATION_BIT) {
+					channel.rotations[k] = Quaternion::EulerAnglesToQuaternion(s * 45.0f, s * 30.0f, 0.0f);
 				}
-				else if (channel.target_path == "rotation") {
-					Quaternion q = GetSlerpQuaterion(t, indexA, indexB, output, model);
-					frameJointRotations.insert({ localNodeID, q });
-					inAnim[localNodeID] |= ROTATION_BIT;
+				else if (bit == TRANSLATION_BIT) {
+					channel.vectors[k] = Vector3(s, 1.0f, 0.0f);
 				}
-				else if (channel.target_path == "scale") {
-					frameJointScales.insert({ localNodeID, GetInterpolatedVector<Vector3>(t, indexA, indexB, output, model) });
-					inAnim[localNodeID] |= SCALE_BIT;
+				else {
+					channel.vectors[k] = Vector3(1, 1, 1) * (1.0f + s * 0.1f);
 				}
 			}
+			channels.push_back(std::move(channel));
+		}
+	}
+	float animLength = channels.empty() ? 0.0f : channels[0].times.back();
 
-			size_t startMatrix = localMatrices.size();
+	auto startTime = std::chrono::high_resolution_clock::now();
 
-			//We'll assume that nodes aren't animated by default
-			for (unsigned int i = 0; i < mesh.GetJointCount(); ++i) {
-				int localNodeID = i;
-				int sceneNodeID = skinData.localToSceneLookup[localNodeID];
-				GLTFNode& node = scene.sceneNodes[state.firstNode + sceneNodeID];
-				localMatrices.push_back(node.worldMatrix);
-				worldMatrices.push_back(node.worldMatrix);
-			}
+	std::vector<float> frameTimes = GetFrameTimes(animLength, frameRate);
+	std::vector<Matrix4> worldMatrices = BakeAnimationFrames(channels, joints, frameTimes, Matrix4());
 
-			for (unsigned int i = 0; i < mesh.GetJointCount(); ++i) {
-				int localNodeID = i;
-				int in = inAnim[localNodeID];
+	auto endTime = std::chrono::high_resolution_clock::now();
 
-				if (in > 0) { //This node has a modifier of some sort
-					int sceneNodeID = skinData.localToSceneLookup[localNodeID];
+	std::cout << "GLTFLoader: Baked " << frameTimes.size() << " frames of " << jointCount << " joints from " << keyCount << " keys per channel in "
+		<< std::chrono::duration<float, std::milli>(endTime - startTime).count() << "ms" << std::endl;
+}
 
-					GLTFNode& node = scene.sceneNodes[state.firstNode + sceneNodeID];
+//Writes the geometry and animation of sourceFile back out three ways - a .gltf with base64 embedded
+//buffers, a .gltf with an external .bin, and a .glb - and logs how long each takes to parse. Images
+//and materials are stripped first, so only the buffer container differs between the three files.
+//Parsing is the only stage the container changes, so the cooked cache and GL upload aren't involved
+void GLTFLoader::BenchmarkFormats(const std::string& sourceFile, int repeats) {
+	TinyGLTF	gltf;
+	Model		model;
+	std::string errors;
 
-					Vector3 translation;
-					Vector3 scale(1, 1, 1);
-					Quaternion rotation;
+	gltf.SetImageLoader(LoadEmbeddedImage, nullptr);
 
-					if (in & TRANSLATION_BIT) {
-						translation = frameJointTranslations[localNodeID];
-					}
-					if (in & ROTATION_BIT) {
-						rotation = frameJointRotations[localNodeID];
-					}
-					if (in & SCALE_BIT) {
-						scale = frameJointScales[localNodeID];
-					}
+	if (!ParseGLTFFile(gltf, model, errors, sourceFile)) {
+		std::cout << "GLTFLoader: Failed to load " << sourceFile << ": " << errors << std::endl;
+		return;
+	}
+	model.images.clear();
+	model.textures.clear();
+	model.samplers.clear();
+	model.materials.clear();
+	for (auto& m : model.meshes) {
+		for (auto& p : m.primitives) {
+			p.material = -1;
+		}
+	}
+	for (auto& b : model.buffers) {
+		b.uri.clear(); //Let the writer pick the .bin name, and put buffer 0 in the .glb BIN chunk
+	}
 
-					Matrix4 transform = Matrix4::Translation(translation) *
-						Matrix4(rotation) *
-						Matrix4::Scale(scale);
-					
-					localMatrices[startMatrix + i] = transform;
+	std::filesystem::path outDir = std::filesystem::temp_directory_path() / "GLTFFormatBenchmark";
+	std::filesystem::create_directories(outDir);
 
-					if (node.parent) {//It's a local transform!
-						//We need to work out this frame's matrix for the parent node - may have been animated
-						GLTFNode* parent = &scene.sceneNodes[node.parent];
-						int localParentID = skinData.sceneToLocalLookup[parent->nodeID];
-						transform = worldMatrices[startMatrix + localParentID] * transform;
-					}
+	struct Variant {
+		const char* name;
+		std::string file;
+		bool		embedBuffers;
+		bool		writeBinary;
+	};
+	Variant variants[] = {
+		{ ".gltf (embedded)",	(outDir / "embedded.gltf").string(), true,  false },
+		{ ".gltf + .bin",		(outDir / "external.gltf").string(), false, false },
+		{ ".glb",				(outDir / "binary.glb").string(),	 false, true  },
+	};
 
-					worldMatrices[startMatrix + i] = transform;
-				}
-			}
-			time += frameTime;
-			frameCount++;
+	for (const Variant& v : variants) {
+		if (!gltf.WriteGltfSceneToFile(&model, v.file, false, v.embedBuffers, false, v.writeBinary)) {
+			std::cout << "GLTFLoader: Failed to write " << v.file << std::endl;
+			return;
 		}
+	}
 
-		for (int i = 0; i < worldMatrices.size(); ++i) {
-			worldMatrices[i] = skinData.globalTransformInverse * worldMatrices[i];
+	for (const Variant& v : variants) {
+		uintmax_t fileSize = std::filesystem::file_size(v.file);
+		if (!v.embedBuffers && !v.writeBinary) {
+			fileSize += std::filesystem::file_size(outDir / "external.bin");
 		}
+		float bestMs  = std::numeric_limits<float>::max();
+		float totalMs = 0.0f;
+		for (int i = 0; i < repeats; ++i) {
+			Model parsed;
+			auto startTime = std::chrono::high_resolution_clock::now();
+			bool loaded = ParseGLTFFile(gltf, parsed, errors, v.file);
+			auto endTime = std::chrono::high_resolution_clock::now();
+
+			if (!loaded) {
+				std::cout << "GLTFLoader: Failed to load " << v.file << ": " << errors << std::endl;
+				return;
+			}
+			float ms = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+			bestMs   = std::min(bestMs, ms);
+			totalMs += ms;
+		}
+		std::cout << "GLTFLoader: Parsed " << std::filesystem::path(sourceFile).filename().string() << " as " << v.name << " (" << fileSize << " bytes) in " << bestMs << "ms best, "
+			<< totalMs / repeats << "ms mean over " << repeats << " loads" << std::endl;
+	}
+}
 
-		scene.animations.push_back(std::make_unique<MeshAnimation>((unsigned int)jointCount, frameCount, frameRate, worldMatrices));
+//Times a full first load (parse, build and cook) against a load from the memory mapped cooked
+//file, taking the best of repeats runs of each. Meshes and textures are uploaded as usual, so
+//this one needs a GL context
+void GLTFLoader::BenchmarkCache(const std::string& filename, int repeats) {
+	const std::string cookedFile = MeshCache::CookedPath(filename);
+
+	float bestUncachedMs	= std::numeric_limits<float>::max();
+	float bestCachedMs		= std::numeric_limits<float>::max();
+	for (int i = 0; i < repeats; ++i) {
+		std::filesystem::remove(cookedFile);
+		{
+			GLTFScene scene;
+			auto startTime = std::chrono::high_resolution_clock::now();
+			bool loaded = Load(filename, scene);
+			auto endTime = std::chrono::high_resolution_clock::now();
+			if (!loaded) {
+				return;
+			}
+			bestUncachedMs = std::min(bestUncachedMs, std::chrono::duration<float, std::milli>(endTime - startTime).count());
+		}
+		if (!std::filesystem::exists(cookedFile)) {
+			std::cout << "GLTFLoader: " << filename << " wasn't cooked, nothing to compare" << std::endl;
+			return;
+		}
+		{
+			GLTFScene scene;
+			auto startTime = std::chrono::high_resolution_clock::now();
+			Load(filename, scene);
+			auto endTime = std::chrono::high_resolution_clock::now();
+			bestCachedMs = std::min(bestCachedMs, std::chrono::duration<float, std::milli>(endTime - startTime).count());
+		}
 	}
-}
\ No newline at end of file
+	std::cout << "GLTFLoader: " << filename << " parse + cook " << bestUncachedMs << "ms, cached " << bestCachedMs
+		<< "ms (x" << bestUncachedMs / std::max(bestCachedMs, 1e-6f) << ", " << std::filesystem::file_size(cookedFile)
+		<< " byte cooked file), best of " << repeats << std::endl;
+}
@@ -57,6 +57,7 @@ struct GLTFMaterialLayer {
 
 struct GLTFMaterial {
 	std::vector< GLTFMaterialLayer > allLayers;
+	std::vector< int32_t > layerIndices; //into GLTFScene::materialLayers, -1 if the primitive had none
 };		
 
 struct GLTFNode {
@@ -77,6 +78,7 @@ struct GLTFScene {
 	std::vector<SharedMesh>			meshes;		
 	std::vector<SharedMeshAnim>		animations;
 	std::vector<SharedTexture>		textures;
+	std::vector<std::string>		texturePaths;
 
 	std::vector<GLTFMaterial>		materials;
 	std::vector<GLTFMaterialLayer>	materialLayers;
@@ -91,6 +93,10 @@ public:
 
 	static bool Load(const std::string& filename, GLTFScene& intoScene);
 
+	static void BenchmarkAnimationBake(int keyCount = 10000, int jointCount = 100);
+	static void BenchmarkFormats(const std::string& sourceFile, int repeats = 20);
+	static void BenchmarkCache(const std::string& filename, int repeats = 10);
+
 protected:		
 	GLTFLoader()  = delete;
 	~GLTFLoader() = delete;
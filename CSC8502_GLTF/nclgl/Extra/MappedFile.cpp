@@ -0,0 +1,67 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		return;
+	}
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) {
+		return;
+	}
+	data = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	size = data ? (size_t)fileSize.QuadPart : 0;
+#else
+	fileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) {
+		return;
+	}
+	struct stat info;
+	if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0) {
+		return;
+	}
+	void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (view == MAP_FAILED) {
+		return;
+	}
+	data = (const char*)view;
+	size = (size_t)info.st_size;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle) {
+		CloseHandle(fileHandle);
+	}
+#else
+	if (data) {
+		munmap((void*)data, size);
+	}
+	if (fileDescriptor >= 0) {
+		close(fileDescriptor);
+	}
+#endif
+}
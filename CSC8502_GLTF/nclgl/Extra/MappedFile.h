@@ -0,0 +1,34 @@
+/******************************************************************************
+Class:MappedFile
+Implements:
+Description:Read-only memory mapped view of an entire file. The mapping stays
+valid for the lifetime of the object, so anything pointing into Data() must be
+finished with before it is destroyed.
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+
+class MappedFile	{
+public:
+	MappedFile(const std::string& filename);
+	~MappedFile();
+
+	MappedFile(const MappedFile&)				= delete;
+	MappedFile& operator=(const MappedFile&)	= delete;
+
+	const char* Data() const {
+		return data;
+	}
+
+	size_t Size() const {
+		return size;
+	}
+
+protected:
+	void*	fileHandle		= nullptr;	//HANDLE on Windows
+	void*	mappingHandle	= nullptr;
+	int		fileDescriptor	= -1;
+
+	const char* data = nullptr;
+	size_t		size = 0;
+};
@@ -0,0 +1,688 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "GLTFLoader.h"
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceSize;
+		int64_t	 sourceTime;
+		uint32_t textureCount;
+		uint32_t materialLayerCount;
+		uint32_t meshCount;
+		uint32_t nodeCount;
+		uint32_t animationCount;
+		uint32_t dependencyCount;
+	};
+
+	struct CookedMaterialLayer {
+		int32_t	albedo;
+		int32_t	bump;
+		int32_t	occlusion;
+		int32_t	emission;
+		int32_t	metallic;
+
+		Vector4	albedoColour;
+		Vector3	emissionColour;
+		float	metallicFactor;
+		float	roughnessFactor;
+		float	alphaCutoff;
+		uint32_t doubleSided;
+		uint32_t alphaMode;
+	};
+
+	struct CookedMeshHeader {
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t attributeMask;	//one bit per MeshBuffer entry
+		uint32_t vertexStride;
+		uint32_t subMeshCount;
+		uint32_t jointCount;
+		uint32_t poseMask;		//bit 0 = bind pose, bit 1 = inverse bind pose
+		uint32_t padding;
+		Vector3	 boundsMin;
+		Vector3	 boundsMax;
+	};
+
+	struct CookedSubMesh {
+		int32_t start;
+		int32_t count;
+		int32_t base;
+		int32_t materialLayer;
+	};
+
+	struct CookedNode {
+		Matrix4	 localMatrix;
+		Matrix4	 worldMatrix;
+		uint32_t nodeID;
+		int32_t	 mesh;
+		int32_t	 parent;
+		uint32_t childCount;
+	};
+
+	struct CookedAnimation {
+		uint32_t jointCount;
+		uint32_t frameCount;
+		float	 frameRate;
+		uint32_t padding;
+	};
+
+	struct AttributeFormat {
+		MeshBuffer	buffer;
+		GLint		components;
+		uint32_t	size;
+		bool		integer;
+	};
+
+	//Interleaved in this order, each attribute only present if its bit is set in the mesh's attributeMask
+	const AttributeFormat AttributeFormats[] = {
+		{ VERTEX_BUFFER,		3, sizeof(Vector3),		false },
+		{ COLOUR_BUFFER,		4, sizeof(Vector4),		false },
+		{ TEXTURE_BUFFER,		2, sizeof(Vector2),		false },
+		{ NORMAL_BUFFER,		3, sizeof(Vector3),		false },
+		{ TANGENT_BUFFER,		4, sizeof(Vector4),		false },
+		{ WEIGHTVALUE_BUFFER,	4, sizeof(Vector4),		false },
+		{ WEIGHTINDEX_BUFFER,	4, sizeof(int) * 4,		true  },
+	};
+
+	const size_t BlobAlignment = 16;
+
+	class CookWriter {
+	public:
+		template <class T>
+		void Write(const T& value) {
+			WriteBytes(&value, sizeof(T));
+		}
+
+		void WriteBytes(const void* source, size_t byteCount) {
+			const char* bytes = (const char*)source;
+			data.insert(data.end(), bytes, bytes + byteCount);
+		}
+
+		void WriteString(const std::string& s) {
+			Write((uint32_t)s.size());
+			WriteBytes(s.data(), s.size());
+			Align(4);
+		}
+
+		void Align(size_t alignment) {
+			data.resize(((data.size() + alignment - 1) / alignment) * alignment, 0);
+		}
+
+		std::vector<char> data;
+	};
+
+	class CookReader {
+	public:
+		CookReader(const char* data, size_t size) : data(data), size(size) {
+		}
+
+		const char* Take(size_t byteCount) {
+			if (failed || byteCount > size - offset) {
+				failed = true;
+				return nullptr;
+			}
+			const char* start = data + offset;
+			offset += byteCount;
+			return start;
+		}
+
+		template <class T>
+		bool Read(T& value) {
+			const char* source = Take(sizeof(T));
+			if (!source) {
+				return false;
+			}
+			memcpy(&value, source, sizeof(T));
+			return true;
+		}
+
+		bool ReadString(std::string& s) {
+			uint32_t length = 0;
+			if (!Read(length)) {
+				return false;
+			}
+			const char* source = Take(length);
+			if (!source) {
+				return false;
+			}
+			s.assign(source, length);
+			Align(4);
+			return !failed;
+		}
+
+		void Align(size_t alignment) {
+			size_t aligned = ((offset + alignment - 1) / alignment) * alignment;
+			if (aligned > size) {
+				failed = true;
+				return;
+			}
+			offset = aligned;
+		}
+
+		bool Failed() const {
+			return failed;
+		}
+
+	protected:
+		const char* data;
+		size_t		size;
+		size_t		offset = 0;
+		bool		failed = false;
+	};
+
+	//A mesh whose vertex data lives in one interleaved VBO, uploaded directly from the mapped file.
+	//No CPU side copies of the attributes are kept.
+	class CookedMesh : public ::Mesh {
+	public:
+		CookedMesh(const CookedMeshHeader& header, const char* vertexData, const unsigned int* indexData) {
+			numVertices = header.vertexCount;
+			numIndices	= header.indexCount;
+			boundsMin	= header.boundsMin;
+			boundsMax	= header.boundsMax;
+			hasBounds	= header.vertexCount > 0;
+
+			glBindVertexArray(arrayObject);
+
+			glGenBuffers(1, &bufferObject[VERTEX_BUFFER]);
+			glBindBuffer(GL_ARRAY_BUFFER, bufferObject[VERTEX_BUFFER]);
+			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)header.vertexStride * numVertices, vertexData, GL_STATIC_DRAW);
+			glObjectLabel(GL_BUFFER, bufferObject[VERTEX_BUFFER], -1, "Cooked Vertices");
+
+			size_t offset = 0;
+			size_t attributeOffsets[MAX_BUFFER] = {};
+			for (const auto& f : AttributeFormats) {
+				if (!(header.attributeMask & (1 << f.buffer))) {
+					continue;
+				}
+				attributeOffsets[f.buffer] = offset;
+				if (f.integer) {
+					glVertexAttribIPointer(f.buffer, f.components, GL_INT, header.vertexStride, (const GLvoid*)offset);
+				}
+				else {
+					glVertexAttribPointer(f.buffer, f.components, GL_FLOAT, GL_FALSE, header.vertexStride, (const GLvoid*)offset);
+				}
+				glEnableVertexAttribArray(f.buffer);
+				offset += f.size;
+			}
+
+			if (indexData && numIndices > 0) {
+				glGenBuffers(1, &bufferObject[INDEX_BUFFER]);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferObject[INDEX_BUFFER]);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(GLuint), indexData, GL_STATIC_DRAW);
+				glObjectLabel(GL_BUFFER, bufferObject[INDEX_BUFFER], -1, "Cooked Indices");
+			}
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			vertexStride = header.vertexStride;
+
+			//Interleaved vertices drag every attribute through the cache when only the position
+			//is needed, so depth passes get their own packed position (+ skinning) copy
+			if (header.attributeMask & (1 << VERTEX_BUFFER)) {
+				const bool skinned = (header.attributeMask & (1 << WEIGHTVALUE_BUFFER)) &&
+									 (header.attributeMask & (1 << WEIGHTINDEX_BUFFER));
+				const size_t depthStride = sizeof(Vector3) + (skinned ? sizeof(Vector4) + sizeof(int) * 4 : 0);
+				std::vector<char> packed(depthStride * numVertices);
+				for (size_t i = 0; i < numVertices; ++i) {
+					const char* in	= vertexData + (size_t)header.vertexStride * i;
+					char*		out = packed.data() + depthStride * i;
+					memcpy(out, in + attributeOffsets[VERTEX_BUFFER], sizeof(Vector3));
+					if (skinned) {
+						memcpy(out + sizeof(Vector3), in + attributeOffsets[WEIGHTVALUE_BUFFER], sizeof(Vector4));
+						memcpy(out + sizeof(Vector3) + sizeof(Vector4), in + attributeOffsets[WEIGHTINDEX_BUFFER], sizeof(int) * 4);
+					}
+				}
+				BufferDepthData(packed.data(), skinned);
+			}
+		}
+
+		void SetSubMeshes(const std::vector<SubMesh>& subMeshes) {
+			meshLayers = subMeshes;
+		}
+	};
+
+	bool GetSourceStamp(const std::string& filename, uint64_t& size, int64_t& time) {
+		std::error_code error;
+		size = (uint64_t)std::filesystem::file_size(filename, error);
+		if (error) {
+			return false;
+		}
+		auto writeTime = std::filesystem::last_write_time(filename, error);
+		if (error) {
+			return false;
+		}
+		time = (int64_t)writeTime.time_since_epoch().count();
+		return true;
+	}
+
+	//Referenced files that don't exist (a model shipped without one of its images) get a stamp of their
+	//own, so the model still cooks and the cooked file is invalidated if the file turns up later
+	const uint64_t MissingFileSize = ~0ull;
+
+	bool GetDependencyStamp(const std::string& filename, uint64_t& size, int64_t& time) {
+		if (filename.empty()) {
+			return false;
+		}
+		if (!GetSourceStamp(filename, size, time)) {
+			size = MissingFileSize;
+			time = 0;
+		}
+		return true;
+	}
+
+	template <class T>
+	int32_t FindIndex(const std::vector<std::shared_ptr<T>>& list, const T* item) {
+		if (!item) {
+			return -1;
+		}
+		for (size_t i = 0; i < list.size(); ++i) {
+			if (list[i].get() == item) {
+				return (int32_t)i;
+			}
+		}
+		return -1;
+	}
+
+	SharedTexture TextureAt(const GLTFScene& scene, int32_t index) {
+		if (index < 0 || index >= (int32_t)scene.textures.size()) {
+			return nullptr;
+		}
+		return scene.textures[index];
+	}
+}
+
+std::string MeshCache::CookedPath(const std::string& sourceFile) {
+	return sourceFile + ".cooked";
+}
+
+bool MeshCache::Cook(const std::string& sourceFile, const GLTFScene& scene, const std::vector<std::string>& dependencies) {
+	FileHeader header = {};
+	header.magic				= CookedMagic;
+	header.version				= CookedVersion;
+	header.textureCount			= (uint32_t)scene.texturePaths.size();
+	header.materialLayerCount	= (uint32_t)scene.materialLayers.size();
+	header.meshCount			= (uint32_t)scene.meshes.size();
+	header.nodeCount			= (uint32_t)scene.sceneNodes.size();
+	header.animationCount		= (uint32_t)scene.animations.size();
+
+	if (!GetSourceStamp(sourceFile, header.sourceSize, header.sourceTime)) {
+		return false;
+	}
+	if (scene.texturePaths.size() != scene.textures.size()) {
+		return false;
+	}
+	for (const auto& path : scene.texturePaths) {
+		if (path.empty()) { //Embedded images have no file to point back to
+			std::cout << "MeshCache: " << sourceFile << " has embedded images, not cooking" << std::endl;
+			return false;
+		}
+	}
+
+	//Texture paths are stamped too - editing an image or a .bin must invalidate the cooked file
+	std::vector<std::string> stampedFiles = dependencies;
+	stampedFiles.insert(stampedFiles.end(), scene.texturePaths.begin(), scene.texturePaths.end());
+	header.dependencyCount = (uint32_t)stampedFiles.size();
+
+	CookWriter writer;
+	writer.Write(header);
+
+	for (const auto& path : stampedFiles) {
+		uint64_t size = 0;
+		int64_t	 time = 0;
+		if (!GetDependencyStamp(path, size, time)) {
+			std::cout << "MeshCache: Can't stamp " << path << ", not cooking " << sourceFile << std::endl;
+			return false;
+		}
+		writer.WriteString(path);
+		writer.Write(size);
+		writer.Write(time);
+	}
+
+	for (const auto& path : scene.texturePaths) {
+		writer.WriteString(path);
+	}
+
+	for (const auto& layer : scene.materialLayers) {
+		//Zeroed first so any struct padding is written out deterministically
+		CookedMaterialLayer l;
+		memset(&l, 0, sizeof(l));
+		l.albedo			= FindIndex(scene.textures, layer.albedo.get());
+		l.bump				= FindIndex(scene.textures, layer.bump.get());
+		l.occlusion			= FindIndex(scene.textures, layer.occlusion.get());
+		l.emission			= FindIndex(scene.textures, layer.emission.get());
+		l.metallic			= FindIndex(scene.textures, layer.metallic.get());
+		l.albedoColour		= layer.albedoColour;
+		l.emissionColour	= layer.emissionColour;
+		l.metallicFactor	= layer.metallicFactor;
+		l.roughnessFactor	= layer.roughnessFactor;
+		l.alphaCutoff		= layer.alphaCutoff;
+		l.doubleSided		= layer.doubleSided ? 1 : 0;
+		l.alphaMode			= (uint32_t)layer.alphaMode;
+		writer.Write(l);
+		writer.WriteString(layer.name);
+	}
+
+	for (size_t i = 0; i < scene.meshes.size(); ++i) {
+		const ::Mesh& m = *scene.meshes[i];
+
+		const void* streams[] = {
+			m.vertices, m.colours, m.textureCoords, m.normals, m.tangents, m.weights, m.weightIndices
+		};
+
+		CookedMeshHeader mh = {};
+		mh.vertexCount	= m.numVertices;
+		mh.indexCount	= m.indices ? m.numIndices : 0;
+		mh.subMeshCount = (uint32_t)m.meshLayers.size();
+		mh.jointCount	= (uint32_t)m.jointNames.size();
+		mh.poseMask		= (m.bindPose ? 1 : 0) | (m.inverseBindPose ? 2 : 0);
+
+		for (size_t a = 0; a < std::size(AttributeFormats); ++a) {
+			if (streams[a]) {
+				mh.attributeMask |= 1 << AttributeFormats[a].buffer;
+				mh.vertexStride	 += AttributeFormats[a].size;
+			}
+		}
+		if (m.vertices && m.numVertices > 0) {
+			mh.boundsMin = m.vertices[0];
+			mh.boundsMax = m.vertices[0];
+			for (GLuint v = 1; v < m.numVertices; ++v) {
+				mh.boundsMin = Vector3(std::min(mh.boundsMin.x, m.vertices[v].x), std::min(mh.boundsMin.y, m.vertices[v].y), std::min(mh.boundsMin.z, m.vertices[v].z));
+				mh.boundsMax = Vector3(std::max(mh.boundsMax.x, m.vertices[v].x), std::max(mh.boundsMax.y, m.vertices[v].y), std::max(mh.boundsMax.z, m.vertices[v].z));
+			}
+		}
+		writer.Write(mh);
+
+		const GLTFMaterial* material = i < scene.materials.size() ? &scene.materials[i] : nullptr;
+		for (uint32_t s = 0; s < mh.subMeshCount; ++s) {
+			CookedSubMesh sm;
+			memset(&sm, 0, sizeof(sm));
+			sm.start			= m.meshLayers[s].start;
+			sm.count			= m.meshLayers[s].count;
+			sm.base				= m.meshLayers[s].base;
+			sm.materialLayer	= (material && s < material->layerIndices.size()) ? material->layerIndices[s] : -1;
+			writer.Write(sm);
+		}
+
+		for (const auto& name : m.jointNames) {
+			writer.WriteString(name);
+		}
+		for (uint32_t j = 0; j < mh.jointCount; ++j) {
+			writer.Write((int32_t)(j < m.jointParents.size() ? m.jointParents[j] : -1));
+		}
+		if (m.bindPose) {
+			writer.WriteBytes(m.bindPose, sizeof(Matrix4) * mh.jointCount);
+		}
+		if (m.inverseBindPose) {
+			writer.WriteBytes(m.inverseBindPose, sizeof(Matrix4) * mh.jointCount);
+		}
+
+		//The interleaved stream - this is the bit that gets handed straight to the GPU on load
+		writer.Align(BlobAlignment);
+		size_t vertexStart = writer.data.size();
+		writer.data.resize(vertexStart + (size_t)mh.vertexStride * mh.vertexCount);
+		char* vertexOut = writer.data.data() + vertexStart;
+		for (GLuint v = 0; v < mh.vertexCount; ++v) {
+			for (size_t a = 0; a < std::size(AttributeFormats); ++a) {
+				if (!streams[a]) {
+					continue;
+				}
+				const uint32_t attribSize = AttributeFormats[a].size;
+				memcpy(vertexOut, (const char*)streams[a] + (size_t)attribSize * v, attribSize);
+				vertexOut += attribSize;
+			}
+		}
+		writer.Align(BlobAlignment);
+		if (mh.indexCount > 0) {
+			writer.WriteBytes(m.indices, sizeof(unsigned int) * mh.indexCount);
+			writer.Align(BlobAlignment);
+		}
+	}
+
+	for (const auto& node : scene.sceneNodes) {
+		CookedNode n;
+		memset(&n, 0, sizeof(n));
+		n.localMatrix	= node.localMatrix;
+		n.worldMatrix	= node.worldMatrix;
+		n.nodeID		= node.nodeID;
+		n.parent		= node.parent;
+		n.childCount	= (uint32_t)node.children.size();
+		n.mesh			= -1;
+		for (size_t i = 0; i < scene.meshes.size(); ++i) {
+			if (scene.meshes[i].get() == node.mesh) {
+				n.mesh = (int32_t)i;
+				break;
+			}
+		}
+		writer.Write(n);
+		writer.WriteString(node.name);
+		for (int32_t child : node.children) {
+			writer.Write(child);
+		}
+	}
+
+	for (const auto& anim : scene.animations) {
+		CookedAnimation a = {};
+		a.jointCount	= anim->GetJointCount();
+		a.frameCount	= anim->GetFrameCount();
+		a.frameRate		= anim->GetFrameRate();
+		writer.Write(a);
+		writer.Align(BlobAlignment);
+		if (a.frameCount > 0 && a.jointCount > 0) {
+			writer.WriteBytes(anim->GetJointData(0), sizeof(Matrix4) * a.jointCount * a.frameCount);
+		}
+	}
+
+	//Write to a temporary and swap it in, so a half written file never looks like a valid cache
+	std::string cookedFile	= CookedPath(sourceFile);
+	std::string tempFile	= cookedFile + ".tmp";
+	{
+		std::ofstream file(tempFile, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			std::cout << "MeshCache: Can't write cooked file " << tempFile << std::endl;
+			return false;
+		}
+		file.write(writer.data.data(), (std::streamsize)writer.data.size());
+		if (!file) {
+			std::cout << "MeshCache: Failed writing cooked file " << tempFile << std::endl;
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(tempFile, cookedFile, error);
+	if (error) {
+		std::filesystem::remove(tempFile, error);
+		return false;
+	}
+	std::cout << "MeshCache: Cooked " << sourceFile << " (" << writer.data.size() << " bytes)" << std::endl;
+	return true;
+}
+
+bool MeshCache::Load(const std::string& sourceFile, GLTFScene& intoScene) {
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	uint64_t sourceSize = 0;
+	int64_t	 sourceTime = 0;
+	if (!GetSourceStamp(sourceFile, sourceSize, sourceTime)) {
+		return false;
+	}
+
+	std::string cookedFile = CookedPath(sourceFile);
+	MappedFile	mapped(cookedFile);
+	if (!mapped.Data()) {
+		return false;
+	}
+	CookReader reader(mapped.Data(), mapped.Size());
+
+	FileHeader header;
+	if (!reader.Read(header) || header.magic != CookedMagic || header.version != CookedVersion) {
+		std::cout << "MeshCache: " << cookedFile << " has incompatible version, recooking" << std::endl;
+		return false;
+	}
+	if (header.sourceSize != sourceSize || header.sourceTime != sourceTime) {
+		std::cout << "MeshCache: " << cookedFile << " is out of date, recooking" << std::endl;
+		return false;
+	}
+	for (uint32_t i = 0; i < header.dependencyCount; ++i) {
+		std::string path;
+		uint64_t	cookedSize = 0;
+		int64_t		cookedTime = 0;
+		if (!reader.ReadString(path) || !reader.Read(cookedSize) || !reader.Read(cookedTime)) {
+			return false;
+		}
+		if (!GetDependencyStamp(path, sourceSize, sourceTime) || sourceSize != cookedSize || sourceTime != cookedTime) {
+			std::cout << "MeshCache: " << path << " changed since " << cookedFile << " was cooked, recooking" << std::endl;
+			return false;
+		}
+	}
+
+	//Everything goes into a local scene first, so a truncated file leaves intoScene untouched
+	GLTFScene scene;
+
+	for (uint32_t i = 0; i < header.textureCount && !reader.Failed(); ++i) {
+		std::string path;
+		if (!reader.ReadString(path)) {
+			break;
+		}
+		scene.textures.push_back(OGLTexture::TextureFromFile(path));
+		scene.texturePaths.push_back(path);
+	}
+
+	for (uint32_t i = 0; i < header.materialLayerCount && !reader.Failed(); ++i) {
+		CookedMaterialLayer l;
+		GLTFMaterialLayer layer;
+		if (!reader.Read(l) || !reader.ReadString(layer.name)) {
+			break;
+		}
+		layer.albedo			= TextureAt(scene, l.albedo);
+		layer.bump				= TextureAt(scene, l.bump);
+		layer.occlusion			= TextureAt(scene, l.occlusion);
+		layer.emission			= TextureAt(scene, l.emission);
+		layer.metallic			= TextureAt(scene, l.metallic);
+		layer.albedoColour		= l.albedoColour;
+		layer.emissionColour	= l.emissionColour;
+		layer.metallicFactor	= l.metallicFactor;
+		layer.roughnessFactor	= l.roughnessFactor;
+		layer.alphaCutoff		= l.alphaCutoff;
+		layer.doubleSided		= l.doubleSided != 0;
+		layer.alphaMode			= (GLTFAlphaMode)l.alphaMode;
+		scene.materialLayers.push_back(layer);
+	}
+
+	for (uint32_t i = 0; i < header.meshCount && !reader.Failed(); ++i) {
+		CookedMeshHeader mh;
+		if (!reader.Read(mh)) {
+			break;
+		}
+		std::vector<::Mesh::SubMesh> subMeshes(mh.subMeshCount);
+		GLTFMaterial material;
+		for (auto& sm : subMeshes) {
+			CookedSubMesh cooked;
+			if (!reader.Read(cooked)) {
+				break;
+			}
+			sm.start	= cooked.start;
+			sm.count	= cooked.count;
+			sm.base		= cooked.base;
+
+			GLTFMaterialLayer matLayer;
+			if (cooked.materialLayer >= 0 && cooked.materialLayer < (int32_t)scene.materialLayers.size()) {
+				matLayer = scene.materialLayers[cooked.materialLayer];
+			}
+			material.allLayers.push_back(matLayer);
+			material.layerIndices.push_back(cooked.materialLayer);
+		}
+
+		std::vector<std::string>	jointNames(mh.jointCount);
+		std::vector<int>			jointParents(mh.jointCount);
+		for (auto& name : jointNames) {
+			reader.ReadString(name);
+		}
+		for (auto& parent : jointParents) {
+			int32_t p = -1;
+			reader.Read(p);
+			parent = p;
+		}
+		const Matrix4* bindPose			= (mh.poseMask & 1) ? (const Matrix4*)reader.Take(sizeof(Matrix4) * mh.jointCount) : nullptr;
+		const Matrix4* inverseBindPose	= (mh.poseMask & 2) ? (const Matrix4*)reader.Take(sizeof(Matrix4) * mh.jointCount) : nullptr;
+
+		reader.Align(BlobAlignment);
+		const char* vertexData = reader.Take((size_t)mh.vertexStride * mh.vertexCount);
+		reader.Align(BlobAlignment);
+		const unsigned int* indexData = nullptr;
+		if (mh.indexCount > 0) {
+			indexData = (const unsigned int*)reader.Take(sizeof(unsigned int) * mh.indexCount);
+			reader.Align(BlobAlignment);
+		}
+		if (reader.Failed()) {
+			break;
+		}
+
+		auto mesh = std::make_shared<CookedMesh>(mh, vertexData, indexData);
+		mesh->SetSubMeshes(subMeshes);
+		if (mh.jointCount > 0) {
+			mesh->SetJointNames(jointNames);
+			mesh->SetJointParents(jointParents);
+			if (bindPose) {
+				mesh->SetBindPose(std::vector<Matrix4>(bindPose, bindPose + mh.jointCount));
+			}
+			if (inverseBindPose) {
+				mesh->SetInverseBindPose(std::vector<Matrix4>(inverseBindPose, inverseBindPose + mh.jointCount));
+			}
+		}
+		scene.meshes.push_back(mesh);
+		scene.materials.push_back(material);
+	}
+
+	scene.sceneNodes.resize(header.nodeCount);
+	for (auto& node : scene.sceneNodes) {
+		CookedNode n;
+		if (!reader.Read(n) || !reader.ReadString(node.name)) {
+			break;
+		}
+		node.localMatrix	= n.localMatrix;
+		node.worldMatrix	= n.worldMatrix;
+		node.nodeID			= n.nodeID;
+		node.parent			= n.parent;
+		node.mesh			= (n.mesh >= 0 && n.mesh < (int32_t)scene.meshes.size()) ? scene.meshes[n.mesh].get() : nullptr;
+		node.children.resize(n.childCount);
+		for (auto& child : node.children) {
+			reader.Read(child);
+		}
+	}
+
+	for (uint32_t i = 0; i < header.animationCount && !reader.Failed(); ++i) {
+		CookedAnimation a;
+		if (!reader.Read(a)) {
+			break;
+		}
+		reader.Align(BlobAlignment);
+		const size_t matrixCount = (size_t)a.jointCount * a.frameCount;
+		const Matrix4* frameData = (const Matrix4*)reader.Take(sizeof(Matrix4) * matrixCount);
+		if (!frameData) {
+			break;
+		}
+		std::vector<Matrix4> frames(frameData, frameData + matrixCount);
+		scene.animations.push_back(std::make_shared<MeshAnimation>(a.jointCount, a.frameCount, a.frameRate, frames));
+	}
+
+	if (reader.Failed()) {
+		std::cout << "MeshCache: " << cookedFile << " is truncated, recooking" << std::endl;
+		return false;
+	}
+
+	intoScene = std::move(scene);
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	std::cout << "MeshCache: Loaded " << cookedFile << " in "
+		<< std::chrono::duration<float, std::milli>(endTime - startTime).count() << "ms" << std::endl;
+	return true;
+}
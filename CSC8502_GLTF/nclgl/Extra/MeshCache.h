@@ -0,0 +1,39 @@
+/******************************************************************************
+Class:MeshCache
+Implements:
+Description:Cooked binary cache for GLTFScene data. The first time a glTF file
+is loaded its geometry, skins, materials, nodes and baked animations are written
+out next to it as a single binary file. Later loads memory map that file and
+hand the interleaved vertex / index blobs straight to glBufferData, skipping the
+JSON parse and all the intermediate std::vector copies.
+
+The cache is keyed on the size and last write time of the source file and of
+every external file it references (.bin buffers and images - a missing image is
+recorded as missing), and on the format version below - bump CookedVersion
+whenever the layout changes!
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct GLTFScene;
+
+class MeshCache	{
+public:
+	static const uint32_t CookedMagic	= 0x434D434E; //'NCMC'
+	static const uint32_t CookedVersion = 2;
+
+	//Fills an empty scene from the cooked file for sourceFile, if one exists and is up to date
+	static bool Load(const std::string& sourceFile, GLTFScene& intoScene);
+
+	//Writes out the cooked file for sourceFile - the scene must only contain that file's data.
+	//dependencies lists external files the scene was built from that it doesn't record itself (.bin buffers)
+	static bool Cook(const std::string& sourceFile, const GLTFScene& fromScene, const std::vector<std::string>& dependencies);
+
+	static std::string CookedPath(const std::string& sourceFile);
+
+protected:
+	MeshCache()  = delete;
+	~MeshCache() = delete;
+};
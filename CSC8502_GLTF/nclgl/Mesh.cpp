@@ -1,10 +1,14 @@
 #include "Mesh.h"
 #include "Matrix2.h"
+#include <algorithm>
+#include <vector>
 
 using std::string;
 
 Mesh::Mesh(void)	{
 	glGenVertexArrays(1, &arrayObject);
+	depthArrayObject	= 0;
+	depthBufferObject	= 0;
 	
 	for(int i = 0; i < MAX_BUFFER; ++i) {
 		bufferObject[i] = 0;
@@ -14,6 +18,8 @@ Mesh::Mesh(void)	{
 	type		 = GL_TRIANGLES;
 
 	numIndices		= 0;
+	vertexStride		= 0;
+	depthVertexStride	= 0;
 	vertices		= nullptr;
 	textureCoords	= nullptr;
 	normals			= nullptr;
@@ -25,6 +31,8 @@ Mesh::Mesh(void)	{
 
 	bindPose		= nullptr;
 	inverseBindPose = nullptr;
+
+	hasBounds		= false;
 }
 
 Mesh* Mesh::MeshFromVectors(
@@ -93,6 +101,12 @@ Mesh* Mesh::MeshFromVectors(
 Mesh::~Mesh(void)	{
 	glDeleteVertexArrays(1, &arrayObject);			//Delete our VAO
 	glDeleteBuffers(MAX_BUFFER, bufferObject);		//Delete our VBOs
+	if (depthArrayObject) {
+		glDeleteVertexArrays(1, &depthArrayObject);
+	}
+	if (depthBufferObject) {
+		glDeleteBuffers(1, &depthBufferObject);
+	}
 
 	delete[]	vertices;
 	delete[]	indices;
@@ -105,11 +119,47 @@ Mesh::~Mesh(void)	{
 }
 
 void Mesh::Draw()	{
-	glBindVertexArray(arrayObject);
-	if(bufferObject[INDEX_BUFFER]) {
-		glDrawElements(type, numIndices, GL_UNSIGNED_INT, 0);
+	DrawVertexArray(arrayObject, 0);
+}
+
+void Mesh::DrawDepth() {
+	DrawVertexArray(depthArrayObject ? depthArrayObject : arrayObject, 0);
+}
+
+void Mesh::DrawDepthInstanced(int instanceCount) {
+	if (instanceCount <= 0) {
+		return;
+	}
+	DrawVertexArray(depthArrayObject ? depthArrayObject : arrayObject, instanceCount);
+}
+
+//instanceCount of 0 issues the plain (non instanced) draw calls
+void Mesh::DrawVertexArray(GLuint vao, int instanceCount) {
+	glBindVertexArray(vao);
+	if(bufferObject[INDEX_BUFFER] && meshLayers.size() > 1) {
+		//glTF primitives index relative to their own first vertex, so draw each with its base
+		for (const SubMesh& m : meshLayers) {
+			const GLvoid* offset = (const GLvoid*)(m.start * sizeof(unsigned int));
+			if (instanceCount > 0) {
+				glDrawElementsInstancedBaseVertex(type, m.count, GL_UNSIGNED_INT, offset, instanceCount, m.base);
+			}
+			else {
+				glDrawElementsBaseVertex(type, m.count, GL_UNSIGNED_INT, offset, m.base);
+			}
+		}
+	}
+	else if(bufferObject[INDEX_BUFFER]) {
+		if (instanceCount > 0) {
+			glDrawElementsInstanced(type, numIndices, GL_UNSIGNED_INT, 0, instanceCount);
+		}
+		else {
+			glDrawElements(type, numIndices, GL_UNSIGNED_INT, 0);
+		}
+	}
+	else if (instanceCount > 0) {
+		glDrawArraysInstanced(type, 0, numVertices, instanceCount);
 	}
-	else{
+	else {
 		glDrawArrays(type, 0, numVertices);
 	}
 	glBindVertexArray(0);	
@@ -124,7 +174,7 @@ void Mesh::DrawSubMesh(int i) {
 	glBindVertexArray(arrayObject);
 	if (bufferObject[INDEX_BUFFER]) {
 		const GLvoid* offset = (const GLvoid * )(m.start * sizeof(unsigned int)); 
-		glDrawElements(type, m.count, GL_UNSIGNED_INT, offset);
+		glDrawElementsBaseVertex(type, m.count, GL_UNSIGNED_INT, offset, m.base);
 	}
 	else {
 		glDrawArrays(type, m.start, m.count);	//Draw the triangle!
@@ -132,6 +182,30 @@ void Mesh::DrawSubMesh(int i) {
 	glBindVertexArray(0);
 }
 
+void Mesh::DrawInstanced(int instanceCount) {
+	if (instanceCount <= 0) {
+		return;
+	}
+	DrawVertexArray(arrayObject, instanceCount);
+}
+
+void Mesh::DrawSubMeshInstanced(int i, int instanceCount) {
+	if (i < 0 || i >= (int)meshLayers.size() || instanceCount <= 0) {
+		return;
+	}
+	SubMesh m = meshLayers[i];
+
+	glBindVertexArray(arrayObject);
+	if (bufferObject[INDEX_BUFFER]) {
+		const GLvoid* offset = (const GLvoid*)(m.start * sizeof(unsigned int));
+		glDrawElementsInstancedBaseVertex(type, m.count, GL_UNSIGNED_INT, offset, instanceCount, m.base);
+	}
+	else {
+		glDrawArraysInstanced(type, m.start, m.count, instanceCount);
+	}
+	glBindVertexArray(0);
+}
+
 void UploadAttribute(GLuint* id, int numElements, int dataSize, int attribSize, int attribID, void* pointer, const string&debugName) {
 	glGenBuffers(1, id);
 	glBindBuffer(GL_ARRAY_BUFFER, *id);
@@ -144,6 +218,15 @@ void UploadAttribute(GLuint* id, int numElements, int dataSize, int attribSize,
 }
 
 void	Mesh::BufferData()	{
+	if (vertices && numVertices > 0) {
+		boundsMin = vertices[0];
+		boundsMax = vertices[0];
+		for (GLuint i = 1; i < numVertices; ++i) {
+			boundsMin = Vector3(std::min(boundsMin.x, vertices[i].x), std::min(boundsMin.y, vertices[i].y), std::min(boundsMin.z, vertices[i].z));
+			boundsMax = Vector3(std::max(boundsMax.x, vertices[i].x), std::max(boundsMax.y, vertices[i].y), std::max(boundsMax.z, vertices[i].z));
+		}
+		hasBounds = true;
+	}
 	glBindVertexArray(arrayObject);
 
 	////Buffer vertex data
@@ -191,6 +274,70 @@ void	Mesh::BufferData()	{
 	glBindVertexArray(0);	
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	vertexStride = sizeof(Vector3);
+	vertexStride += textureCoords	? sizeof(Vector2) : 0;
+	vertexStride += colours			? sizeof(Vector4) : 0;
+	vertexStride += normals			? sizeof(Vector3) : 0;
+	vertexStride += tangents		? sizeof(Vector4) : 0;
+	vertexStride += weights			? sizeof(Vector4) : 0;
+	vertexStride += weightIndices	? sizeof(int) * 4 : 0;
+
+	//Skinned meshes get positions, weights and joint indices packed into one stream,
+	//so the depth pass reads a single buffer instead of three
+	const bool skinned = weights && weightIndices;
+	std::vector<char> packed;
+	if (skinned && vertices) {
+		const size_t stride = sizeof(Vector3) + sizeof(Vector4) + sizeof(int) * 4;
+		packed.resize(stride * numVertices);
+		for (GLuint i = 0; i < numVertices; ++i) {
+			char* out = packed.data() + stride * i;
+			memcpy(out, &vertices[i], sizeof(Vector3));
+			memcpy(out + sizeof(Vector3), &weights[i], sizeof(Vector4));
+			memcpy(out + sizeof(Vector3) + sizeof(Vector4), &weightIndices[i * 4], sizeof(int) * 4);
+		}
+	}
+	BufferDepthData(packed.empty() ? nullptr : packed.data(), skinned);
+}
+
+void	Mesh::BufferDepthData(const void* packedVertices, bool skinned) {
+	if (!bufferObject[VERTEX_BUFFER] && !packedVertices) {
+		return;
+	}
+	if (!depthArrayObject) {
+		glGenVertexArrays(1, &depthArrayObject);
+	}
+	glBindVertexArray(depthArrayObject);
+
+	const GLuint stride = (GLuint)(sizeof(Vector3) + (skinned ? sizeof(Vector4) + sizeof(int) * 4 : 0));
+	if (packedVertices) {
+		if (!depthBufferObject) {
+			glGenBuffers(1, &depthBufferObject);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, depthBufferObject);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)stride * numVertices, packedVertices, GL_STATIC_DRAW);
+		glObjectLabel(GL_BUFFER, depthBufferObject, -1, "Depth Stream");
+	}
+	else {
+		glBindBuffer(GL_ARRAY_BUFFER, bufferObject[VERTEX_BUFFER]);
+	}
+
+	glVertexAttribPointer(VERTEX_BUFFER, 3, GL_FLOAT, GL_FALSE, stride, 0);
+	glEnableVertexAttribArray(VERTEX_BUFFER);
+	if (skinned) {
+		glVertexAttribPointer(WEIGHTVALUE_BUFFER, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)sizeof(Vector3));
+		glEnableVertexAttribArray(WEIGHTVALUE_BUFFER);
+		glVertexAttribIPointer(WEIGHTINDEX_BUFFER, 4, GL_INT, stride, (const GLvoid*)(sizeof(Vector3) + sizeof(Vector4)));
+		glEnableVertexAttribArray(WEIGHTINDEX_BUFFER);
+	}
+	if (bufferObject[INDEX_BUFFER]) {
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferObject[INDEX_BUFFER]);
+	}
+	depthVertexStride = stride;
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 
@@ -48,6 +48,8 @@ struct Vector4i {
 
 class Mesh	{
 public:	
+	friend class MeshCache;
+
 	struct SubMesh {
 		int start	= 0;
 		int count	= 0;
@@ -60,6 +62,15 @@ public:
 	void Draw();
 	void DrawSubMesh(int i);
 
+	//Instance data is up to the shader (eg gl_InstanceID into a buffer of matrices)
+	void DrawInstanced(int instanceCount);
+	void DrawSubMeshInstanced(int i, int instanceCount);
+
+	//Depth-only passes (shadows, depth prepasses) draw through a second VAO that only
+	//enables positions, plus the skinning attributes for skinned meshes
+	void DrawDepth();
+	void DrawDepthInstanced(int instanceCount);
+
 	static Mesh* LoadFromMeshFile(const std::string& name);
 
 	static Mesh* MeshFromVectors(
@@ -75,11 +86,25 @@ public:
 		const std::vector< SubMesh>& meshSetup
 	);
 
+	//Cooked and streamed meshes drop their CPU-side indices, so test the GPU index buffer
 	unsigned int GetTriCount() const {
-		int primCount = indices ? numIndices : numVertices;
+		int primCount = bufferObject[INDEX_BUFFER] ? numIndices : numVertices;
 		return primCount / 3;
 	}
 
+	unsigned int GetVertexCount() const {
+		return numVertices;
+	}
+
+	//Bytes per vertex across all attribute streams, and in the depth-only stream
+	unsigned int GetVertexStride() const {
+		return vertexStride;
+	}
+
+	unsigned int GetDepthVertexStride() const {
+		return depthVertexStride ? depthVertexStride : vertexStride;
+	}
+
 	unsigned int GetJointCount() const {
 		return (unsigned int)jointNames.size();
 	}
@@ -100,6 +125,13 @@ public:
 		return (int)meshLayers.size(); 
 	}
 
+	//Object space bounding box of the positions, if the mesh had any
+	bool GetBounds(Vector3& outMin, Vector3& outMax) const {
+		outMin = boundsMin;
+		outMax = boundsMax;
+		return hasBounds;
+	}
+
 	bool GetSubMesh(int i, const SubMesh* s) const;
 	bool GetSubMesh(const std::string& name, const SubMesh* s) const;
 
@@ -114,13 +146,21 @@ public:
 
 protected:
 	void	BufferData();
+	//Static meshes pass nullptr and reuse the position VBO; otherwise packedVertices holds
+	//numVertices tightly packed positions, followed per vertex by weights and joint indices if skinned
+	void	BufferDepthData(const void* packedVertices, bool skinned);
+	void	DrawVertexArray(GLuint vao, int instanceCount);
 
 	GLuint	arrayObject;
+	GLuint	depthArrayObject;
+	GLuint	depthBufferObject;
 
 	GLuint	bufferObject[MAX_BUFFER];
 
 	GLuint	numVertices;
 	GLuint	numIndices;
+	GLuint	vertexStride;
+	GLuint	depthVertexStride;
 	
 	GLuint	type;
 
@@ -138,6 +178,10 @@ protected:
 	Matrix4* bindPose;
 	Matrix4* inverseBindPose;
 
+	Vector3	boundsMin;
+	Vector3	boundsMax;
+	bool	hasBounds;
+
 	std::vector<std::string>	jointNames;
 	std::vector<int>			jointParents;
 	std::vector< SubMesh>		meshLayers;
@@ -13,16 +13,38 @@ uniform vec3 uLightPosition;
 uniform vec3 uLightColor;
 uniform vec3 uAmbientColor;
 
-const int MAX_POINT_LIGHTS = 4;
+// 分簇点光源，簇的划分与 LightClusterer 一致
+const int CLUSTERS_X = 16;
+const int CLUSTERS_Y = 9;
+const int CLUSTERS_Z = 24;
+struct ClusterLight {
+    vec4 positionRadius;
+    vec4 color;
+};
+layout(std430, binding = 3) readonly buffer ClusterLights {
+    ClusterLight clusterLights[];
+};
+layout(std430, binding = 4) readonly buffer ClusterRanges {
+    uvec2 clusterRanges[];
+};
+layout(std430, binding = 5) readonly buffer ClusterLightIndices {
+    uint clusterLightIndices[];
+};
 uniform int uPointLightCount;
-uniform vec3 uPointLightPositions[MAX_POINT_LIGHTS];
-uniform vec3 uPointLightColors[MAX_POINT_LIGHTS];
-uniform vec3 uPointLightAmbient[MAX_POINT_LIGHTS];
+uniform vec3 uPointAmbient;
+// (投影 x 缩放, 投影 y 缩放, 第一个切片的深度, 切片比例)
+uniform vec4 uClusterParams;
 
 uniform vec3 uCameraPos;
-uniform mat4 uShadowMatrix;
+const int MAX_SHADOW_CASCADES = 4;
+uniform mat4 uShadowMatrices[MAX_SHADOW_CASCADES];
+uniform int uShadowCascadeCount;
 uniform sampler2DShadow uShadowMap;
 uniform float uShadowStrength;
+// 0：深度比较；1：EVSM2；2：EVSM4。uEvsmParams = (正指数, 负指数, 漏光抑制)
+uniform int uShadowFilter;
+uniform sampler2D uShadowMoments;
+uniform vec3 uEvsmParams;
 uniform vec3 uFogColor;
 uniform float uFogDensity;
 
@@ -108,23 +130,69 @@ vec3 FresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
 }
 
+// 级联由近到远排列，取第一个包含该点的级联；各级联位于 2 × 2 阴影图集的对应块中
+const int SHADOW_MOMENT_MAX_LEVEL = 3;
+
+float ChebyshevUpperBound(vec2 moments, float mean, float minVariance) {
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float delta = mean - moments.x;
+    float pMax = variance / (variance + delta * delta);
+    // 把低于 uEvsmParams.z 的可见度压为全影，抑制重叠投射体之间的漏光
+    pMax = clamp((pMax - uEvsmParams.z) / (1.0 - uEvsmParams.z), 0.0, 1.0);
+    return mean <= moments.x ? 1.0 : pMax;
+}
+
+float SampleShadowMoments(vec2 atlasUV, vec2 gradX, vec2 gradY, float depth) {
+    vec4 moments = textureGrad(uShadowMoments, atlasUV, gradX, gradY);
+    float warped = depth * 2.0 - 1.0;
+    float positive = exp(uEvsmParams.x * warped);
+    float positiveScale = 0.0001 * uEvsmParams.x * positive;
+    float visibility = ChebyshevUpperBound(moments.xy, positive, positiveScale * positiveScale);
+    if (uShadowFilter == 2) {
+        float negative = -exp(-uEvsmParams.y * warped);
+        float negativeScale = 0.0001 * uEvsmParams.y * negative;
+        visibility = min(visibility, ChebyshevUpperBound(moments.zw, negative, negativeScale * negativeScale));
+    }
+    return visibility;
+}
+
+vec2 ClampToMomentTile(vec2 atlasUV, int cascade) {
+    // mip 与各向异性采样的覆盖范围留在本级联块内
+    vec2 tileMin = vec2(cascade % 2, cascade / 2) * 0.5;
+    vec2 margin = vec2(float(1 << SHADOW_MOMENT_MAX_LEVEL) * 0.5) / vec2(textureSize(uShadowMoments, 0));
+    return clamp(atlasUV, tileMin + margin, tileMin + 0.5 - margin);
+}
+
 float EvaluateShadow(vec3 worldPos, vec3 normal) {
     if (uShadowStrength <= 0.0) {
         return 1.0;
     }
-    vec4 shadowCoord = uShadowMatrix * vec4(worldPos, 1.0);
-    if (shadowCoord.w <= 0.0) {
-        return 1.0;
-    }
-    vec3 projCoords = shadowCoord.xyz / shadowCoord.w;
-    projCoords = projCoords * 0.5 + 0.5;
-    if (projCoords.x < 0.0 || projCoords.x > 1.0 || projCoords.y < 0.0 || projCoords.y > 1.0) {
-        return 1.0;
+    // 导数须在级联循环的分支之外求出，循环内以 textureGrad 采样矩图集
+    vec3 worldDx = dFdx(worldPos);
+    vec3 worldDy = dFdy(worldPos);
+    for (int i = 0; i < uShadowCascadeCount; ++i) {
+        vec3 ndc = (uShadowMatrices[i] * vec4(worldPos, 1.0)).xyz;
+        // 留出约一个纹素的边距，线性过滤不会采到相邻的图集块
+        if (abs(ndc.x) > 0.998 || abs(ndc.y) > 0.998 || abs(ndc.z) > 1.0) {
+            continue;
+        }
+        vec3 projCoords = ndc * 0.5 + 0.5;
+        vec2 atlasUV = (projCoords.xy + vec2(i % 2, i / 2)) * 0.5;
+        vec3 lightDir = normalize(uLightPosition - worldPos);
+        float bias = max(0.002 * (1.0 - dot(normal, lightDir)), 0.0005);
+        float visibility;
+        if (uShadowFilter == 0) {
+            visibility = texture(uShadowMap, vec3(atlasUV, projCoords.z - bias));
+        }
+        else {
+            // 正交投影是仿射变换，世界空间导数直接映射为图集 UV 导数（NDC -> UV 与图集各缩放 0.5）
+            vec2 gradX = (uShadowMatrices[i] * vec4(worldDx, 0.0)).xy * 0.25;
+            vec2 gradY = (uShadowMatrices[i] * vec4(worldDy, 0.0)).xy * 0.25;
+            visibility = SampleShadowMoments(ClampToMomentTile(atlasUV, i), gradX, gradY, projCoords.z - bias);
+        }
+        return mix(1.0, visibility, clamp(uShadowStrength, 0.0, 1.0));
     }
-    vec3 lightDir = normalize(uLightPosition - worldPos);
-    float bias = max(0.002 * (1.0 - dot(normal, lightDir)), 0.0005);
-    float sample1 = texture(uShadowMap, vec3(projCoords.xy, projCoords.z - bias));
-    return mix(1.0, sample1, clamp(uShadowStrength, 0.0, 1.0));
+    return 1.0;
 }
 
 mat3 BuildTBN() {
@@ -168,6 +236,23 @@ vec3 F0) {
     return (diffuse + specular) * radiance;
 }
 
+int FindCluster(vec3 viewPos) {
+    float depth = max(-viewPos.z, 1e-4);
+    vec2 ndc = viewPos.xy * uClusterParams.xy / depth;
+    ivec2 tile = clamp(ivec2((ndc * 0.5 + 0.5) * vec2(CLUSTERS_X, CLUSTERS_Y)),
+                       ivec2(0), ivec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+    int slice = depth < uClusterParams.z ? 0 : 1 + int(log(depth / uClusterParams.z) * uClusterParams.w);
+    slice = clamp(slice, 0, CLUSTERS_Z - 1);
+    return (slice * CLUSTERS_Y + tile.y) * CLUSTERS_X + tile.x;
+}
+
+// 在影响半径处把平方反比衰减平滑地压到 0
+float PointLightWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float falloff = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return falloff * falloff;
+}
+
 void main() {
     vec3 viewDir = normalize(uCameraPos - vWorldPos);
     vec3 normal = GetNormal(vNormal);
@@ -228,16 +313,20 @@ void main() {
     float shadow = EvaluateShadow(vWorldPos, normal);
 
     vec3 pointLighting = vec3(0.0);
-    vec3 ambient = uAmbientColor * baseColor * ao;
-    for (int i = 0; i < uPointLightCount && i < MAX_POINT_LIGHTS; ++i) {
-        vec3 pointVector = uPointLightPositions[i] - vWorldPos;
-        float pointDistance = length(pointVector);
-        if (pointDistance > 1e-4) {
-            vec3 pointDir = normalize(pointVector);
-            vec3 pointRadiance = uPointLightColors[i] / max(pointDistance * pointDistance, 1e-4);
-            pointLighting += EvaluatePBRLighting(normal, viewDir, pointDir, pointRadiance, baseColor, metallic, roughness, F0);
+    vec3 ambient = (uAmbientColor + uPointAmbient) * baseColor * ao;
+    if (uPointLightCount > 0) {
+        uvec2 range = clusterRanges[FindCluster(vViewPos)];
+        for (uint i = 0u; i < range.y; ++i) {
+            ClusterLight light = clusterLights[clusterLightIndices[range.x + i]];
+            vec3 pointVector = light.positionRadius.xyz - vWorldPos;
+            float pointDistance = length(pointVector);
+            if (pointDistance > 1e-4 && pointDistance < light.positionRadius.w) {
+                vec3 pointDir = pointVector / pointDistance;
+                vec3 pointRadiance = light.color.rgb / max(pointDistance * pointDistance, 1e-4) *
+                                     PointLightWindow(pointDistance, light.positionRadius.w);
+                pointLighting += EvaluatePBRLighting(normal, viewDir, pointDir, pointRadiance, baseColor, metallic, roughness, F0);
+            }
         }
-        ambient += uPointLightAmbient[i] * baseColor * ao;
     }
 
     vec3 directLighting = shadow * directionalLighting + pointLighting;
@@ -1,13 +1,22 @@
 ﻿#version 460 core
 
+// 4 x uint16 归一化：xyz 为相对所在草块包围盒的量化位置，w 为随机种子。
 layout(location = 0) in vec4 inInstance;
 
+// 每个槽位两项：量化原点与量化范围。
+layout(std430, binding = 2) readonly buffer GrassTiles {
+    vec4 uTileQuant[];
+};
+
+uniform int uSlotCapacity;
+
 out VS_OUT {
     vec3 worldPos;
     float noise;
 } vsOut;
 
 void main() {
-    vsOut.worldPos = inInstance.xyz;
+    int slot = gl_VertexID / uSlotCapacity;
+    vsOut.worldPos = uTileQuant[slot * 2].xyz + inInstance.xyz * uTileQuant[slot * 2 + 1].xyz;
     vsOut.noise = inInstance.w;
 }
\ No newline at end of file
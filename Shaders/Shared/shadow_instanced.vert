@@ -0,0 +1,11 @@
+﻿#version 460 core
+layout(location = 0) in vec3 position;
+
+uniform mat4 uLightViewProj;
+layout(std430, binding = 1) readonly buffer InstanceMatrices {
+    mat4 uInstanceMatrices[];
+};
+
+void main() {
+    gl_Position = uLightViewProj * uInstanceMatrices[gl_InstanceID] * vec4(position, 1.0);
+}
\ No newline at end of file
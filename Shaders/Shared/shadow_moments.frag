@@ -0,0 +1,47 @@
+﻿#version 460 core
+in vec2 vUV;
+
+out vec4 fragColor;
+
+// uFromDepth = 1 时读取深度图集并做 EVSM 指数变换，否则读取上一遍的矩
+uniform sampler2D uSource;
+uniform int uFromDepth;
+uniform int uRadius;
+// xy 为源纹素范围的最小值，zw 为最大值（含），采样不会越出当前级联块
+uniform vec4 uSourceRect;
+// xy 为目标像素到源纹素的偏移，zw 为模糊方向
+uniform vec4 uOffsetAndStep;
+uniform float uPositiveExponent;
+uniform float uNegativeExponent;
+
+const float kWeights1[3] = float[](0.25, 0.5, 0.25);
+const float kWeights2[5] = float[](0.0625, 0.25, 0.375, 0.25, 0.0625);
+
+float BlurWeight(int radius, int offset) {
+    if (radius == 0) {
+        return 1.0;
+    }
+    return radius == 1 ? kWeights1[offset + 1] : kWeights2[offset + 2];
+}
+
+vec4 FetchMoments(ivec2 texel) {
+    texel = clamp(texel, ivec2(uSourceRect.xy), ivec2(uSourceRect.zw));
+    if (uFromDepth == 0) {
+        return texelFetch(uSource, texel, 0);
+    }
+    float depth = texelFetch(uSource, texel, 0).r * 2.0 - 1.0;
+    float positive = exp(uPositiveExponent * depth);
+    float negative = -exp(-uNegativeExponent * depth);
+    return vec4(positive, positive * positive, negative, negative * negative);
+}
+
+void main() {
+    ivec2 centre = ivec2(gl_FragCoord.xy) + ivec2(uOffsetAndStep.xy);
+    ivec2 direction = ivec2(uOffsetAndStep.zw);
+    int radius = clamp(uRadius, 0, 2);
+    vec4 moments = vec4(0.0);
+    for (int i = -radius; i <= radius; ++i) {
+        moments += FetchMoments(centre + direction * i) * BlurWeight(radius, i);
+    }
+    fragColor = moments;
+}
@@ -13,9 +13,15 @@ uniform vec3 uLightPosition;
 uniform vec3 uLightColor;
 uniform vec3 uAmbientColor;
 uniform vec3 uCameraPos;
-uniform mat4 uShadowMatrix;
+const int MAX_SHADOW_CASCADES = 4;
+uniform mat4 uShadowMatrices[MAX_SHADOW_CASCADES];
+uniform int uShadowCascadeCount;
 uniform sampler2DShadow uShadowMap;
 uniform float uShadowStrength;
+// 0：深度比较；1：EVSM2；2：EVSM4。uEvsmParams = (正指数, 负指数, 漏光抑制)
+uniform int uShadowFilter;
+uniform sampler2D uShadowMoments;
+uniform vec3 uEvsmParams;
 uniform vec3 uFogColor;
 uniform float uFogDensity;
 
@@ -33,6 +39,11 @@ uniform int uHasAOMap;
 uniform int uHasEmissiveMap;
 uniform int uUseEnvironment;
 
+// 高度图烘焙的世界空间法线（RG = x/z），存在时取代插值的顶点法线
+uniform sampler2D uTerrainNormalMap;
+uniform int uHasTerrainNormalMap;
+uniform mat4 uModel;
+
 uniform int uDebugMode;
 uniform float uNearPlane;
 uniform float uFarPlane;
@@ -101,39 +112,97 @@ vec3 FresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
 }
 
+// 级联由近到远排列，取第一个包含该点的级联；各级联位于 2 × 2 阴影图集的对应块中
+const int SHADOW_MOMENT_MAX_LEVEL = 3;
+
+float ChebyshevUpperBound(vec2 moments, float mean, float minVariance) {
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float delta = mean - moments.x;
+    float pMax = variance / (variance + delta * delta);
+    // 把低于 uEvsmParams.z 的可见度压为全影，抑制重叠投射体之间的漏光
+    pMax = clamp((pMax - uEvsmParams.z) / (1.0 - uEvsmParams.z), 0.0, 1.0);
+    return mean <= moments.x ? 1.0 : pMax;
+}
+
+float SampleShadowMoments(vec2 atlasUV, vec2 gradX, vec2 gradY, float depth) {
+    vec4 moments = textureGrad(uShadowMoments, atlasUV, gradX, gradY);
+    float warped = depth * 2.0 - 1.0;
+    float positive = exp(uEvsmParams.x * warped);
+    float positiveScale = 0.0001 * uEvsmParams.x * positive;
+    float visibility = ChebyshevUpperBound(moments.xy, positive, positiveScale * positiveScale);
+    if (uShadowFilter == 2) {
+        float negative = -exp(-uEvsmParams.y * warped);
+        float negativeScale = 0.0001 * uEvsmParams.y * negative;
+        visibility = min(visibility, ChebyshevUpperBound(moments.zw, negative, negativeScale * negativeScale));
+    }
+    return visibility;
+}
+
+vec2 ClampToMomentTile(vec2 atlasUV, int cascade) {
+    // mip 与各向异性采样的覆盖范围留在本级联块内
+    vec2 tileMin = vec2(cascade % 2, cascade / 2) * 0.5;
+    vec2 margin = vec2(float(1 << SHADOW_MOMENT_MAX_LEVEL) * 0.5) / vec2(textureSize(uShadowMoments, 0));
+    return clamp(atlasUV, tileMin + margin, tileMin + 0.5 - margin);
+}
+
 float EvaluateShadow(vec3 worldPos, vec3 normal) {
     if (uShadowStrength <= 0.0) {
         return 1.0;
     }
-    vec4 shadowCoord = uShadowMatrix * vec4(worldPos, 1.0);
-    if (shadowCoord.w <= 0.0) {
-        return 1.0;
+    // 导数须在级联循环的分支之外求出，循环内以 textureGrad 采样矩图集
+    vec3 worldDx = dFdx(worldPos);
+    vec3 worldDy = dFdy(worldPos);
+    for (int i = 0; i < uShadowCascadeCount; ++i) {
+        vec3 ndc = (uShadowMatrices[i] * vec4(worldPos, 1.0)).xyz;
+        // 留出约一个纹素的边距，线性过滤不会采到相邻的图集块
+        if (abs(ndc.x) > 0.998 || abs(ndc.y) > 0.998 || abs(ndc.z) > 1.0) {
+            continue;
+        }
+        vec3 projCoords = ndc * 0.5 + 0.5;
+        vec2 atlasUV = (projCoords.xy + vec2(i % 2, i / 2)) * 0.5;
+        vec3 lightDir = normalize(uLightPosition - worldPos);
+        float bias = max(0.002 * (1.0 - dot(normal, lightDir)), 0.0005);
+        float visibility;
+        if (uShadowFilter == 0) {
+            visibility = texture(uShadowMap, vec3(atlasUV, projCoords.z - bias));
+        }
+        else {
+            // 正交投影是仿射变换，世界空间导数直接映射为图集 UV 导数（NDC -> UV 与图集各缩放 0.5）
+            vec2 gradX = (uShadowMatrices[i] * vec4(worldDx, 0.0)).xy * 0.25;
+            vec2 gradY = (uShadowMatrices[i] * vec4(worldDy, 0.0)).xy * 0.25;
+            visibility = SampleShadowMoments(ClampToMomentTile(atlasUV, i), gradX, gradY, projCoords.z - bias);
+        }
+        return mix(1.0, visibility, clamp(uShadowStrength, 0.0, 1.0));
     }
-    vec3 projCoords = shadowCoord.xyz / shadowCoord.w;
-    projCoords = projCoords * 0.5 + 0.5;
-    if (projCoords.x < 0.0 || projCoords.x > 1.0 || projCoords.y < 0.0 || projCoords.y > 1.0) {
-        return 1.0;
-    }
-    vec3 lightDir = normalize(uLightPosition - worldPos);
-    float bias = max(0.002 * (1.0 - dot(normal, lightDir)), 0.0005);
-    float sample1 = texture(uShadowMap, vec3(projCoords.xy, projCoords.z - bias));
-    return mix(1.0, sample1, clamp(uShadowStrength, 0.0, 1.0));
+    return 1.0;
 }
 
-mat3 BuildTBN() {
+mat3 BuildTBN(vec3 N) {
     vec3 T = normalize(vTangent);
     vec3 B = normalize(vBitangent);
-    vec3 N = normalize(vNormal);
+    if (uHasTerrainNormalMap == 1) {
+        T = normalize(T - N * dot(N, T));
+        B = cross(N, T);
+    }
     return mat3(T, B, N);
 }
 
 vec3 GetNormal(vec3 defaultNormal) {
+    vec3 N = normalize(defaultNormal);
+    if (uHasTerrainNormalMap == 1) {
+        // 顶点 UV 在 [0,1] 上对应第一个到最后一个采样点，换算到纹素中心
+        vec2 size = vec2(textureSize(uTerrainNormalMap, 0));
+        vec2 uv = (vTexCoord * (size - 1.0) + 0.5) / size;
+        vec2 xz = texture(uTerrainNormalMap, uv).rg;
+        vec3 baked = vec3(xz.x, sqrt(max(1.0 - dot(xz, xz), 0.0)), xz.y);
+        N = normalize(mat3(uModel) * baked);
+    }
     if (uHasNormalMap == 1) {
         vec3 tangentNormal = texture(uNormalMap, vTexCoord).xyz * 2.0 - 1.0;
-        mat3 TBN = BuildTBN();
+        mat3 TBN = BuildTBN(N);
         return normalize(TBN * tangentNormal);
     }
-    return normalize(defaultNormal);
+    return N;
 }
 
 void main() {
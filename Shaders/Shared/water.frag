@@ -4,16 +4,24 @@ in vec3 vWorldPos;
 
 uniform sampler2D      uReflectionTex;
 uniform sampler2D      uRefractionTex;
+uniform sampler2D      uRefractionDepthTex;   // 折射来源的深度（主通道拷贝或裁剪平面通道）
+uniform float          uWaterAbsorption;
 
 uniform vec3           uCameraPos;
 uniform vec3           uLightColor;
 uniform vec3           uAmbientColor;
 
 uniform mat4           uReflectionViewProj;
+uniform mat4           uViewProj;
 
-uniform mat4           uShadowMatrix;
+const int MAX_SHADOW_CASCADES = 4;
+uniform mat4           uShadowMatrices[MAX_SHADOW_CASCADES];
+uniform int            uShadowCascadeCount;
 uniform sampler2DShadow uShadowMap;
 uniform float          uShadowStrength;
+uniform int            uShadowFilter;
+uniform sampler2D      uShadowMoments;
+uniform vec3           uEvsmParams;
 
 uniform vec3  uFogColor;
 uniform float uFogDensity;
@@ -24,6 +32,13 @@ uniform float uFarPlane;
 
 out vec4 fragColor;
 
+const vec3 kDeepWaterColor = vec3(0.02, 0.09, 0.12);
+
+float LinearizeDepth(float depth) {
+    float ndcDepth = depth * 2.0 - 1.0;
+    return (2.0 * uNearPlane * uFarPlane) / (uFarPlane + uNearPlane - ndcDepth * (uFarPlane - uNearPlane));
+}
+
 float ComputeCurvedFogFactor(vec3 toCamera, float density, float farPlane) {
     float distance = length(toCamera);
     if (distance <= 1e-3) {
@@ -41,23 +56,63 @@ float ComputeCurvedFogFactor(vec3 toCamera, float density, float farPlane) {
 }
 
 // =============== 影子计算 ===============
-float EvaluateShadow(vec3 worldPos) {
-    if (uShadowStrength <= 0.0) return 1.0;
+const int SHADOW_MOMENT_MAX_LEVEL = 3;
+
+float ChebyshevUpperBound(vec2 moments, float mean, float minVariance) {
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float delta = mean - moments.x;
+    float pMax = variance / (variance + delta * delta);
+    // 把低于 uEvsmParams.z 的可见度压为全影，抑制重叠投射体之间的漏光
+    pMax = clamp((pMax - uEvsmParams.z) / (1.0 - uEvsmParams.z), 0.0, 1.0);
+    return mean <= moments.x ? 1.0 : pMax;
+}
 
-    vec4 shadowCoord = uShadowMatrix * vec4(worldPos, 1.0);
-    if (shadowCoord.w <= 0.0) return 1.0;
+float SampleShadowMoments(vec2 atlasUV, vec2 gradX, vec2 gradY, float depth) {
+    vec4 moments = textureGrad(uShadowMoments, atlasUV, gradX, gradY);
+    float warped = depth * 2.0 - 1.0;
+    float positive = exp(uEvsmParams.x * warped);
+    float positiveScale = 0.0001 * uEvsmParams.x * positive;
+    float visibility = ChebyshevUpperBound(moments.xy, positive, positiveScale * positiveScale);
+    if (uShadowFilter == 2) {
+        float negative = -exp(-uEvsmParams.y * warped);
+        float negativeScale = 0.0001 * uEvsmParams.y * negative;
+        visibility = min(visibility, ChebyshevUpperBound(moments.zw, negative, negativeScale * negativeScale));
+    }
+    return visibility;
+}
 
-    vec3 projCoords = shadowCoord.xyz / shadowCoord.w;
-    projCoords = projCoords * 0.5 + 0.5;
+vec2 ClampToMomentTile(vec2 atlasUV, int cascade) {
+    // mip 与各向异性采样的覆盖范围留在本级联块内
+    vec2 tileMin = vec2(cascade % 2, cascade / 2) * 0.5;
+    vec2 margin = vec2(float(1 << SHADOW_MOMENT_MAX_LEVEL) * 0.5) / vec2(textureSize(uShadowMoments, 0));
+    return clamp(atlasUV, tileMin + margin, tileMin + 0.5 - margin);
+}
 
-    // 超界不采样影子
-    if (projCoords.x < 0.0 || projCoords.x > 1.0 ||
-    projCoords.y < 0.0 || projCoords.y > 1.0)
+float EvaluateShadow(vec3 worldPos) {
+    if (uShadowStrength <= 0.0) return 1.0;
+    vec3 worldDx = dFdx(worldPos);
+    vec3 worldDy = dFdy(worldPos);
+
+    // 取第一个包含该点的级联，超出所有级联则不采样影子
+    for (int i = 0; i < uShadowCascadeCount; ++i) {
+        vec3 ndc = (uShadowMatrices[i] * vec4(worldPos, 1.0)).xyz;
+        if (abs(ndc.x) > 0.998 || abs(ndc.y) > 0.998 || abs(ndc.z) > 1.0) continue;
+
+        vec3 projCoords = ndc * 0.5 + 0.5;
+        vec2 atlasUV = (projCoords.xy + vec2(i % 2, i / 2)) * 0.5;
+        float bias = 0.0015;
+        float shadow;
+        if (uShadowFilter == 0) {
+            shadow = texture(uShadowMap, vec3(atlasUV, projCoords.z - bias));
+        }
+        else {
+            vec2 gradX = (uShadowMatrices[i] * vec4(worldDx, 0.0)).xy * 0.25;
+            vec2 gradY = (uShadowMatrices[i] * vec4(worldDy, 0.0)).xy * 0.25;
+            shadow = SampleShadowMoments(ClampToMomentTile(atlasUV, i), gradX, gradY, projCoords.z - bias);
+        }
+        return mix(1.0, shadow, clamp(uShadowStrength, 0.0, 1.0));
+    }
     return 1.0;
-
-    float bias = 0.0015;
-    float shadow = texture(uShadowMap, vec3(projCoords.xy, projCoords.z - bias));
-    return mix(1.0, shadow, clamp(uShadowStrength, 0.0, 1.0));
 }
 
 
@@ -100,9 +155,16 @@ void main() {
     // 折射 UV —— 必须用屏幕 UV，而不是 mesh UV
     // 原 water.frag 里用 vTexCoord 是完全错误的！
     // ----------------------
-    vec2 screenUV = gl_FragCoord.xy / textureSize(uRefractionTex, 0);
+    // 由投影求屏幕 UV，与折射纹理和当前渲染目标的分辨率无关（调试视口可使用半分辨率纹理）
+    vec4 viewClip = uViewProj * vec4(vWorldPos, 1.0);
+    vec2 screenUV = viewClip.xy / max(viewClip.w, 1e-6) * 0.5 + 0.5;
     vec3 refraction = texture(uRefractionTex, screenUV).rgb;
 
+    // 水体厚度：水面到其后方场景沿视线的距离，越厚越接近深水颜色
+    float sceneDepth = LinearizeDepth(texture(uRefractionDepthTex, screenUV).r);
+    float thickness = max(sceneDepth - LinearizeDepth(gl_FragCoord.z), 0.0);
+    refraction = mix(kDeepWaterColor, refraction, exp(-thickness * uWaterAbsorption));
+
     // ----------------------
     // 光照
     // ----------------------